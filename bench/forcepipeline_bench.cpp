@@ -0,0 +1,75 @@
+// Times one force evaluation of the compiled ForcePipeline against the
+// DynamicForcePipeline built from the same models, per flight regime.
+#include "physics/forcemodels.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr int EVALUATIONS = 2000000;
+
+// Nanoseconds per evaluate<Regime> over a slowly moving state, and the
+// summed force so the work cannot be dropped
+template <FlightRegime Regime, class Pipeline>
+double timeEvaluate(const Pipeline &pipeline, const State &start,
+                    const ForceContext &ctx, Vec3 &total) {
+  State s = start;
+  auto begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < EVALUATIONS; ++i) {
+    s.position = s.position + Vec3(0.0, 1e-6, 0.0);
+    total = total + pipeline.template evaluate<Regime>(s, ctx);
+  }
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - begin;
+  return elapsed.count() / EVALUATIONS;
+}
+
+template <FlightRegime Regime>
+void compare(const char *name, const DefaultForcePipeline &compiled,
+             const DynamicForcePipeline &dynamic, const State &s,
+             const ForceContext &ctx) {
+  Vec3 a, b;
+  double compiledNs = timeEvaluate<Regime>(compiled, s, ctx, a);
+  double dynamicNs = timeEvaluate<Regime>(dynamic, s, ctx, b);
+  bool same = a.x() == b.x() && a.y() == b.y() && a.z() == b.z();
+  std::cout << std::left << std::setw(22) << name << std::right
+            << std::setw(10) << compiledNs << std::setw(10) << dynamicNs
+            << std::setw(9) << dynamicNs / compiledNs << "x"
+            << (same ? "" : "  (results differ)") << "\n";
+}
+} // namespace
+
+int main() {
+  RocketBody rocket(20.0, 2.0, 5000.0, 2000.0);
+  PropulsionSystem propulsion(3000.0);
+  propulsion.addEngine(Engine(100000.0, 300.0));
+  propulsion.startEngines();
+  propulsion.setThrottle(1.0);
+
+  State s(Vec3(Constants::EARTH_RADIUS + 5000.0, 10.0, 0.0),
+          Vec3(300.0, 20.0, 5.0), Vec3(), 4000.0, 0.0);
+  double pressure = StandardFidelity::pressure(5000.0);
+  propulsion.updateThrustDirection(s.position);
+  ForceContext ctx{rocket, propulsion, pressure,
+                   propulsion.getThrust(pressure), 1.0};
+
+  DefaultForcePipeline compiled;
+  auto dynamic = DynamicForcePipeline::fromNames(
+      {"gravity", "aero", "coriolis", "thrust"});
+
+  std::cout << std::fixed << std::setprecision(2) << std::left
+            << std::setw(22) << "Regime" << std::right << std::setw(10)
+            << "Compiled" << std::setw(10) << "Dynamic" << std::setw(10)
+            << "Ratio" << "\n"
+            << std::left << std::setw(22) << "(ns per evaluation)" << "\n";
+  compare<FlightRegime::PoweredAtmospheric>("Powered, atmospheric",
+                                            compiled, dynamic, s, ctx);
+  compare<FlightRegime::PoweredVacuum>("Powered, vacuum", compiled, dynamic,
+                                       s, ctx);
+  compare<FlightRegime::CoastAtmospheric>("Coast, atmospheric", compiled,
+                                          dynamic, s, ctx);
+  compare<FlightRegime::CoastVacuum>("Coast, vacuum", compiled, dynamic, s,
+                                     ctx);
+}
@@ -0,0 +1,117 @@
+// Throughput and accuracy of the physics core (gravity, aerodynamics and
+// integrateRK4) on each scalar type it is instantiated for: float, double,
+// Lanes<double, 4>, Lanes<float, 8> and Dual<double, 3>. Lanes run one
+// copy of the flight per lane; Dual carries the derivatives of the landing
+// point with respect to the initial velocity, checked against central
+// differences of the double run.
+#include "math/dual.hpp"
+#include "math/lanes.hpp"
+#include "physics/aerodynamics.hpp"
+#include "physics/gravity.hpp"
+#include "physics/integrator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <type_traits>
+
+namespace {
+constexpr int STEPS = 10000; // 100 s
+constexpr double DT = 0.01;
+const Vec3 START_VELOCITY(1000.0, 50.0, 10.0);
+
+// Timing and end state of one flight
+template <class T> struct Result {
+  double nsPerStep;
+  BasicState<T> end;
+};
+
+// Final altitude of lane i (the value, for Dual)
+template <class T> double altitudeOf(const BasicState<T> &s, std::size_t i) {
+  auto altitude = s.position.magnitude() - T(Constants::EARTH_RADIUS);
+  if constexpr (std::is_arithmetic_v<T>)
+    return altitude;
+  else if constexpr (std::is_same_v<T, Dual<double, 3>>)
+    return altitude.value();
+  else
+    return altitude[i];
+}
+
+template <class T> Result<T> fly(const BasicVec3<T> &velocity) {
+  RocketBody rocket(20.0, 2.0, 5000.0, 2000.0);
+  BasicState<T> s(BasicVec3<T>(T(Constants::EARTH_RADIUS + 1000.0), T(10.0),
+                               T(0.0)),
+                  velocity, BasicVec3<T>(), T(5000.0), T(0.0));
+  auto acceleration = [&rocket](const BasicState<T> &state) {
+    return BasicVec3<T>(Gravity::getAcceleration(state.position) +
+                        Aerodynamics::calculateForces(state, rocket) /
+                            state.mass);
+  };
+  auto begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < STEPS; ++i)
+    s = Integrator::integrateRK4(s, acceleration, DT);
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - begin;
+  return {elapsed.count() / STEPS, s};
+}
+
+template <class T> BasicVec3<T> startVelocity() {
+  return BasicVec3<T>(T(START_VELOCITY.x()), T(START_VELOCITY.y()),
+                      T(START_VELOCITY.z()));
+}
+
+// One row: ns per step, per flight (lane), and the worst altitude error
+template <class T>
+void report(const char *name, std::size_t lanes, double reference) {
+  Result<T> r = fly<T>(startVelocity<T>());
+  double error = 0.0;
+  for (std::size_t i = 0; i < lanes; ++i)
+    error = std::max(error, std::abs(altitudeOf(r.end, i) - reference));
+  std::cout << std::left << std::setw(18) << name << std::right
+            << std::setw(12) << r.nsPerStep << std::setw(12)
+            << r.nsPerStep / lanes << std::setw(14) << std::scientific
+            << std::setprecision(2) << error << std::fixed
+            << std::setprecision(1) << "\n";
+}
+} // namespace
+
+int main() {
+  Result<double> reference = fly<double>(START_VELOCITY);
+  double altitude = altitudeOf(reference.end, 0);
+
+  std::cout << std::fixed << std::setprecision(1) << std::left
+            << std::setw(18) << "Scalar" << std::right << std::setw(12)
+            << "ns/step" << std::setw(12) << "ns/flight" << std::setw(14)
+            << "Altitude err" << "\n";
+  report<double>("double", 1, altitude);
+  report<float>("float", 1, altitude);
+  report<Lanes<double, 4>>("Lanes<double, 4>", 4, altitude);
+  report<Lanes<float, 8>>("Lanes<float, 8>", 8, altitude);
+  report<Dual<double, 3>>("Dual<double, 3>", 1, altitude);
+
+  // Gradient of the final altitude against central differences
+  using D = Dual<double, 3>;
+  BasicVec3<D> seeded(D::variable(START_VELOCITY.x(), 0),
+                      D::variable(START_VELOCITY.y(), 1),
+                      D::variable(START_VELOCITY.z(), 2));
+  Result<D> dual = fly<D>(seeded);
+  auto dualAltitude =
+      dual.end.position.magnitude() - D(Constants::EARTH_RADIUS);
+  std::cout << "\nd altitude / d initial velocity (s):\n";
+  constexpr double H = 1e-3; // m/s
+  for (std::size_t k = 0; k < 3; ++k) {
+    Vec3 up = START_VELOCITY, down = START_VELOCITY;
+    double step[3] = {0.0, 0.0, 0.0};
+    step[k] = H;
+    up = up + Vec3(step[0], step[1], step[2]);
+    down = down - Vec3(step[0], step[1], step[2]);
+    double difference = (altitudeOf(fly<double>(up).end, 0) -
+                         altitudeOf(fly<double>(down).end, 0)) /
+                        (2.0 * H);
+    std::cout << "  v" << "xyz"[k] << ": dual " << std::setprecision(9)
+              << dualAltitude.derivative(k) << ", difference " << difference
+              << "\n";
+  }
+}
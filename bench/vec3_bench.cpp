@@ -0,0 +1,62 @@
+// Times force evaluation and integrateRK4 on the Vec3 backend this file is
+// compiled for (avx2, sse2, or portable with NOVA_VEC3_PORTABLE). Build it
+// once per backend and compare; the trajectories should match to the bit.
+#include "physics/aerodynamics.hpp"
+#include "physics/gravity.hpp"
+#include "physics/integrator.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+constexpr int EVALUATIONS = 2000000;
+constexpr int STEPS = 500000;
+constexpr int STEPS_PER_FLIGHT = 20000; // 20 s, then restart from start
+constexpr double DT = 0.001;
+
+double nanosecondsSince(std::chrono::steady_clock::time_point begin,
+                        int count) {
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - begin;
+  return elapsed.count() / count;
+}
+} // namespace
+
+int main() {
+  RocketBody rocket(20.0, 2.0, 5000.0, 2000.0);
+  State start(Vec3(Constants::EARTH_RADIUS + 1000.0, 10.0, 0.0),
+              Vec3(100.0, 50.0, 10.0), Vec3(), 5000.0, 0.0);
+  auto acceleration = [&rocket](const State &s) {
+    return Gravity::getAcceleration(s.position) +
+           Aerodynamics::calculateForces(s, rocket) / s.mass;
+  };
+
+  State s = start;
+  Vec3 total;
+  auto begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < EVALUATIONS; ++i) {
+    s.position = s.position + Vec3(0.0, 1e-6, 0.0);
+    total = total + acceleration(s);
+  }
+  double evaluateNs = nanosecondsSince(begin, EVALUATIONS);
+
+  Vec3 landing;
+  begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < STEPS; ++i) {
+    if (i % STEPS_PER_FLIGHT == 0) {
+      landing = landing + s.position;
+      s = start;
+    }
+    s = Integrator::integrateRK4(s, acceleration, DT);
+  }
+  double stepNs = nanosecondsSince(begin, STEPS);
+
+  std::cout << "Vec3 backend: " << Double4::backendName() << "\n"
+            << std::fixed << std::setprecision(1)
+            << "Force evaluation: " << evaluateNs << " ns\n"
+            << "RK4 step:         " << stepNs << " ns\n"
+            << std::setprecision(9) << "Final position:   "
+            << s.position.x() << ", " << s.position.y() << ", "
+            << s.position.z() << "\nChecksums:        " << total.x() << ", "
+            << landing.y() << "\n";
+}
@@ -1,3 +1,4 @@
+import os
 import subprocess
 import tkinter as tk
 from tkinter import messagebox
@@ -17,16 +18,45 @@ rocket_data = {
             {
                 "thrust": 100000.0,
                 "burn_rate": 300.0,
-                "efficiency": 0.9,
-                "nozzle_diameter": 2.0
+                "throat_area": 0.01,
+                "expansion_ratio": 16.0,
+                "gamma": 1.2
             }
         ]
+    },
+    "simulation": {
+        "vacuum_density_threshold": 1e-8,
+        "math": "exact",
+        "fidelity": "standard",
+        "simd": "auto",
+        "log_format": "csv",
+        "csv_number_format": "fixed",
+        "csv_precision": 6,
+        "log_encoding": "delta",
+        "npy_layout": "channels",
+        "log_queue": 4096,
+        "log_overflow": "block",
+        "log_interval": 1.0,
+        "log_tolerance": 0,
+        "log_io": "sync",
+        "log_direct": False,
+        "live_telemetry": "",
+        "live_capacity": 4096
     }
 }
 
 with open('src/config.json', 'w') as json_file:
     json.dump(rocket_data, json_file, indent=4)
 
+# Shared-memory ring that screen.py tails while the simulator runs
+LIVE_TELEMETRY = 'nova_live'
+
+def remove_live_ring():
+    try:
+        os.unlink(os.path.join('/dev/shm', LIVE_TELEMETRY))
+    except OSError:
+        pass
+
 # Function to update the JSON data based on user inputs
 def save_data():
     try:
@@ -41,8 +71,9 @@ def save_data():
         engine = rocket_data['propulsion']['engines'][0]
         engine['thrust'] = float(entry_thrust.get())
         engine['burn_rate'] = float(entry_burn_rate.get())
-        engine['efficiency'] = float(entry_efficiency.get())
-        engine['nozzle_diameter'] = float(entry_nozzle_diameter.get())
+        engine['throat_area'] = float(entry_throat_area.get())
+        engine['expansion_ratio'] = float(entry_expansion_ratio.get())
+        engine['gamma'] = float(entry_gamma.get())
         
         with open('src/config.json', 'w') as json_file:
             json.dump(rocket_data, json_file, indent=4)
@@ -76,22 +107,38 @@ def load_data():
     entry_burn_rate.delete(0, tk.END)
     entry_burn_rate.insert(0, str(rocket_data['propulsion']['engines'][0]['burn_rate']))
     
-    entry_efficiency.delete(0, tk.END)
-    entry_efficiency.insert(0, str(rocket_data['propulsion']['engines'][0]['efficiency']))
+    entry_throat_area.delete(0, tk.END)
+    entry_throat_area.insert(0, str(rocket_data['propulsion']['engines'][0]['throat_area']))
+    
+    entry_expansion_ratio.delete(0, tk.END)
+    entry_expansion_ratio.insert(0, str(rocket_data['propulsion']['engines'][0]['expansion_ratio']))
     
-    entry_nozzle_diameter.delete(0, tk.END)
-    entry_nozzle_diameter.insert(0, str(rocket_data['propulsion']['engines'][0]['nozzle_diameter']))
+    entry_gamma.delete(0, tk.END)
+    entry_gamma.insert(0, str(rocket_data['propulsion']['engines'][0]['gamma']))
     
 def run_simulation():
-    subprocess.call(["g++", "-std=c++17", "-I", "src/", "src/main.cpp", "-o", "nova"])
-    subprocess.call(["./nova"])
-    subprocess.call(["python3", "screen.py"])
+    subprocess.call(["g++", "-std=c++17", "-O2", "-pthread", "-I", "src/", "src/main.cpp", "-o", "nova"])
+    # Watch the flight while it runs. Live telemetry is on for this run only,
+    # and its ring is removed afterwards; a stale one would be tailed instead.
+    remove_live_ring()
+    rocket_data['simulation']['live_telemetry'] = LIVE_TELEMETRY
+    with open('src/config.json', 'w') as json_file:
+        json.dump(rocket_data, json_file, indent=4)
+    rocket_data['simulation']['live_telemetry'] = ""
+    simulator = subprocess.Popen(["./nova"])
+    try:
+        subprocess.call(["python3", "screen.py", "--live", LIVE_TELEMETRY])
+    finally:
+        simulator.wait()
+        with open('src/config.json', 'w') as json_file:
+            json.dump(rocket_data, json_file, indent=4)
+        remove_live_ring()
 
 # Create the main window
 root = tk.Tk()
 root.title("NOVA")
 root.configure(background='#040716')
-root.geometry('470x650')
+root.geometry('470x710')
 root.resizable(False, False)
 
 # Font
@@ -137,15 +184,20 @@ label_burn_rate.grid(row=6, column=0, sticky='w', pady=10)
 entry_burn_rate = tk.Entry(frame, font=entry_font)
 entry_burn_rate.grid(row=6, column=1, pady=10)
 
-label_efficiency = tk.Label(frame, text="Engine Efficiency:", font=label_font, bg='#040716', fg='white')
-label_efficiency.grid(row=7, column=0, sticky='w', pady=10)
-entry_efficiency = tk.Entry(frame, font=entry_font)
-entry_efficiency.grid(row=7, column=1, pady=10)
+label_throat_area = tk.Label(frame, text="Throat Area (m²):", font=label_font, bg='#040716', fg='white')
+label_throat_area.grid(row=7, column=0, sticky='w', pady=10)
+entry_throat_area = tk.Entry(frame, font=entry_font)
+entry_throat_area.grid(row=7, column=1, pady=10)
+
+label_expansion_ratio = tk.Label(frame, text="Expansion Ratio:", font=label_font, bg='#040716', fg='white')
+label_expansion_ratio.grid(row=8, column=0, sticky='w', pady=10)
+entry_expansion_ratio = tk.Entry(frame, font=entry_font)
+entry_expansion_ratio.grid(row=8, column=1, pady=10)
 
-label_nozzle_diameter = tk.Label(frame, text="Nozzle Diameter (m):", font=label_font, bg='#040716', fg='white')
-label_nozzle_diameter.grid(row=8, column=0, sticky='w', pady=10)
-entry_nozzle_diameter = tk.Entry(frame, font=entry_font)
-entry_nozzle_diameter.grid(row=8, column=1, pady=10)
+label_gamma = tk.Label(frame, text="Exhaust Gamma:", font=label_font, bg='#040716', fg='white')
+label_gamma.grid(row=9, column=0, sticky='w', pady=10)
+entry_gamma = tk.Entry(frame, font=entry_font)
+entry_gamma.grid(row=9, column=1, pady=10)
 
 # Create buttons for saving data and running simulation
 button_save = tk.Button(root, text="Save Changes", font=("Helvetica", 14, 'bold'), command=save_data, bg="#28a745", fg="white", width=24)
@@ -1,3 +1,6 @@
+import argparse
+import time
+
 import matplotlib.animation as animation
 import matplotlib.patheffects as path_effects
 import matplotlib.pyplot as plt
@@ -6,10 +9,13 @@ import pandas as pd
 from matplotlib.gridspec import GridSpec
 from matplotlib.patches import Arc, Circle, FancyArrowPatch, Rectangle
 
+import telemetry
+
 
 class EnhancedRocketVisualizer:
-    def __init__(self, csv_file):
-        self.data = pd.read_csv(csv_file)
+    def __init__(self, data, live=None):
+        self.data = data
+        self.live = live  # telemetry.LiveReader feeding data as the run goes
         
         plt.style.use('dark_background')
         self.fig = plt.figure(figsize=(20, 11))
@@ -44,6 +50,8 @@ class EnhancedRocketVisualizer:
         
         self.setup_theme()
         self.setup_displays()
+        if self.live:
+            self.rescale()
 
     def setup_theme(self):
         for ax in [self.ax_main, self.ax_telemetry, self.ax_trajectory, self.ax_mission]:
@@ -365,16 +373,53 @@ class EnhancedRocketVisualizer:
                 *self.mission_texts.values(),
                 rocket, *flames]
 
+    def rescale(self):
+        self.max_altitude = self.data['Altitude'].max()
+        self.max_time = self.data['Time'].max()
+        self.ax_trajectory.set_xlim(0, self.max_time or 1)
+        self.ax_trajectory.set_ylim(0, self.max_altitude/1000 * 1.1 or 1)
+
+    def follow(self):
+        # One record per frame, as in replay, taking new records from the
+        # live ring as they arrive; ends once the run has closed and shown
+        frame = 0
+        while True:
+            closed = self.live.closed
+            rows = self.live.poll_dataframe()
+            if len(rows):
+                self.data = pd.concat([self.data, rows], ignore_index=True)
+                self.rescale()
+            if frame < len(self.data):
+                yield frame
+                frame += 1
+            elif closed:
+                return
+            else:
+                yield frame - 1  # Hold on the newest record
+
     def animate(self):
         ani = animation.FuncAnimation(
             self.fig,
             self.update,
-            frames=len(self.data),
+            frames=self.follow if self.live else len(self.data),
             interval=1000,  # Updated to 1 second interval
-            blit=True
+            blit=not self.live,  # Live axes rescale as records arrive
+            cache_frame_data=not self.live
         )
         plt.show()
 
 if __name__ == "__main__":
-    visualizer = EnhancedRocketVisualizer('flight_data.csv')
+    parser = argparse.ArgumentParser(description='Animate a NOVA flight.')
+    parser.add_argument('--live', metavar='NAME',
+                        help='tail the running simulator\'s live telemetry')
+    args = parser.parse_args()
+    if args.live:
+        reader = telemetry.LiveReader(args.live, timeout=30)
+        data = reader.poll_dataframe()
+        while not len(data) and not reader.closed:
+            time.sleep(0.01)  # Leave the core to the simulator
+            data = reader.poll_dataframe()
+        visualizer = EnhancedRocketVisualizer(data, reader)
+    else:
+        visualizer = EnhancedRocketVisualizer(telemetry.load_flight_data())
     visualizer.animate()
\ No newline at end of file
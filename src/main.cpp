@@ -1,12 +1,62 @@
+#include "math/dual.hpp"
+#include "math/mathpolicy.hpp"
+#include "physics/batchkernels.hpp"
 #include "physics/simulationengine.hpp"
+#include "physics/thrustcurve.hpp"
+#include "telemetry/arrowipc.hpp"
+#include "telemetry/asyncsink.hpp"
+#include "telemetry/binarylog.hpp"
+#include "telemetry/channelregistry.hpp"
+#include "telemetry/csvsink.hpp"
+#include "telemetry/decimatingsink.hpp"
+#include "telemetry/livering.hpp"
+#include "telemetry/npysink.hpp"
+#include <chrono>
+#include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 #include "../libs/json.hpp"
 
 using json = nlohmann::json;
 
-void parseConfig(const std::string& fileToOpen, RocketBody& rocket, PropulsionSystem& prop){
+// Run-level options from the optional "simulation" block of the config
+struct SimulationSettings {
+  double vacuumDensityThreshold = RegimeDefaults::VACUUM_DENSITY_THRESHOLD;
+  std::vector<std::string> forceModels; // Empty: compiled-in default pipeline
+  std::string math = ExactMath::NAME;    // Accuracy policy for exp/sqrt/acos
+  std::string fidelity = StandardFidelity::NAME; // Physics model level
+  std::string simd = "auto"; // Batch kernel ISA, "auto" picks the best
+  // Parameters ("thrust", "drag", "mass") to differentiate the run against
+  std::vector<std::string> sensitivities;
+  std::string logFormat = "csv"; // csv, binary (.ntl), npy, npz or arrow
+  std::string npyLayout = "channels"; // npy/npz: "channels" or "matrix"
+  std::vector<std::string> channels; // Logged channels; empty: the defaults
+  std::string logEncoding = "delta"; // Binary log columns: "raw" or "delta"
+  std::map<std::string, std::string> channelEncodings; // Per-channel override
+  std::string csvNumbers = "fixed"; // Or "shortest" (round-trip digits)
+  int csvPrecision = CsvTelemetrySink::DEFAULT_PRECISION; // Fixed decimals
+  // Records queued for the background log writer; 0 writes inline
+  std::size_t logQueue = AsyncTelemetrySink::DEFAULT_CAPACITY;
+  std::string logOverflow = "block"; // Full queue: "block", "drop", "count"
+  double logInterval = 1.0; // Seconds between sampled records
+  // Decimation: drop records that linear interpolation rebuilds to within
+  // a tolerance (absolute, in the channel's unit). Off when both are unset.
+  double logTolerance = 0.0;
+  std::map<std::string, double> channelTolerances;
+  std::string logIo = "sync"; // "sync" (pwrite) or "uring" (io_uring)
+  bool logDirect = false;     // Write logs with O_DIRECT
+  // Shared-memory ring that live readers tail (/dev/shm/<name>); "" is off
+  std::string liveTelemetry;
+  std::size_t liveCapacity = LiveTelemetryRing::DEFAULT_CAPACITY; // Records
+};
+
+void parseConfig(const std::string& fileToOpen, RocketBody& rocket, PropulsionSystem& prop, SimulationSettings& settings, CurveLibrary& curves){
   std::ifstream file(fileToOpen);
   
   json config;
@@ -23,21 +73,473 @@ void parseConfig(const std::string& fileToOpen, RocketBody& rocket, PropulsionSy
   rocket = RocketBody(length,diameter,wetMass,dryMass);
   prop = PropulsionSystem(fuelMass);
 
+  // Table files are looked up relative to the config file
+  std::filesystem::path configDir = std::filesystem::path(fileToOpen).parent_path();
+  auto tablePath = [&configDir](const std::string& file) {
+    std::filesystem::path path(file);
+    return (path.is_relative() ? configDir / path : path).string();
+  };
+
   for(const auto& engine : engines){
     double thrust = engine["thrust"];
     double burn_rate = engine["burn_rate"];
-    double efficiency = engine["efficiency"];
-    double nozzleDiameter = engine["nozzle_diameter"];
-    prop.addEngine(thrust, burn_rate, efficiency, nozzleDiameter);
+    // Nozzle model from the geometry keys; without them thrust follows
+    // linearThrustFactor
+    Engine definition(thrust, burn_rate);
+    if (engine.contains("throat_area")) {
+      definition = Engine(
+          thrust, burn_rate,
+          Nozzle(engine["throat_area"],
+                 engine.value("expansion_ratio",
+                              NozzleConstants::EXPANSION_RATIO),
+                 engine.value("gamma", NozzleConstants::EXHAUST_GAMMA)));
+    } else if (engine.contains("expansion_ratio") || engine.contains("gamma")) {
+      throw std::runtime_error("Nozzle expansion_ratio and gamma need a "
+                               "throat_area");
+    }
+
+    // Optional measured performance: thrust vs time (.eng or CSV) and
+    // Isp vs ambient pressure (CSV)
+    if (engine.contains("thrust_curve"))
+      definition.setThrustCurve(curves.thrustCurve(
+          tablePath(engine["thrust_curve"]),
+          engine.value("propellant_mass", 0.0), burn_rate));
+    if (engine.contains("isp_table"))
+      definition.setIspTable(curves.ispTable(tablePath(engine["isp_table"])));
+    prop.addEngine(definition);
+  }
+
+  if (config.contains("simulation")) {
+    const auto& simulation = config["simulation"];
+    settings.vacuumDensityThreshold = simulation.value(
+        "vacuum_density_threshold", settings.vacuumDensityThreshold);
+    if (simulation.contains("force_models"))
+      settings.forceModels =
+          simulation["force_models"].get<std::vector<std::string>>();
+    settings.math = simulation.value("math", settings.math);
+    settings.fidelity = simulation.value("fidelity", settings.fidelity);
+    settings.logFormat = simulation.value("log_format", settings.logFormat);
+    settings.npyLayout = simulation.value("npy_layout", settings.npyLayout);
+    if (simulation.contains("channels"))
+      settings.channels =
+          simulation["channels"].get<std::vector<std::string>>();
+    settings.logEncoding =
+        simulation.value("log_encoding", settings.logEncoding);
+    if (simulation.contains("channel_encodings"))
+      settings.channelEncodings =
+          simulation["channel_encodings"]
+              .get<std::map<std::string, std::string>>();
+    settings.csvNumbers =
+        simulation.value("csv_number_format", settings.csvNumbers);
+    settings.csvPrecision =
+        simulation.value("csv_precision", settings.csvPrecision);
+    settings.logQueue = simulation.value("log_queue", settings.logQueue);
+    settings.logOverflow =
+        simulation.value("log_overflow", settings.logOverflow);
+    settings.logInterval =
+        simulation.value("log_interval", settings.logInterval);
+    settings.logTolerance =
+        simulation.value("log_tolerance", settings.logTolerance);
+    settings.logIo = simulation.value("log_io", settings.logIo);
+    settings.logDirect = simulation.value("log_direct", settings.logDirect);
+    settings.liveTelemetry =
+        simulation.value("live_telemetry", settings.liveTelemetry);
+    settings.liveCapacity =
+        simulation.value("live_capacity", settings.liveCapacity);
+    if (simulation.contains("channel_tolerances"))
+      settings.channelTolerances =
+          simulation["channel_tolerances"].get<std::map<std::string, double>>();
+    settings.simd = simulation.value("simd", settings.simd);
+    if (simulation.contains("sensitivities"))
+      settings.sensitivities =
+          simulation["sensitivities"].get<std::vector<std::string>>();
   }
 }
 
+// What flight channels are computed from at a sample instant. Quantities
+// several channels share are computed on first use and kept for the rest
+// of the sample.
+template <class Simulation> class FlightSample {
+private:
+  using Fidelity = typename Simulation::Fidelity;
+
+  const Simulation &sim_;
+  const RocketBody &rocket_;
+  State state_;
+  std::optional<double> altitude_;
+  std::optional<double> speed_;
+  std::optional<double> temperature_;
+
+public:
+  FlightSample(const Simulation &sim, const RocketBody &rocket)
+      : sim_(sim), rocket_(rocket), state_(valueOf(sim.getState())) {}
+
+  const Simulation &sim() const { return sim_; }
+  const RocketBody &rocket() const { return rocket_; }
+  const State &state() const { return state_; }
+
+  double altitude() {
+    if (!altitude_)
+      altitude_ = state_.position.magnitude() - Constants::EARTH_RADIUS;
+    return *altitude_;
+  }
+  double speed() {
+    if (!speed_)
+      speed_ = state_.velocity.magnitude();
+    return *speed_;
+  }
+  double temperature() {
+    if (!temperature_)
+      temperature_ = Fidelity::temperature(altitude());
+    return *temperature_;
+  }
+};
+
+// Every channel the flight log can carry. Registration order is the
+// default column order.
+template <class Simulation>
+ChannelRegistry<FlightSample<Simulation>> flightChannels() {
+  using Fidelity = typename Simulation::Fidelity;
+  using Sample = FlightSample<Simulation>;
+  ChannelRegistry<Sample> channels;
+  channels.add("Time", "s", [](Sample &s) { return s.sim().getTime(); });
+  channels.add("Altitude", "m", [](Sample &s) { return s.altitude(); });
+  channels.add("Velocity_X", "m/s",
+               [](Sample &s) { return s.state().velocity.x(); });
+  channels.add("Velocity_Y", "m/s",
+               [](Sample &s) { return s.state().velocity.y(); });
+  channels.add("Velocity_Z", "m/s",
+               [](Sample &s) { return s.state().velocity.z(); });
+  channels.add("Velocity_Magnitude", "m/s",
+               [](Sample &s) { return s.speed(); });
+  channels.add("Acceleration_X", "m/s^2",
+               [](Sample &s) { return s.state().acceleration.x(); });
+  channels.add("Acceleration_Y", "m/s^2",
+               [](Sample &s) { return s.state().acceleration.y(); });
+  channels.add("Acceleration_Z", "m/s^2",
+               [](Sample &s) { return s.state().acceleration.z(); });
+  channels.add("Acceleration_Magnitude", "m/s^2",
+               [](Sample &s) { return s.state().acceleration.magnitude(); });
+  channels.add("Mass", "kg", [](Sample &s) { return s.state().mass; });
+  channels.add("Fuel_Ratio", "",
+               [](Sample &s) { return s.sim().getRemainingFuelRatio(); });
+  channels.add("Air_Density", "kg/m^3",
+               [](Sample &s) { return Fidelity::density(s.altitude()); });
+  channels.add("Air_Pressure", "Pa",
+               [](Sample &s) { return Fidelity::pressure(s.altitude()); });
+  channels.add("Temperature", "K", [](Sample &s) { return s.temperature(); });
+  channels.add("Dynamic_Pressure", "Pa", [](Sample &s) {
+    return Aerodynamics::calculateDynamicPressure<Fidelity>(s.state());
+  });
+  channels.add("Mach_Number", "", [](Sample &s) {
+    return s.speed() /
+           std::sqrt(AeroConstants::GAMMA * AeroConstants::AIR_GAS_CONSTANT *
+                     s.temperature());
+  });
+  channels.add("Drag_Coefficient", "",
+               [](Sample &s) { return s.rocket().getDragCoefficient(); });
+  channels.add("Lift_Coefficient", "",
+               [](Sample &s) { return s.rocket().getLiftCoefficient(); });
+
+  // Typed channels, logged only when selected by name
+  channels.add({"Tick", "", TelemetryType::Int64, {}},
+               [](Sample &s) { return double(s.sim().getTick()); }, false);
+  std::vector<std::string> regimes;
+  for (int i = 0; i < static_cast<int>(FlightRegime::Count); ++i)
+    regimes.push_back(regimeName(static_cast<FlightRegime>(i)));
+  channels.add({"Regime", "", TelemetryType::Category, std::move(regimes)},
+               [](Sample &s) { return double(s.sim().getRegime()); }, false);
+  channels.add({"Powered", "", TelemetryType::Bool, {}},
+               [](Sample &s) { return double(hasThrust(s.sim().getRegime())); },
+               false);
+  return channels;
+}
+
+// The flight log sink for the configured format, and where it writes
+std::unique_ptr<TelemetrySink> makeFlightLog(const SimulationSettings &settings,
+                                             std::string &path,
+                                             const DecimatingSink *&decimator) {
+  std::unique_ptr<TelemetrySink> sink;
+  if (settings.logFormat == "csv") {
+    path = "flight_data.csv";
+    sink = std::make_unique<CsvTelemetrySink>(
+        path, csvNumbersFromName(settings.csvNumbers), settings.csvPrecision);
+  } else if (settings.logFormat == "binary") {
+    path = "flight_data.ntl";
+    auto log = std::make_unique<BinaryLogWriter>(
+        path, BinaryLogWriter::DEFAULT_CHUNK_ROWS,
+        BinaryLog::encodingFromName(settings.logEncoding));
+    for (const auto &[channel, encoding] : settings.channelEncodings)
+      log->setEncoding(channel, BinaryLog::encodingFromName(encoding));
+    sink = std::move(log);
+  } else if (settings.logFormat == "npy" || settings.logFormat == "npz") {
+    NpyLayout layout = npyLayoutFromName(settings.npyLayout);
+    bool bundle = settings.logFormat == "npz";
+    path = bundle ? "flight_data.npz"
+           : layout == NpyLayout::Matrix ? "flight_data.npy"
+                                         : "flight_data";
+    sink = std::make_unique<NpySink>(path, layout, bundle);
+  } else if (settings.logFormat == "arrow") {
+    path = "flight_data.arrow";
+    sink = std::make_unique<ArrowFileWriter>(path);
+  } else {
+    throw std::invalid_argument("Unknown log format: " + settings.logFormat);
+  }
+  decimator = nullptr;
+  if (settings.logTolerance > 0 || !settings.channelTolerances.empty()) {
+    auto decimating = std::make_unique<DecimatingSink>(std::move(sink),
+                                                       settings.logTolerance);
+    for (const auto &[channel, tolerance] : settings.channelTolerances)
+      decimating->setTolerance(channel, tolerance);
+    decimator = decimating.get();
+    sink = std::move(decimating);
+  }
+  // Keep encoding and disk writes off the simulation thread
+  if (settings.logQueue > 0)
+    sink = std::make_unique<AsyncTelemetrySink>(
+        std::move(sink), settings.logQueue,
+        overflowPolicyFromName(settings.logOverflow));
+  return sink;
+}
+
+// Fly the vehicle and log the trajectory (any BasicSimulationEngine).
+// Output runs as scheduler tasks on whole ticks; the loop itself only
+// dispatches, checks for a crash and steps.
+template <class Simulation>
+void runSimulation(Simulation &sim, const RocketBody &rocket,
+                   const SimulationSettings &settings) {
+  const SimulationClock &clock = sim.getClock();
+
+  // Start engines at full throttle
+  sim.startEngines();
+  sim.setThrottle(1.0);
+
+  std::string logPath;
+  const DecimatingSink *decimator = nullptr;
+  std::unique_ptr<TelemetrySink> flightLog =
+      makeFlightLog(settings, logPath, decimator);
+  auto channels = flightChannels<Simulation>();
+  auto logged = settings.channels.empty() ? channels.selectDefault()
+                                          : channels.select(settings.channels);
+  // Recorded with the run where the log format has room for it
+  TelemetrySchema schema = logged.schema();
+  schema.setMetadata("simd", simdPathName(BatchKernels::active().path));
+  auto logStart = std::chrono::steady_clock::now();
+  flightLog->open(schema);
+  std::vector<double> record(logged.size());
+
+  // Live readers are optional: without shared memory the run goes on
+  std::unique_ptr<LiveTelemetryRing> live;
+  if (!settings.liveTelemetry.empty()) {
+    try {
+      live = std::make_unique<LiveTelemetryRing>(settings.liveTelemetry,
+                                                 settings.liveCapacity);
+      live->open(logged.schema());
+    } catch (const std::exception &e) {
+      std::cerr << "Live telemetry off: " << e.what() << "\n";
+      live.reset();
+    }
+  }
+
+  TaskScheduler scheduler;
+
+  // Log the selected channels every log interval
+  std::uint64_t logTicks = clock.ticksFor(settings.logInterval);
+  scheduler.add("log", logTicks, [&](std::uint64_t) {
+    FlightSample<Simulation> sample(sim, rocket);
+    // Sample straight into the live ring's slot; the log copies from there
+    double *out = live ? live->claim() : record.data();
+    logged.sample(sample, out);
+    if (live)
+      live->publish();
+    flightLog->write(out);
+  });
+
+  // Print progress to console
+  scheduler.add("progress", clock.ticksFor(1.0), [&](std::uint64_t) {
+    const State &state = valueOf(sim.getState());
+    std::cout << "Time: " << std::setprecision(1) << std::fixed
+              << sim.getTime() << "s, Altitude: " << std::setprecision(1)
+              << state.position.magnitude() - Constants::EARTH_RADIUS
+              << "m, Velocity: " << state.velocity.magnitude() << "m/s\n";
+  });
+
+  // Force breakdown, printed by the next step
+  scheduler.add("forces", clock.ticksFor(1.0),
+                [&](std::uint64_t) { sim.requestForceReport(std::cout); });
+
+  // Run simulation for 100 seconds
+  std::uint64_t endTick = clock.ticksFor(100.0);
+  while (sim.getTick() <= endTick) {
+    scheduler.dispatch(sim.getTick());
+
+    // Check if the altitude is below zero
+    const State &state = valueOf(sim.getState());
+    if (state.position.magnitude() - Constants::EARTH_RADIUS < 0) {
+      std::cout << "The rocket has crashed.\n";
+      break; // Exit the simulation loop
+    }
+
+    sim.step();
+  }
+
+  flightLog->close();
+  std::chrono::duration<double> logSeconds =
+      std::chrono::steady_clock::now() - logStart;
+  if (live)
+    live->close();
+  std::cout << "\nSimulation completed. Data saved to " << logPath << "\n";
+  if (auto *async = dynamic_cast<AsyncTelemetrySink *>(flightLog.get())) {
+    std::cout << "Log queue: " << async->written() << " records written, "
+              << async->dropped() << " dropped, " << async->stalls()
+              << " stalls, peak depth " << async->maxQueueDepth() << " of "
+              << async->capacity() << "\n";
+    if (async->policy() == OverflowPolicy::Count && async->dropped() > 0)
+      std::cerr << "Warning: telemetry queue overflowed, " << async->dropped()
+                << " records were not logged\n";
+  }
+  if (decimator)
+    std::cout << "Decimation: kept " << decimator->forwarded() << " of "
+              << decimator->received() << " records\n";
+  if (live)
+    std::cout << "Live telemetry: " << live->published()
+              << " records published to shared memory "
+              << settings.liveTelemetry << "\n";
+  if (settings.logIo != "sync" || settings.logDirect) {
+    FileOutput::Stats io;
+    {
+      std::lock_guard<std::mutex> lock(FileOutput::totalsMutex());
+      io = FileOutput::totals();
+    }
+    // Throughput over the run's wall-clock time, from opening the log to
+    // closing it; blocked time is what the writing threads spent in I/O
+    double seconds = logSeconds.count();
+    std::cout << "Log I/O: " << io.files << " files, " << io.bytes
+              << " bytes in " << std::setprecision(3) << seconds << " s ("
+              << std::setprecision(1)
+              << (seconds > 0 ? io.bytes / seconds / 1e6 : 0.0)
+              << " MB/s), " << io.writes << " writes, "
+              << std::setprecision(3) << io.blockedSeconds * 1e3
+              << " ms blocked; io_uring " << io.uringFiles << " files ("
+              << io.fixedFiles << " registered, " << io.fallbacks
+              << " fell back to pwrite), " << io.enters << " enters, "
+              << io.waits << " full-queue waits, peak " << io.maxInFlight
+              << " in flight; O_DIRECT " << io.directFiles << " files\n";
+  }
+  sim.getRegimeReport().print(std::cout);
+}
+
+// Build the engine around one force pipeline and fly it
+template <class Fidelity, class Pipeline>
+void simulate(const State &initialState, const RocketBody &rocket,
+              PropulsionSystem &&propulsion,
+              const SimulationSettings &settings, Pipeline forces) {
+  BasicSimulationEngine<Pipeline, double, Fidelity> sim(
+      initialState, rocket, std::move(propulsion), 0.01, std::move(forces));
+  sim.setVacuumDensityThreshold(settings.vacuumDensityThreshold);
+  runSimulation(sim, rocket, settings);
+}
+
+// Forward-mode sensitivities: one run on dual numbers yields the trajectory
+// and its derivatives with respect to up to three vehicle parameters
+using SensitivityScalar = Dual<double, 3>;
+
+template <class Math, class Fidelity>
+void simulateSensitivities(const State &initialState, const RocketBody &rocket,
+                           PropulsionSystem &&propulsion,
+                           const SimulationSettings &settings) {
+  const auto &names = settings.sensitivities;
+  if (!settings.forceModels.empty())
+    throw std::invalid_argument(
+        "Sensitivities need the compiled-in force pipeline");
+  if (names.size() > SensitivityScalar::SIZE)
+    throw std::invalid_argument("Too many sensitivity parameters");
+
+  FlightParameters<SensitivityScalar> parameters;
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    if (names[i] == "thrust")
+      parameters.thrustScale = SensitivityScalar::variable(1.0, i);
+    else if (names[i] == "drag")
+      parameters.dragScale = SensitivityScalar::variable(1.0, i);
+    else if (names[i] == "mass")
+      parameters.massOffset = SensitivityScalar::variable(0.0, i);
+    else
+      throw std::invalid_argument("Unknown sensitivity parameter: " +
+                                  names[i]);
+  }
+
+  BasicSimulationEngine<BasicDefaultForcePipeline<Math, Fidelity>,
+                        SensitivityScalar, Fidelity>
+      sim(BasicState<SensitivityScalar>(initialState), rocket,
+          std::move(propulsion), 0.01, {}, parameters);
+  sim.setVacuumDensityThreshold(settings.vacuumDensityThreshold);
+  runSimulation(sim, rocket, settings);
+
+  // Thrust and drag are scale factors (per 100 %), mass is per kg
+  const auto &state = sim.getState();
+  SensitivityScalar altitude =
+      state.position.magnitude() - Constants::EARTH_RADIUS;
+  SensitivityScalar speed = state.velocity.magnitude();
+  std::cout << std::setprecision(6) << "Sensitivities at t=" << sim.getTime()
+            << "s:\n";
+  for (std::size_t i = 0; i < names.size(); ++i)
+    std::cout << "  " << names[i] << ": d altitude " << altitude.derivative(i)
+              << " m, d velocity " << speed.derivative(i) << " m/s\n";
+}
+
+// An explicit force model list selects the runtime-configurable pipeline
+// instead of the compiled-in default
+template <class Math, class Fidelity>
+void simulateWith(const State &initialState, const RocketBody &rocket,
+                  PropulsionSystem &&propulsion,
+                  const SimulationSettings &settings) {
+  if (!settings.sensitivities.empty())
+    simulateSensitivities<Math, Fidelity>(initialState, rocket,
+                                          std::move(propulsion), settings);
+  else if (settings.forceModels.empty())
+    simulate<Fidelity>(initialState, rocket, std::move(propulsion), settings,
+                       BasicDefaultForcePipeline<Math, Fidelity>());
+  else
+    simulate<Fidelity>(
+        initialState, rocket, std::move(propulsion), settings,
+        DynamicForcePipeline::fromNames<Math, Fidelity>(settings.forceModels));
+}
+
+// Every fidelity level is compiled in; the config picks one
+template <class Math>
+void simulateWith(const State &initialState, const RocketBody &rocket,
+                  PropulsionSystem &&propulsion,
+                  const SimulationSettings &settings) {
+  if (settings.fidelity == FastFidelity::NAME)
+    simulateWith<Math, FastFidelity>(initialState, rocket,
+                                     std::move(propulsion), settings);
+  else if (settings.fidelity == StandardFidelity::NAME)
+    simulateWith<Math, StandardFidelity>(initialState, rocket,
+                                         std::move(propulsion), settings);
+  else if (settings.fidelity == HighFidelity::NAME)
+    simulateWith<Math, HighFidelity>(initialState, rocket,
+                                     std::move(propulsion), settings);
+  else
+    throw std::invalid_argument("Unknown fidelity level: " +
+                                settings.fidelity);
+}
+
 int main() {
   try {
 
     RocketBody rocket(0,0,2,1); // to not trigger error of dry mass > wet mass
     PropulsionSystem propulsion(0);
-    parseConfig("src/config.json", rocket, propulsion);
+    SimulationSettings settings;
+    CurveLibrary curves;
+    parseConfig("src/config.json", rocket, propulsion, settings, curves);
+
+    if (settings.simd != "auto")
+      BatchKernels::select(simdPathFromName(settings.simd));
+    FileOutput::options().io = FileOutput::ioFromName(settings.logIo);
+    FileOutput::options().direct = settings.logDirect;
+    std::cout << "Batch kernels: "
+              << simdPathName(BatchKernels::active().path) << " (detected "
+              << simdPathName(detectSimdPath()) << ")\n";
 
     // Set initial state (100m above Earth's surface)
     State initialState(Vec3(Constants::EARTH_RADIUS + 100.0, 0, 0), // Position
@@ -46,71 +548,15 @@ int main() {
                        rocket.getMass(), // Initial mass
                        0.0);             // Initial time
 
-    // Initialize simulation
-    SimulationEngine sim(initialState, rocket, std::move(propulsion));
-
-    // Start engines at full throttle
-    sim.startEngines();
-    sim.setThrottle(1.0);
-
-    // Create and setup CSV file
-    std::ofstream dataFile("flight_data.csv");
-    dataFile << std::fixed << std::setprecision(6);
-    dataFile
-        << "Time,Altitude,Velocity_X,Velocity_Y,Velocity_Z,Velocity_Magnitude,"
-        << "Acceleration_X,Acceleration_Y,Acceleration_Z,Acceleration_"
-           "Magnitude,"
-        << "Mass,Fuel_Ratio,Air_Density,Air_Pressure,Temperature,"
-        << "Dynamic_Pressure,Mach_Number,Drag_Coefficient,Lift_Coefficient\n";
-
-    // Run simulation for 10 seconds
-    double endTime = 100.0;
-    while (sim.getTime() <= endTime) {
-      const State &state = sim.getState();
-
-      // Calculate current conditions
-      double altitude = state.position.magnitude() - Constants::EARTH_RADIUS;
-      double velocity_mag = state.velocity.magnitude();
-      double accel_mag = state.acceleration.magnitude();
-      double air_density = Atmosphere::getDensity(altitude);
-      double air_pressure = Atmosphere::getPressure(altitude);
-      double temperature = Atmosphere::getTemperature(altitude);
-      double dynamic_pressure = Aerodynamics::calculateDynamicPressure(state);
-      double mach_number =
-          velocity_mag /
-          std::sqrt(AeroConstants::GAMMA * AeroConstants::AIR_GAS_CONSTANT *
-                    temperature);
-
-      // Log data every second
-      if (std::fmod(sim.getTime(), 1.0) < 0.01) {
-        dataFile << sim.getTime() << "," << altitude << ","
-                 << state.velocity.x() << "," << state.velocity.y() << ","
-                 << state.velocity.z() << "," << velocity_mag << ","
-                 << state.acceleration.x() << "," << state.acceleration.y()
-                 << "," << state.acceleration.z() << "," << accel_mag << ","
-                 << state.mass << "," << sim.getRemainingFuelRatio() << ","
-                 << air_density << "," << air_pressure << "," << temperature
-                 << "," << dynamic_pressure << "," << mach_number << ","
-                 << rocket.getDragCoefficient() << ","
-                 << rocket.getLiftCoefficient() << "\n";
-
-        // Print progress to console
-        std::cout << "Time: " << std::setprecision(1) << std::fixed
-                  << sim.getTime() << "s, Altitude: " << std::setprecision(1)
-                  << altitude << "m, Velocity: " << velocity_mag << "m/s\n";
-      }
-
-      // Check if the altitude is below zero
-      if (altitude < 0) {
-        std::cout << "The rocket has crashed.\n";
-        break; // Exit the simulation loop
-      }
-
-      sim.step();
-    }
-
-    dataFile.close();
-    std::cout << "\nSimulation completed. Data saved to flight_data.csv\n";
+    // Initialize simulation with the configured accuracy policy
+    if (settings.math == ExactMath::NAME)
+      simulateWith<ExactMath>(initialState, rocket, std::move(propulsion),
+                              settings);
+    else if (settings.math == FastMath::NAME)
+      simulateWith<FastMath>(initialState, rocket, std::move(propulsion),
+                             settings);
+    else
+      throw std::invalid_argument("Unknown math policy: " + settings.math);
     return 0;
 
   } catch (const std::exception &e) {
@@ -0,0 +1,50 @@
+#pragma once
+#include <stdexcept>
+#include <string>
+
+// Instruction-set levels the batch kernels are built for, lowest first
+enum class SimdPath { Scalar, Sse2, Avx2, Avx512, Count };
+
+constexpr const char *simdPathName(SimdPath path) {
+  switch (path) {
+  case SimdPath::Scalar:
+    return "scalar";
+  case SimdPath::Sse2:
+    return "sse2";
+  case SimdPath::Avx2:
+    return "avx2";
+  case SimdPath::Avx512:
+    return "avx512";
+  default:
+    return "unknown";
+  }
+}
+
+inline SimdPath simdPathFromName(const std::string &name) {
+  for (int i = 0; i < static_cast<int>(SimdPath::Count); ++i) {
+    SimdPath path = static_cast<SimdPath>(i);
+    if (name == simdPathName(path))
+      return path;
+  }
+  throw std::invalid_argument("Unknown SIMD path: " + name);
+}
+
+// Best level the running CPU (and OS) supports. Only GCC on x86 builds the
+// AVX variants; other compilers and targets stop at their baseline.
+inline SimdPath detectSimdPath() {
+#if defined(__GNUC__) && !defined(__clang__) &&                               \
+    (defined(__x86_64__) || defined(__i386__))
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("fma"))
+    return SimdPath::Avx512;
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return SimdPath::Avx2;
+  if (__builtin_cpu_supports("sse2"))
+    return SimdPath::Sse2;
+  return SimdPath::Scalar;
+#elif defined(__SSE2__)
+  return SimdPath::Sse2;
+#else
+  return SimdPath::Scalar;
+#endif
+}
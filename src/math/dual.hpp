@@ -0,0 +1,100 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+
+// Forward-mode dual number: a value and its derivatives with respect to N
+// independent parameters. Running the physics on Dual<double, N> yields the
+// result and its gradient in one pass. Comparisons look at the value only.
+template <class T, std::size_t N = 1> class Dual {
+private:
+  T value_;
+  T d_[N]; // d value / d parameter
+
+public:
+  static constexpr std::size_t SIZE = N;
+
+  Dual() : value_(), d_{} {}
+  // Constant with no dependence on the parameters
+  Dual(double value) : value_(static_cast<T>(value)), d_{} {}
+
+  // The parameter-th independent variable
+  static Dual variable(T value, std::size_t parameter) {
+    Dual r(value);
+    r.d_[parameter] = T(1);
+    return r;
+  }
+
+  T value() const { return value_; }
+  T derivative(std::size_t parameter) const { return d_[parameter]; }
+
+  // The chain rule for a function with value f and slope df at this point
+  Dual chain(T f, T df) const {
+    Dual r;
+    r.value_ = f;
+    for (std::size_t i = 0; i < N; ++i)
+      r.d_[i] = df * d_[i];
+    return r;
+  }
+
+  friend Dual operator+(const Dual &a, const Dual &b) {
+    Dual r;
+    r.value_ = a.value_ + b.value_;
+    for (std::size_t i = 0; i < N; ++i)
+      r.d_[i] = a.d_[i] + b.d_[i];
+    return r;
+  }
+  friend Dual operator-(const Dual &a, const Dual &b) {
+    Dual r;
+    r.value_ = a.value_ - b.value_;
+    for (std::size_t i = 0; i < N; ++i)
+      r.d_[i] = a.d_[i] - b.d_[i];
+    return r;
+  }
+  friend Dual operator*(const Dual &a, const Dual &b) {
+    Dual r;
+    r.value_ = a.value_ * b.value_;
+    for (std::size_t i = 0; i < N; ++i)
+      r.d_[i] = a.d_[i] * b.value_ + a.value_ * b.d_[i];
+    return r;
+  }
+  friend Dual operator/(const Dual &a, const Dual &b) {
+    Dual r;
+    r.value_ = a.value_ / b.value_;
+    for (std::size_t i = 0; i < N; ++i)
+      r.d_[i] = (a.d_[i] - r.value_ * b.d_[i]) / b.value_;
+    return r;
+  }
+  friend Dual operator-(const Dual &a) { return a.chain(-a.value_, T(-1)); }
+
+  friend bool operator<(const Dual &a, const Dual &b) {
+    return a.value_ < b.value_;
+  }
+  friend bool operator<=(const Dual &a, const Dual &b) {
+    return a.value_ <= b.value_;
+  }
+  friend bool operator>(const Dual &a, const Dual &b) {
+    return a.value_ > b.value_;
+  }
+  friend bool operator>=(const Dual &a, const Dual &b) {
+    return a.value_ >= b.value_;
+  }
+
+  friend Dual sqrt(const Dual &a) {
+    T s = std::sqrt(a.value_);
+    return a.chain(s, T(0.5) / s);
+  }
+  friend Dual exp(const Dual &a) {
+    T e = std::exp(a.value_);
+    return a.chain(e, e);
+  }
+  friend Dual acos(const Dual &a) {
+    return a.chain(std::acos(a.value_),
+                   T(-1) / std::sqrt(T(1) - a.value_ * a.value_));
+  }
+  friend Dual sin(const Dual &a) {
+    return a.chain(std::sin(a.value_), std::cos(a.value_));
+  }
+  friend Dual abs(const Dual &a) {
+    return a.chain(std::abs(a.value_), a.value_ < T(0) ? T(-1) : T(1));
+  }
+};
@@ -0,0 +1,130 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+// Mask produced by comparing lane packs
+template <std::size_t N> class LaneMask {
+private:
+  bool m_[N];
+
+public:
+  LaneMask() : m_{} {}
+
+  bool operator[](std::size_t i) const { return m_[i]; }
+  bool &operator[](std::size_t i) { return m_[i]; }
+
+  bool any() const {
+    bool r = false;
+    for (std::size_t i = 0; i < N; ++i)
+      r = r || m_[i];
+    return r;
+  }
+  LaneMask operator!() const {
+    LaneMask r;
+    for (std::size_t i = 0; i < N; ++i)
+      r.m_[i] = !m_[i];
+    return r;
+  }
+};
+
+// N independent scalars advanced in lockstep, e.g. the members of an
+// ensemble. Every operation is a plain loop over the lanes, which the
+// compiler turns into vector instructions; Lanes<float, 8> fills an AVX
+// register where Lanes<double, 4> needs the same width.
+template <class T, std::size_t N> class alignas(sizeof(T) * N) Lanes {
+private:
+  T v_[N];
+
+  template <class F> static Lanes map(const Lanes &a, F f) {
+    Lanes r;
+    for (std::size_t i = 0; i < N; ++i)
+      r.v_[i] = f(a.v_[i]);
+    return r;
+  }
+  template <class F> static Lanes zip(const Lanes &a, const Lanes &b, F f) {
+    Lanes r;
+    for (std::size_t i = 0; i < N; ++i)
+      r.v_[i] = f(a.v_[i], b.v_[i]);
+    return r;
+  }
+  template <class F>
+  static LaneMask<N> compare(const Lanes &a, const Lanes &b, F f) {
+    LaneMask<N> r;
+    for (std::size_t i = 0; i < N; ++i)
+      r[i] = f(a.v_[i], b.v_[i]);
+    return r;
+  }
+
+public:
+  static constexpr std::size_t SIZE = N;
+
+  Lanes() : v_{} {}
+  // Broadcast, so constants mix freely with lane packs
+  Lanes(double s) {
+    for (std::size_t i = 0; i < N; ++i)
+      v_[i] = static_cast<T>(s);
+  }
+
+  T operator[](std::size_t i) const { return v_[i]; }
+  T &operator[](std::size_t i) { return v_[i]; }
+
+  // f applied to each lane
+  template <class F> Lanes apply(F f) const { return map(*this, f); }
+
+  static Lanes select(const LaneMask<N> &m, const Lanes &a, const Lanes &b) {
+    Lanes r;
+    for (std::size_t i = 0; i < N; ++i)
+      r.v_[i] = m[i] ? a.v_[i] : b.v_[i];
+    return r;
+  }
+
+  friend Lanes operator+(const Lanes &a, const Lanes &b) {
+    return zip(a, b, [](T x, T y) { return x + y; });
+  }
+  friend Lanes operator-(const Lanes &a, const Lanes &b) {
+    return zip(a, b, [](T x, T y) { return x - y; });
+  }
+  friend Lanes operator*(const Lanes &a, const Lanes &b) {
+    return zip(a, b, [](T x, T y) { return x * y; });
+  }
+  friend Lanes operator/(const Lanes &a, const Lanes &b) {
+    return zip(a, b, [](T x, T y) { return x / y; });
+  }
+  friend Lanes operator-(const Lanes &a) {
+    return map(a, [](T x) { return -x; });
+  }
+
+  friend LaneMask<N> operator<(const Lanes &a, const Lanes &b) {
+    return compare(a, b, [](T x, T y) { return x < y; });
+  }
+  friend LaneMask<N> operator<=(const Lanes &a, const Lanes &b) {
+    return compare(a, b, [](T x, T y) { return x <= y; });
+  }
+  friend LaneMask<N> operator>(const Lanes &a, const Lanes &b) {
+    return compare(a, b, [](T x, T y) { return x > y; });
+  }
+  friend LaneMask<N> operator>=(const Lanes &a, const Lanes &b) {
+    return compare(a, b, [](T x, T y) { return x >= y; });
+  }
+
+  friend Lanes sqrt(const Lanes &a) {
+    return map(a, [](T x) { return std::sqrt(x); });
+  }
+  friend Lanes exp(const Lanes &a) {
+    return map(a, [](T x) { return std::exp(x); });
+  }
+  friend Lanes acos(const Lanes &a) {
+    return map(a, [](T x) { return std::acos(x); });
+  }
+  friend Lanes sin(const Lanes &a) {
+    return map(a, [](T x) { return std::sin(x); });
+  }
+  friend Lanes abs(const Lanes &a) {
+    return map(a, [](T x) { return std::abs(x); });
+  }
+};
+
+template <class T> struct IsLanes : std::false_type {};
+template <class T, std::size_t N>
+struct IsLanes<Lanes<T, N>> : std::true_type {};
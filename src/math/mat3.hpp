@@ -0,0 +1,109 @@
+#pragma once
+#include "vec3.hpp"
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+
+// 3x3 matrix stored as three padded Vec3 columns, so M * v is three scaled
+// column loads fused into one expression (multiply-adds, no shuffles).
+class Mat3 {
+private:
+  Vec3 c_[3]; // Columns
+
+public:
+  Mat3() : c_{Vec3(), Vec3(), Vec3()} {}
+
+  static Mat3 fromColumns(const Vec3 &c0, const Vec3 &c1, const Vec3 &c2) {
+    Mat3 m;
+    m.c_[0] = c0;
+    m.c_[1] = c1;
+    m.c_[2] = c2;
+    return m;
+  }
+  static Mat3 fromRows(const Vec3 &r0, const Vec3 &r1, const Vec3 &r2) {
+    return fromColumns(Vec3(r0.x(), r1.x(), r2.x()),
+                       Vec3(r0.y(), r1.y(), r2.y()),
+                       Vec3(r0.z(), r1.z(), r2.z()));
+  }
+  static Mat3 identity() {
+    return fromColumns(Vec3(1, 0, 0), Vec3(0, 1, 0), Vec3(0, 0, 1));
+  }
+  // Symmetric matrix from its diagonal and the xy, xz, yz terms
+  static Mat3 symmetric(double xx, double yy, double zz, double xy, double xz,
+                        double yz) {
+    return fromColumns(Vec3(xx, xy, xz), Vec3(xy, yy, yz), Vec3(xz, yz, zz));
+  }
+
+  // Right-handed rotations about the body axes (rad)
+  static Mat3 rotationX(double angle) {
+    double c = std::cos(angle), s = std::sin(angle);
+    return fromColumns(Vec3(1, 0, 0), Vec3(0, c, s), Vec3(0, -s, c));
+  }
+  static Mat3 rotationY(double angle) {
+    double c = std::cos(angle), s = std::sin(angle);
+    return fromColumns(Vec3(c, 0, -s), Vec3(0, 1, 0), Vec3(s, 0, c));
+  }
+  static Mat3 rotationZ(double angle) {
+    double c = std::cos(angle), s = std::sin(angle);
+    return fromColumns(Vec3(c, s, 0), Vec3(-s, c, 0), Vec3(0, 0, 1));
+  }
+
+  double operator()(std::size_t row, std::size_t col) const {
+    return c_[col][row];
+  }
+  const Vec3 &column(std::size_t col) const { return c_[col]; }
+  Vec3 row(std::size_t row) const {
+    return Vec3(c_[0][row], c_[1][row], c_[2][row]);
+  }
+
+  Vec3 operator*(const Vec3 &v) const {
+    return c_[0] * v.x() + c_[1] * v.y() + c_[2] * v.z();
+  }
+  Mat3 operator*(const Mat3 &other) const {
+    return fromColumns(*this * other.c_[0], *this * other.c_[1],
+                       *this * other.c_[2]);
+  }
+  Mat3 operator*(double scalar) const {
+    return fromColumns(c_[0] * scalar, c_[1] * scalar, c_[2] * scalar);
+  }
+  Mat3 operator+(const Mat3 &other) const {
+    return fromColumns(c_[0] + other.c_[0], c_[1] + other.c_[1],
+                       c_[2] + other.c_[2]);
+  }
+  Mat3 operator-(const Mat3 &other) const {
+    return fromColumns(c_[0] - other.c_[0], c_[1] - other.c_[1],
+                       c_[2] - other.c_[2]);
+  }
+
+  Mat3 transpose() const { return fromRows(c_[0], c_[1], c_[2]); }
+  double determinant() const { return c_[0].dot(c_[1].cross(c_[2])); }
+
+  // Rows of the inverse are the pairwise column cross products / det
+  Mat3 inverse() const {
+    double det = determinant();
+    if (det == 0.0)
+      throw std::invalid_argument("Matrix is singular");
+    return fromRows(c_[1].cross(c_[2]), c_[2].cross(c_[0]),
+                    c_[0].cross(c_[1])) *
+           (1.0 / det);
+  }
+
+  // Inverse of a symmetric matrix (e.g. an inertia tensor) from its six
+  // distinct cofactors; the result is symmetric too
+  Mat3 symmetricInverse() const {
+    double a = c_[0].x(), b = c_[1].y(), c = c_[2].z();
+    double d = c_[1].x(), e = c_[2].x(), f = c_[2].y(); // xy, xz, yz
+    double ca = b * c - f * f;
+    double cb = a * c - e * e;
+    double cc = a * b - d * d;
+    double cd = e * f - d * c;
+    double ce = d * f - b * e;
+    double cf = d * e - a * f;
+    double det = a * ca + d * cd + e * ce;
+    if (det == 0.0)
+      throw std::invalid_argument("Matrix is singular");
+    double inv = 1.0 / det;
+    return symmetric(ca * inv, cb * inv, cc * inv, cd * inv, ce * inv,
+                     cf * inv);
+  }
+};
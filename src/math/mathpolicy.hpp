@@ -0,0 +1,145 @@
+#pragma once
+#include "lanes.hpp"
+#include "scalar.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Accuracy policies for the transcendental functions in the force models.
+// A policy is a template argument, so each choice compiles to its own hot
+// path. The *_ERROR constants are each policy's error budget over the full
+// input range (relative for exp and sqrt, radians for acos), measured by
+// measureMathError() below and checked by tests/mathpolicy_test.cpp.
+
+// Library functions, correctly rounded or within an ulp
+struct ExactMath {
+  static constexpr const char *NAME = "exact";
+  static constexpr double EXP_ERROR = 0.0;
+  static constexpr double SQRT_ERROR = 0.0;
+  static constexpr double ACOS_ERROR = 0.0;
+
+  template <class T> static T exp(const T &x) { return Scalar::exp(x); }
+  template <class T> static T sqrt(const T &x) { return Scalar::sqrt(x); }
+  template <class T> static T acos(const T &x) { return Scalar::acos(x); }
+};
+
+// Branch-free polynomial kernels that vectorize across Lanes, unlike the
+// library calls. sqrt stays on the hardware instruction: no double-precision
+// approximation is cheaper. Dual numbers fall back to ExactMath so their
+// derivatives stay consistent.
+struct FastMath {
+  static constexpr const char *NAME = "fast";
+  // Degree-10 Taylor polynomial on |r| <= ln2/2: r^11/11! < 2.2e-13
+  static constexpr double EXP_ERROR = 5e-13;
+  static constexpr double SQRT_ERROR = 0.0;
+  // Abramowitz & Stegun 4.4.46: |error| <= 2e-8 on [0, 1], plus rounding
+  static constexpr double ACOS_ERROR = 3e-8;
+
+  // e^x for x clamped to [-708, 709]. x = k ln2 + r with k rounded by the
+  // 1.5 * 2^52 trick, then 2^k is assembled directly in the exponent bits.
+  static double expKernel(double x) {
+    const double LOG2E = 1.4426950408889634;
+    // ln2 in two parts; LN2_HI has 32 trailing zero bits, so k * LN2_HI is
+    // exact and the reduction loses nothing
+    const double LN2_HI = 0.6931471803691238;
+    const double LN2_LO = 1.9082149292705877e-10;
+    const double ROUND = 6755399441055744.0; // 1.5 * 2^52
+
+    x = std::min(std::max(x, -708.0), 709.0);
+    double t = x * LOG2E + ROUND;
+    double k = t - ROUND;
+    double r = (x - k * LN2_HI) - k * LN2_LO;
+
+    double p = 1.0 / 3628800.0;
+    p = p * r + 1.0 / 362880.0;
+    p = p * r + 1.0 / 40320.0;
+    p = p * r + 1.0 / 5040.0;
+    p = p * r + 1.0 / 720.0;
+    p = p * r + 1.0 / 120.0;
+    p = p * r + 1.0 / 24.0;
+    p = p * r + 1.0 / 6.0;
+    p = p * r + 0.5;
+    p = p * r + 1.0;
+    p = p * r + 1.0;
+
+    std::int64_t tBits, roundBits;
+    std::memcpy(&tBits, &t, sizeof t);
+    std::memcpy(&roundBits, &ROUND, sizeof ROUND);
+    std::int64_t scaleBits = (tBits - roundBits + 1023) << 52;
+    double scale;
+    std::memcpy(&scale, &scaleBits, sizeof scale);
+    return p * scale;
+  }
+
+  static double acosKernel(double x) {
+    const double PI = 3.14159265358979323846;
+    x = std::min(std::max(x, -1.0), 1.0);
+    double a = std::abs(x);
+    double p = -0.0012624911;
+    p = p * a + 0.0066700901;
+    p = p * a - 0.0170881256;
+    p = p * a + 0.0308918810;
+    p = p * a - 0.0501743046;
+    p = p * a + 0.0889789874;
+    p = p * a - 0.2145988016;
+    p = p * a + 1.5707963050;
+    double r = std::sqrt(1.0 - a) * p;
+    return x < 0.0 ? PI - r : r;
+  }
+
+  template <class T> static T exp(const T &x) {
+    if constexpr (std::is_floating_point_v<T>)
+      return static_cast<T>(expKernel(x));
+    else if constexpr (IsLanes<T>::value)
+      return x.apply([](auto v) { return expKernel(v); });
+    else
+      return Scalar::exp(x);
+  }
+  template <class T> static T sqrt(const T &x) { return Scalar::sqrt(x); }
+  template <class T> static T acos(const T &x) {
+    if constexpr (std::is_floating_point_v<T>)
+      return static_cast<T>(acosKernel(x));
+    else if constexpr (IsLanes<T>::value)
+      return x.apply([](auto v) { return acosKernel(v); });
+    else
+      return Scalar::acos(x);
+  }
+};
+
+// Largest error of a policy against the library functions, sampled
+// uniformly over exp on [-700, 700], sqrt on [0, 1e12] and acos on [-1, 1]
+struct MathErrorReport {
+  double exp = 0.0;  // Relative
+  double sqrt = 0.0; // Relative
+  double acos = 0.0; // Radians
+
+  template <class Math> bool withinBudget() const {
+    return exp <= Math::EXP_ERROR && sqrt <= Math::SQRT_ERROR &&
+           acos <= Math::ACOS_ERROR;
+  }
+};
+
+template <class Math>
+MathErrorReport measureMathError(std::size_t samples = 100000) {
+  MathErrorReport report;
+  for (std::size_t i = 0; i <= samples; ++i) {
+    double u = static_cast<double>(i) / samples;
+
+    double x = -700.0 + 1400.0 * u;
+    double e = std::exp(x);
+    report.exp = std::max(report.exp, std::abs(Math::exp(x) - e) / e);
+
+    double y = 1e12 * u;
+    double s = std::sqrt(y);
+    if (s > 0.0)
+      report.sqrt = std::max(report.sqrt, std::abs(Math::sqrt(y) - s) / s);
+
+    double z = -1.0 + 2.0 * u;
+    report.acos =
+        std::max(report.acos, std::abs(Math::acos(z) - std::acos(z)));
+  }
+  return report;
+}
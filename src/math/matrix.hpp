@@ -0,0 +1,116 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+
+// Fixed-size dense matrix for small filters and least-squares problems.
+// Storage is an in-place row-major array (never the heap) and every loop
+// has a compile-time trip count, so the compiler fully unrolls them.
+template <std::size_t N, std::size_t M, class T = double> class Matrix {
+private:
+  std::array<T, N * M> a_;
+
+public:
+  static constexpr std::size_t ROWS = N;
+  static constexpr std::size_t COLS = M;
+
+  Matrix() : a_{} {}
+
+  static Matrix identity() {
+    static_assert(N == M, "Identity needs a square matrix");
+    Matrix m;
+    for (std::size_t i = 0; i < N; ++i)
+      m(i, i) = T(1);
+    return m;
+  }
+
+  T operator()(std::size_t row, std::size_t col) const {
+    return a_[row * M + col];
+  }
+  T &operator()(std::size_t row, std::size_t col) { return a_[row * M + col]; }
+
+  Matrix operator+(const Matrix &other) const {
+    Matrix r;
+    for (std::size_t i = 0; i < N * M; ++i)
+      r.a_[i] = a_[i] + other.a_[i];
+    return r;
+  }
+  Matrix operator-(const Matrix &other) const {
+    Matrix r;
+    for (std::size_t i = 0; i < N * M; ++i)
+      r.a_[i] = a_[i] - other.a_[i];
+    return r;
+  }
+  Matrix operator*(T scalar) const {
+    Matrix r;
+    for (std::size_t i = 0; i < N * M; ++i)
+      r.a_[i] = a_[i] * scalar;
+    return r;
+  }
+
+  // Row-times-matrix accumulation keeps the inner loop contiguous
+  template <std::size_t K>
+  Matrix<N, K, T> operator*(const Matrix<M, K, T> &other) const {
+    Matrix<N, K, T> r;
+    for (std::size_t i = 0; i < N; ++i)
+      for (std::size_t j = 0; j < M; ++j) {
+        T aij = (*this)(i, j);
+        for (std::size_t k = 0; k < K; ++k)
+          r(i, k) += aij * other(j, k);
+      }
+    return r;
+  }
+
+  Matrix<M, N, T> transpose() const {
+    Matrix<M, N, T> r;
+    for (std::size_t i = 0; i < N; ++i)
+      for (std::size_t j = 0; j < M; ++j)
+        r(j, i) = (*this)(i, j);
+    return r;
+  }
+};
+
+template <std::size_t N, class T = double> using Vector = Matrix<N, 1, T>;
+
+// Lower-triangular L with L L^T = A for a symmetric positive-definite A
+template <std::size_t N, class T>
+Matrix<N, N, T> cholesky(const Matrix<N, N, T> &a) {
+  Matrix<N, N, T> l;
+  for (std::size_t j = 0; j < N; ++j) {
+    T diagonal = a(j, j);
+    for (std::size_t k = 0; k < j; ++k)
+      diagonal -= l(j, k) * l(j, k);
+    if (!(diagonal > T(0)))
+      throw std::invalid_argument("Matrix is not positive definite");
+    l(j, j) = std::sqrt(diagonal);
+
+    for (std::size_t i = j + 1; i < N; ++i) {
+      T sum = a(i, j);
+      for (std::size_t k = 0; k < j; ++k)
+        sum -= l(i, k) * l(j, k);
+      l(i, j) = sum / l(j, j);
+    }
+  }
+  return l;
+}
+
+// Solve A x = b given the Cholesky factor L of A
+template <std::size_t N, std::size_t K, class T>
+Matrix<N, K, T> choleskySolve(const Matrix<N, N, T> &l,
+                              const Matrix<N, K, T> &b) {
+  Matrix<N, K, T> x = b;
+  for (std::size_t c = 0; c < K; ++c) {
+    for (std::size_t i = 0; i < N; ++i) { // L y = b
+      for (std::size_t k = 0; k < i; ++k)
+        x(i, c) -= l(i, k) * x(k, c);
+      x(i, c) /= l(i, i);
+    }
+    for (std::size_t i = N; i-- > 0;) { // L^T x = y
+      for (std::size_t k = i + 1; k < N; ++k)
+        x(i, c) -= l(k, i) * x(k, c);
+      x(i, c) /= l(i, i);
+    }
+  }
+  return x;
+}
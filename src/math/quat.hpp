@@ -0,0 +1,62 @@
+#pragma once
+#include "mat3.hpp"
+#include "vec3.hpp"
+#include <cmath>
+
+// Unit quaternion w + xi + yj + zk for attitudes. The vector part is kept
+// as a Vec3 so products and rotations use the SIMD cross and dot.
+class Quat {
+private:
+  double w_;
+  Vec3 v_;
+
+public:
+  Quat() : w_(1.0), v_() {}
+  Quat(double w, const Vec3 &v) : w_(w), v_(v) {}
+  Quat(double w, double x, double y, double z) : w_(w), v_(x, y, z) {}
+
+  static Quat identity() { return Quat(); }
+  // Rotation by angle (rad) about axis, which need not be normalized
+  static Quat fromAxisAngle(const Vec3 &axis, double angle) {
+    return Quat(std::cos(0.5 * angle),
+                axis.normalize() * std::sin(0.5 * angle));
+  }
+
+  double w() const { return w_; }
+  double x() const { return v_.x(); }
+  double y() const { return v_.y(); }
+  double z() const { return v_.z(); }
+  const Vec3 &vector() const { return v_; }
+
+  // Hamilton product: rotating by *this after other
+  Quat operator*(const Quat &other) const {
+    return Quat(w_ * other.w_ - v_.dot(other.v_),
+                other.v_ * w_ + v_ * other.w_ + v_.cross(other.v_));
+  }
+
+  Quat conjugate() const { return Quat(w_, v_ * -1.0); }
+  double norm() const { return std::sqrt(w_ * w_ + v_.dot(v_)); }
+  Quat normalize() const {
+    double n = norm();
+    if (n <= 0.0)
+      return *this;
+    return Quat(w_ / n, v_ / n);
+  }
+
+  // q v q* without forming the matrix: v + 2w (u x v) + 2 u x (u x v)
+  Vec3 rotate(const Vec3 &v) const {
+    Vec3 t = v_.cross(v) * 2.0;
+    return v + t * w_ + v_.cross(t);
+  }
+
+  Mat3 toMat3() const {
+    double w = w_, x = v_.x(), y = v_.y(), z = v_.z();
+    return Mat3::fromRows(
+        Vec3(1 - 2 * (y * y + z * z), 2 * (x * y - w * z),
+             2 * (x * z + w * y)),
+        Vec3(2 * (x * y + w * z), 1 - 2 * (x * x + z * z),
+             2 * (y * z - w * x)),
+        Vec3(2 * (x * z - w * y), 2 * (y * z + w * x),
+             1 - 2 * (x * x + y * y)));
+  }
+};
@@ -0,0 +1,61 @@
+#pragma once
+#include <cmath>
+#include <type_traits>
+
+// Scalar operations used by the type-generic physics core. Plain float and
+// double go to <cmath>; other scalar types (Lanes, Dual) supply their own
+// overloads that are found by argument-dependent lookup. Comparisons on a
+// lane pack yield a mask rather than a bool, so branches in generic code are
+// written with select() and anyOf().
+namespace Scalar {
+
+template <class T> T sqrt(const T &x) {
+  using std::sqrt;
+  return sqrt(x);
+}
+template <class T> T exp(const T &x) {
+  using std::exp;
+  return exp(x);
+}
+template <class T> T acos(const T &x) {
+  using std::acos;
+  return acos(x);
+}
+template <class T> T sin(const T &x) {
+  using std::sin;
+  return sin(x);
+}
+template <class T> T abs(const T &x) {
+  using std::abs;
+  return abs(x);
+}
+
+// condition ? a : b, lane by lane for masks
+template <class C, class T> T select(const C &condition, const T &a,
+                                     const T &b) {
+  if constexpr (std::is_same_v<C, bool>) {
+    return condition ? a : b;
+  } else {
+    return T::select(condition, a, b);
+  }
+}
+
+// The plain value of a scalar, dropping any derivative part
+template <class T> double value(const T &x) {
+  if constexpr (std::is_arithmetic_v<T>) {
+    return x;
+  } else {
+    return x.value();
+  }
+}
+
+// True when the condition holds for at least one lane
+template <class C> bool anyOf(const C &condition) {
+  if constexpr (std::is_same_v<C, bool>) {
+    return condition;
+  } else {
+    return condition.any();
+  }
+}
+
+} // namespace Scalar
@@ -0,0 +1,192 @@
+#pragma once
+#include <cmath>
+
+// Backend for the padded Vec3 layout: one 256-bit register on AVX2, two
+// 128-bit registers on SSE2, or plain arrays elsewhere. Define
+// NOVA_VEC3_PORTABLE to force the portable path on any target.
+#if !defined(NOVA_VEC3_PORTABLE) && defined(__AVX2__)
+#define NOVA_VEC3_AVX2 1
+#include <immintrin.h>
+#elif !defined(NOVA_VEC3_PORTABLE) && defined(__SSE2__)
+#define NOVA_VEC3_SSE2 1
+#include <emmintrin.h>
+#if defined(__FMA__)
+#include <immintrin.h>
+#endif
+#endif
+
+// Four doubles in registers: x, y, z and a padding lane that the
+// horizontal operations ignore
+class Double4 {
+private:
+#if defined(NOVA_VEC3_AVX2)
+  __m256d r_;
+  explicit Double4(__m256d r) : r_(r) {}
+#elif defined(NOVA_VEC3_SSE2)
+  __m128d lo_, hi_; // (x, y), (z, w)
+  Double4(__m128d lo, __m128d hi) : lo_(lo), hi_(hi) {}
+#else
+  double v_[4];
+  Double4(double x, double y, double z, double w) : v_{x, y, z, w} {}
+#endif
+
+public:
+  static const char *backendName() {
+#if defined(NOVA_VEC3_AVX2)
+    return "avx2";
+#elif defined(NOVA_VEC3_SSE2)
+    return "sse2";
+#else
+    return "portable";
+#endif
+  }
+
+  // p must be aligned to 32 bytes
+  static Double4 load(const double *p) {
+#if defined(NOVA_VEC3_AVX2)
+    return Double4(_mm256_load_pd(p));
+#elif defined(NOVA_VEC3_SSE2)
+    return Double4(_mm_load_pd(p), _mm_load_pd(p + 2));
+#else
+    return Double4(p[0], p[1], p[2], p[3]);
+#endif
+  }
+
+  void store(double *p) const {
+#if defined(NOVA_VEC3_AVX2)
+    _mm256_store_pd(p, r_);
+#elif defined(NOVA_VEC3_SSE2)
+    _mm_store_pd(p, lo_);
+    _mm_store_pd(p + 2, hi_);
+#else
+    for (int i = 0; i < 4; ++i)
+      p[i] = v_[i];
+#endif
+  }
+
+  static Double4 broadcast(double s) {
+#if defined(NOVA_VEC3_AVX2)
+    return Double4(_mm256_set1_pd(s));
+#elif defined(NOVA_VEC3_SSE2)
+    return Double4(_mm_set1_pd(s), _mm_set1_pd(s));
+#else
+    return Double4(s, s, s, s);
+#endif
+  }
+
+  friend Double4 operator+(const Double4 &a, const Double4 &b) {
+#if defined(NOVA_VEC3_AVX2)
+    return Double4(_mm256_add_pd(a.r_, b.r_));
+#elif defined(NOVA_VEC3_SSE2)
+    return Double4(_mm_add_pd(a.lo_, b.lo_), _mm_add_pd(a.hi_, b.hi_));
+#else
+    return Double4(a.v_[0] + b.v_[0], a.v_[1] + b.v_[1], a.v_[2] + b.v_[2],
+                   a.v_[3] + b.v_[3]);
+#endif
+  }
+
+  friend Double4 operator-(const Double4 &a, const Double4 &b) {
+#if defined(NOVA_VEC3_AVX2)
+    return Double4(_mm256_sub_pd(a.r_, b.r_));
+#elif defined(NOVA_VEC3_SSE2)
+    return Double4(_mm_sub_pd(a.lo_, b.lo_), _mm_sub_pd(a.hi_, b.hi_));
+#else
+    return Double4(a.v_[0] - b.v_[0], a.v_[1] - b.v_[1], a.v_[2] - b.v_[2],
+                   a.v_[3] - b.v_[3]);
+#endif
+  }
+
+  friend Double4 operator*(const Double4 &a, const Double4 &b) {
+#if defined(NOVA_VEC3_AVX2)
+    return Double4(_mm256_mul_pd(a.r_, b.r_));
+#elif defined(NOVA_VEC3_SSE2)
+    return Double4(_mm_mul_pd(a.lo_, b.lo_), _mm_mul_pd(a.hi_, b.hi_));
+#else
+    return Double4(a.v_[0] * b.v_[0], a.v_[1] * b.v_[1], a.v_[2] * b.v_[2],
+                   a.v_[3] * b.v_[3]);
+#endif
+  }
+
+  friend Double4 operator/(const Double4 &a, const Double4 &b) {
+#if defined(NOVA_VEC3_AVX2)
+    return Double4(_mm256_div_pd(a.r_, b.r_));
+#elif defined(NOVA_VEC3_SSE2)
+    return Double4(_mm_div_pd(a.lo_, b.lo_), _mm_div_pd(a.hi_, b.hi_));
+#else
+    return Double4(a.v_[0] / b.v_[0], a.v_[1] / b.v_[1], a.v_[2] / b.v_[2],
+                   a.v_[3] / b.v_[3]);
+#endif
+  }
+
+  // a * b + c, contracted to one rounding when the target has FMA
+  static Double4 fma(const Double4 &a, const Double4 &b, const Double4 &c) {
+#if defined(NOVA_VEC3_AVX2) && defined(__FMA__)
+    return Double4(_mm256_fmadd_pd(a.r_, b.r_, c.r_));
+#elif defined(NOVA_VEC3_SSE2) && defined(__FMA__)
+    return Double4(_mm_fmadd_pd(a.lo_, b.lo_, c.lo_),
+                   _mm_fmadd_pd(a.hi_, b.hi_, c.hi_));
+#elif !defined(NOVA_VEC3_AVX2) && !defined(NOVA_VEC3_SSE2) && defined(__FMA__)
+    return Double4(std::fma(a.v_[0], b.v_[0], c.v_[0]),
+                   std::fma(a.v_[1], b.v_[1], c.v_[1]),
+                   std::fma(a.v_[2], b.v_[2], c.v_[2]),
+                   std::fma(a.v_[3], b.v_[3], c.v_[3]));
+#else
+    return a * b + c;
+#endif
+  }
+
+  // c - a * b, contracted like fma
+  static Double4 fnma(const Double4 &a, const Double4 &b, const Double4 &c) {
+#if defined(NOVA_VEC3_AVX2) && defined(__FMA__)
+    return Double4(_mm256_fnmadd_pd(a.r_, b.r_, c.r_));
+#elif defined(NOVA_VEC3_SSE2) && defined(__FMA__)
+    return Double4(_mm_fnmadd_pd(a.lo_, b.lo_, c.lo_),
+                   _mm_fnmadd_pd(a.hi_, b.hi_, c.hi_));
+#elif !defined(NOVA_VEC3_AVX2) && !defined(NOVA_VEC3_SSE2) && defined(__FMA__)
+    return Double4(std::fma(-a.v_[0], b.v_[0], c.v_[0]),
+                   std::fma(-a.v_[1], b.v_[1], c.v_[1]),
+                   std::fma(-a.v_[2], b.v_[2], c.v_[2]),
+                   std::fma(-a.v_[3], b.v_[3], c.v_[3]));
+#else
+    return c - a * b;
+#endif
+  }
+
+  // (x + y) + z, same association as the scalar dot product
+  double sum3() const {
+#if defined(NOVA_VEC3_AVX2)
+    __m128d xy = _mm256_castpd256_pd128(r_);
+    __m128d zw = _mm256_extractf128_pd(r_, 1);
+    __m128d s = _mm_add_sd(xy, _mm_unpackhi_pd(xy, xy));
+    return _mm_cvtsd_f64(_mm_add_sd(s, zw));
+#elif defined(NOVA_VEC3_SSE2)
+    __m128d s = _mm_add_sd(lo_, _mm_unpackhi_pd(lo_, lo_));
+    return _mm_cvtsd_f64(_mm_add_sd(s, hi_));
+#else
+    return (v_[0] + v_[1]) + v_[2];
+#endif
+  }
+
+  // Lane rotations used by the cross product
+  Double4 yzx() const {
+#if defined(NOVA_VEC3_AVX2)
+    return Double4(_mm256_permute4x64_pd(r_, _MM_SHUFFLE(3, 0, 2, 1)));
+#elif defined(NOVA_VEC3_SSE2)
+    return Double4(_mm_shuffle_pd(lo_, hi_, 0x1),
+                   _mm_shuffle_pd(lo_, hi_, 0x2));
+#else
+    return Double4(v_[1], v_[2], v_[0], v_[3]);
+#endif
+  }
+
+  Double4 zxy() const {
+#if defined(NOVA_VEC3_AVX2)
+    return Double4(_mm256_permute4x64_pd(r_, _MM_SHUFFLE(3, 1, 0, 2)));
+#elif defined(NOVA_VEC3_SSE2)
+    return Double4(_mm_shuffle_pd(hi_, lo_, 0x0),
+                   _mm_shuffle_pd(lo_, hi_, 0x3));
+#else
+    return Double4(v_[2], v_[0], v_[1], v_[3]);
+#endif
+  }
+};
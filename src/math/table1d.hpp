@@ -0,0 +1,98 @@
+#pragma once
+#include "scalar.hpp"
+#include <cstddef>
+#include <istream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Piecewise-linear table y(x) over strictly increasing breakpoints, clamped
+// at both ends. Lookups take a cursor (the segment found last time) and walk
+// from there, so queries that move steadily through the table are O(1).
+class Table1D {
+private:
+  std::vector<double> x_;
+  std::vector<double> y_;
+
+public:
+  Table1D(std::vector<double> x, std::vector<double> y)
+      : x_(std::move(x)), y_(std::move(y)) {
+    if (x_.size() != y_.size())
+      throw std::invalid_argument("Table columns differ in length");
+    if (x_.size() < 2)
+      throw std::invalid_argument("Table needs at least two rows");
+    for (std::size_t i = 1; i < x_.size(); ++i) {
+      if (!(x_[i] > x_[i - 1]))
+        throw std::invalid_argument("Table breakpoints must increase");
+    }
+  }
+
+  std::size_t size() const { return x_.size(); }
+  double x(std::size_t i) const { return x_[i]; }
+  double y(std::size_t i) const { return y_[i]; }
+  double front() const { return x_.front(); }
+  double back() const { return x_.back(); }
+
+  // Segment index i with x_[i] <= x < x_[i + 1], starting from cursor
+  std::size_t seek(double x, std::size_t cursor) const {
+    std::size_t last = x_.size() - 2;
+    if (cursor > last)
+      cursor = last;
+    while (cursor < last && x >= x_[cursor + 1])
+      ++cursor;
+    while (cursor > 0 && x < x_[cursor])
+      --cursor;
+    return cursor;
+  }
+
+  // Interpolate within segment i (clamped outside the table)
+  double interpolate(double x, std::size_t i) const {
+    if (x <= x_[i])
+      return y_[i];
+    if (x >= x_[i + 1])
+      return y_[i + 1];
+    double t = (x - x_[i]) / (x_[i + 1] - x_[i]);
+    return y_[i] + t * (y_[i + 1] - y_[i]);
+  }
+
+  // The same for a scalar with a value part (e.g. Dual): the value picks
+  // the segment and the derivatives follow its slope
+  template <class T> T interpolate(const T &x, std::size_t i) const {
+    double v = Scalar::value(x);
+    if (v <= x_[i])
+      return T(y_[i]);
+    if (v >= x_[i + 1])
+      return T(y_[i + 1]);
+    return y_[i] + (x - x_[i]) * ((y_[i + 1] - y_[i]) / (x_[i + 1] - x_[i]));
+  }
+
+  double lookup(double x, std::size_t &cursor) const {
+    cursor = seek(x, cursor);
+    return interpolate(x, cursor);
+  }
+
+  // Two numeric columns separated by commas or whitespace. Blank lines,
+  // '#' comments and a non-numeric header row are skipped.
+  static Table1D fromCsv(std::istream &in) {
+    std::vector<double> x, y;
+    std::string line;
+    while (std::getline(in, line)) {
+      std::size_t comment = line.find('#');
+      if (comment != std::string::npos)
+        line.erase(comment);
+      for (char &c : line) {
+        if (c == ',')
+          c = ' ';
+      }
+      std::istringstream row(line);
+      double a, b;
+      if (row >> a >> b) {
+        x.push_back(a);
+        y.push_back(b);
+      }
+    }
+    return Table1D(std::move(x), std::move(y));
+  }
+};
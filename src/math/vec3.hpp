@@ -1,40 +1,101 @@
 #pragma once
+#include "scalar.hpp"
+#include "simd.hpp"
+#include "vecexpr.hpp"
 #include <cmath>
+#include <cstddef>
 
-class Vec3 {
+// Three-component vector over any scalar type with the usual arithmetic
+// (float, Lanes, Dual). double has its own SIMD specialization below.
+template <class T> class BasicVec3 {
 private:
-  double x_, y_, z_;
+  T x_, y_, z_;
 
 public:
-  Vec3() : x_(0.0), y_(0.0), z_(0.0) {}
-  Vec3(double x, double y, double z) : x_(x), y_(y), z_(z) {}
+  BasicVec3() : x_(0.0), y_(0.0), z_(0.0) {}
+  BasicVec3(T x, T y, T z) : x_(x), y_(y), z_(z) {}
+  // From a vector of another scalar type, e.g. a double Vec3 as constant
+  template <class U>
+  explicit BasicVec3(const BasicVec3<U> &v) : x_(v.x()), y_(v.y()), z_(v.z()) {}
 
-  double x() const { return x_; }
-  double y() const { return y_; }
-  double z() const { return z_; }
+  T x() const { return x_; }
+  T y() const { return y_; }
+  T z() const { return z_; }
+  T operator[](std::size_t i) const { return i == 0 ? x_ : i == 1 ? y_ : z_; }
 
-  Vec3 operator+(const Vec3 &other) const {
-    return Vec3(x_ + other.x_, y_ + other.y_, z_ + other.z_);
+  BasicVec3 operator+(const BasicVec3 &other) const {
+    return BasicVec3(x_ + other.x_, y_ + other.y_, z_ + other.z_);
   }
-  Vec3 operator-(const Vec3 &other) const {
-    return Vec3(x_ - other.x_, y_ - other.y_, z_ - other.z_);
+  BasicVec3 operator-(const BasicVec3 &other) const {
+    return BasicVec3(x_ - other.x_, y_ - other.y_, z_ - other.z_);
   }
-  Vec3 operator*(double scalar) const {
-    return Vec3(x_ * scalar, y_ * scalar, z_ * scalar);
+  BasicVec3 operator*(T scalar) const {
+    return BasicVec3(x_ * scalar, y_ * scalar, z_ * scalar);
   }
-  Vec3 operator/(double scalar) const {
-    return Vec3(x_ / scalar, y_ / scalar, z_ / scalar);
+  BasicVec3 operator/(T scalar) const {
+    return BasicVec3(x_ / scalar, y_ / scalar, z_ / scalar);
   }
-  double dot(const Vec3 &other) const {
+  T dot(const BasicVec3 &other) const {
     return x_ * other.x_ + y_ * other.y_ + z_ * other.z_;
   }
-  Vec3 cross(const Vec3 &other) const {
-    return Vec3(y_ * other.z_ - z_ * other.y_, z_ * other.x_ - x_ * other.z_,
-                x_ * other.y_ - y_ * other.x_);
+  BasicVec3 cross(const BasicVec3 &other) const {
+    return BasicVec3(y_ * other.z_ - z_ * other.y_,
+                     z_ * other.x_ - x_ * other.z_,
+                     x_ * other.y_ - y_ * other.x_);
   }
 
-  double magnitude() const { return std::sqrt(x_ * x_ + y_ * y_ + z_ * z_); }
-  Vec3 normalize() const {
+  T magnitude() const { return Scalar::sqrt(dot(*this)); }
+  BasicVec3 normalize() const {
+    T m = magnitude();
+    return Scalar::select(m <= T(0.0), *this, *this / m);
+  }
+
+  template <class C>
+  static BasicVec3 select(const C &condition, const BasicVec3 &a,
+                          const BasicVec3 &b) {
+    return BasicVec3(Scalar::select(condition, a.x_, b.x_),
+                     Scalar::select(condition, a.y_, b.y_),
+                     Scalar::select(condition, a.z_, b.z_));
+  }
+};
+
+// Stored as four lanes (x, y, z, 0) so the arithmetic maps onto SIMD
+// registers; see simd.hpp for the backend selection. +, -, * and / build
+// expressions (vecexpr.hpp) that are evaluated when assigned to a Vec3.
+template <> class alignas(32) BasicVec3<double>
+    : public VecExpr<BasicVec3<double>> {
+private:
+  double v_[4];
+
+  explicit BasicVec3(const Double4 &lanes) { lanes.store(v_); }
+  Double4 lanes() const { return Double4::load(v_); }
+
+public:
+  using Operand = VecLeaf;
+
+  BasicVec3() : v_{0.0, 0.0, 0.0, 0.0} {}
+  BasicVec3(double x, double y, double z) : v_{x, y, z, 0.0} {}
+  template <class E> BasicVec3(const VecExpr<E> &e) {
+    e.self().packet().store(v_);
+  }
+
+  Double4 packet() const { return lanes(); }
+
+  double x() const { return v_[0]; }
+  double y() const { return v_[1]; }
+  double z() const { return v_[2]; }
+  double operator[](std::size_t i) const { return v_[i]; }
+
+  double dot(const BasicVec3 &other) const {
+    return (lanes() * other.lanes()).sum3();
+  }
+  BasicVec3 cross(const BasicVec3 &other) const {
+    Double4 a = lanes(), b = other.lanes();
+    return BasicVec3(a.yzx() * b.zxy() - a.zxy() * b.yzx());
+  }
+
+  double magnitude() const { return std::sqrt(dot(*this)); }
+  BasicVec3 normalize() const {
     double m = magnitude();
     if (m <= 0.0) {
       return *this;
@@ -42,3 +103,11 @@ public:
     return *this / m;
   }
 };
+
+using Vec3 = BasicVec3<double>;
+
+// Value part of a vector over Dual (or any scalar with value())
+template <class T> Vec3 valueOf(const BasicVec3<T> &v) {
+  return Vec3(Scalar::value(v.x()), Scalar::value(v.y()), Scalar::value(v.z()));
+}
+inline const Vec3 &valueOf(const Vec3 &v) { return v; }
@@ -0,0 +1,131 @@
+#pragma once
+#include "simd.hpp"
+#include <type_traits>
+
+// Expression templates for the lane-packed vector types. Arithmetic builds a
+// small tree of nodes and the whole tree is evaluated into registers when it
+// is assigned, so a line like p + (a + b * 2.0) * h has no intermediate
+// stores and a + b * s becomes a single fused multiply-add.
+//
+// A vector type takes part by deriving from VecExpr<Self>, providing
+// Double4 packet() and naming the node it is captured as when it appears in
+// an expression (using Operand = VecLeaf). Nodes hold their operands by
+// value, so an expression may safely outlive the vectors it was built from.
+template <class E> class VecExpr {
+public:
+  const E &self() const { return static_cast<const E &>(*this); }
+};
+
+// A vector operand, already loaded into registers
+class VecLeaf : public VecExpr<VecLeaf> {
+private:
+  Double4 lanes_;
+
+public:
+  using Operand = VecLeaf;
+
+  explicit VecLeaf(const Double4 &lanes) : lanes_(lanes) {}
+  template <class E>
+  VecLeaf(const VecExpr<E> &e) : lanes_(e.self().packet()) {}
+
+  Double4 packet() const { return lanes_; }
+};
+
+template <class E> class VecScale : public VecExpr<VecScale<E>> {
+private:
+  typename E::Operand e_;
+  double scalar_;
+
+public:
+  using Operand = VecScale;
+
+  VecScale(const E &e, double scalar) : e_(e), scalar_(scalar) {}
+
+  const typename E::Operand &vector() const { return e_; }
+  double scalar() const { return scalar_; }
+  Double4 packet() const {
+    return e_.packet() * Double4::broadcast(scalar_);
+  }
+};
+
+template <class E> class VecQuotient : public VecExpr<VecQuotient<E>> {
+private:
+  typename E::Operand e_;
+  double scalar_;
+
+public:
+  using Operand = VecQuotient;
+
+  VecQuotient(const E &e, double scalar) : e_(e), scalar_(scalar) {}
+
+  Double4 packet() const {
+    return e_.packet() / Double4::broadcast(scalar_);
+  }
+};
+
+template <class E> struct IsVecScale : std::false_type {};
+template <class E> struct IsVecScale<VecScale<E>> : std::true_type {};
+
+template <class A, class B> class VecSum : public VecExpr<VecSum<A, B>> {
+private:
+  typename A::Operand a_;
+  typename B::Operand b_;
+
+public:
+  using Operand = VecSum;
+
+  VecSum(const A &a, const B &b) : a_(a), b_(b) {}
+
+  // A scaled term on either side folds into the addition
+  Double4 packet() const {
+    if constexpr (IsVecScale<typename B::Operand>::value) {
+      return Double4::fma(b_.vector().packet(),
+                          Double4::broadcast(b_.scalar()), a_.packet());
+    } else if constexpr (IsVecScale<typename A::Operand>::value) {
+      return Double4::fma(a_.vector().packet(),
+                          Double4::broadcast(a_.scalar()), b_.packet());
+    } else {
+      return a_.packet() + b_.packet();
+    }
+  }
+};
+
+template <class A, class B>
+class VecDifference : public VecExpr<VecDifference<A, B>> {
+private:
+  typename A::Operand a_;
+  typename B::Operand b_;
+
+public:
+  using Operand = VecDifference;
+
+  VecDifference(const A &a, const B &b) : a_(a), b_(b) {}
+
+  Double4 packet() const {
+    if constexpr (IsVecScale<typename B::Operand>::value) {
+      return Double4::fnma(b_.vector().packet(),
+                           Double4::broadcast(b_.scalar()), a_.packet());
+    } else {
+      return a_.packet() - b_.packet();
+    }
+  }
+};
+
+template <class A, class B>
+VecSum<A, B> operator+(const VecExpr<A> &a, const VecExpr<B> &b) {
+  return VecSum<A, B>(a.self(), b.self());
+}
+
+template <class A, class B>
+VecDifference<A, B> operator-(const VecExpr<A> &a, const VecExpr<B> &b) {
+  return VecDifference<A, B>(a.self(), b.self());
+}
+
+template <class E> VecScale<E> operator*(const VecExpr<E> &e, double scalar) {
+  return VecScale<E>(e.self(), scalar);
+}
+
+template <class E>
+VecQuotient<E> operator/(const VecExpr<E> &e, double scalar) {
+  return VecQuotient<E>(e.self(), scalar);
+}
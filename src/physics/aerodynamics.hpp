@@ -1,56 +1,99 @@
 #pragma once
+#include "../math/mathpolicy.hpp"
+#include "../math/scalar.hpp"
 #include "aeroconstants.hpp"
 #include "atmosphere.hpp"
+#include "fidelity.hpp"
 #include "rocketbody.hpp"
 #include "state.hpp"
 #include <cmath>
 
 class Aerodynamics {
+private:
+  // Only a plain double run has one set of coefficients to keep on the body
+  static void recordCoefficients(RocketBody &rocket, double machNumber,
+                                 double angleOfAttack) {
+    rocket.updateAeroCoefficients(machNumber, angleOfAttack);
+  }
+  template <class T>
+  static void recordCoefficients(RocketBody &, const T &, const T &) {}
+
 public:
-  static Vec3 calculateForces(const State &state, RocketBody &rocket,
-                              const Vec3 &windVelocity = Vec3()) {
-    Vec3 relativeVelocity = state.velocity - windVelocity;
-    double velocityMagnitude = relativeVelocity.magnitude();
+  // Math picks the exp/sqrt/acos implementations (see mathpolicy.hpp)
+  template <class Math = ExactMath, class T>
+  static BasicVec3<T>
+  calculateForces(const BasicState<T> &state, RocketBody &rocket,
+                  const BasicVec3<T> &windVelocity = BasicVec3<T>()) {
+    BasicVec3<T> airloads =
+        calculateAirloads<Math>(state, rocket, windVelocity);
+
+    // Adding coriolis force vector
+    BasicVec3<T> coriolisForce =
+        calculateCoriolisForce(state, T(rocket.getMass()));
 
-    if (velocityMagnitude < 1e-6)
-      return Vec3();
+    return airloads + coriolisForce;
+  }
+  // Drag and lift only; Fidelity supplies the atmosphere and drag model
+  template <class Math = ExactMath, class Fidelity = StandardFidelity, class T>
+  static BasicVec3<T>
+  calculateAirloads(const BasicState<T> &state, RocketBody &rocket,
+                    const BasicVec3<T> &windVelocity = BasicVec3<T>(),
+                    const T &dragScale = T(1.0)) {
+    BasicVec3<T> relativeVelocity = state.velocity - windVelocity;
+    T velocityMagnitude = relativeVelocity.magnitude();
 
-    double altitude = state.position.magnitude() - Constants::EARTH_RADIUS;
-    double airDensity = Atmosphere::getDensity(altitude);
-    double temperature = Atmosphere::getTemperature(altitude);
+    auto moving = velocityMagnitude >= T(1e-6);
+    if (!Scalar::anyOf(moving))
+      return BasicVec3<T>();
 
-    double soundSpeed = std::sqrt(
-        AeroConstants::GAMMA * AeroConstants::AIR_GAS_CONSTANT * temperature);
-    double machNumber = velocityMagnitude / soundSpeed;
+    T altitude = state.position.magnitude() - Constants::EARTH_RADIUS;
+    T airDensity = Fidelity::template density<Math>(altitude);
+    T temperature = Fidelity::temperature(altitude);
 
-    Vec3 verticalAxis(0, 0, 1);
-    double angleOfAttack = std::acos(
-        std::abs(relativeVelocity.dot(verticalAxis)) / velocityMagnitude);
+    T soundSpeed = Math::sqrt(T(
+        AeroConstants::GAMMA * AeroConstants::AIR_GAS_CONSTANT * temperature));
+    T machNumber = velocityMagnitude / soundSpeed;
 
-    rocket.updateAeroCoefficients(machNumber, angleOfAttack);
+    BasicVec3<T> verticalAxis(0.0, 0.0, 1.0);
+    T angleOfAttack = Math::acos(
+        T(Scalar::abs(relativeVelocity.dot(verticalAxis)) / velocityMagnitude));
+
+    recordCoefficients(rocket, machNumber, angleOfAttack);
+    T dragCoefficient = Fidelity::dragCoefficient(machNumber);
+    T liftCoefficient = RocketBody::liftCoefficientAt(angleOfAttack);
 
-    double dynamicPressure =
+    T dynamicPressure =
         0.5 * airDensity * velocityMagnitude * velocityMagnitude;
 
-    Vec3 dragDirection = relativeVelocity.normalize() * -1.0;
-    Vec3 dragForce =
-        dragDirection * (dynamicPressure * rocket.getReferenceArea() *
-                         rocket.getDragCoefficient());
+    BasicVec3<T> dragDirection = relativeVelocity.normalize() * -1.0;
+    BasicVec3<T> dragForce =
+        dragDirection *
+        T(dynamicPressure * rocket.getReferenceArea() * dragCoefficient *
+          dragScale);
 
-    Vec3 liftDirection = relativeVelocity.cross(verticalAxis).normalize();
-    Vec3 liftForce =
-        liftDirection * (dynamicPressure * rocket.getReferenceArea() *
-                         rocket.getLiftCoefficient());
-    // Adding coriolis force vector
-    Vec3 angularVelocityVec(0,0,-Constants::EARTH_ANGULAR_VELOCITY);
-    Vec3 coriolisForce = angularVelocityVec.cross(state.velocity).operator*(-2.0 * rocket.getMass());
+    BasicVec3<T> liftDirection =
+        relativeVelocity.cross(verticalAxis).normalize();
+    BasicVec3<T> liftForce =
+        liftDirection *
+        T(dynamicPressure * rocket.getReferenceArea() * liftCoefficient);
 
-    return dragForce + liftForce + coriolisForce;
+    // Lanes that are at rest relative to the air carry no airload
+    return Scalar::select(moving, BasicVec3<T>(dragForce + liftForce),
+                          BasicVec3<T>());
+  }
+  // Coriolis term on its own, still needed where the air is too thin for aero
+  template <class T>
+  static BasicVec3<T> calculateCoriolisForce(const BasicState<T> &state,
+                                             const T &mass) {
+    BasicVec3<T> angularVelocityVec(0.0, 0.0,
+                                    -Constants::EARTH_ANGULAR_VELOCITY);
+    return angularVelocityVec.cross(state.velocity) * (-2.0 * mass);
   }
-  static double calculateDynamicPressure(const State &state) {
-    double altitude = state.position.magnitude() - Constants::EARTH_RADIUS;
-    double airDensity = Atmosphere::getDensity(altitude);
-    double velMagnitude = state.velocity.magnitude();
+  template <class Fidelity = StandardFidelity, class T>
+  static T calculateDynamicPressure(const BasicState<T> &state) {
+    T altitude = state.position.magnitude() - Constants::EARTH_RADIUS;
+    T airDensity = Fidelity::density(altitude);
+    T velMagnitude = state.velocity.magnitude();
     return 0.5 * airDensity * velMagnitude * velMagnitude;
   }
   static double calculateStagnationTemperature(const State &state,
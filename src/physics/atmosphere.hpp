@@ -1,19 +1,107 @@
 #pragma once
+#include "../math/mathpolicy.hpp"
+#include "../math/scalar.hpp"
 #include "constants.hpp"
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <vector>
 
 class Atmosphere {
 public:
-  static double getDensity(double altitude) {
+  // Math selects the exp implementation (see mathpolicy.hpp)
+  template <class Math = ExactMath, class T>
+  static T getDensity(const T &altitude) {
     const double scaleHeight = 7400.0;
-    return 1.225 * std::exp(-altitude / scaleHeight);
+    return 1.225 * Math::exp(T(-altitude / scaleHeight));
   }
-  static double getPressure(double altitude) {
+  template <class Math = ExactMath, class T>
+  static T getPressure(const T &altitude) {
     const double scaleHeight = 7400;
-    return Constants::SEA_LEVEL_PRESSURE * std::exp(-altitude / scaleHeight);
+    return Constants::SEA_LEVEL_PRESSURE *
+           Math::exp(T(-altitude / scaleHeight));
   }
-  static double getTemperature(double altitude) {
+  template <class T> static T getTemperature(const T &altitude) {
     const double lapseRate = -0.0065;
     return Constants::SEA_LEVEL_TEMPERATURE + lapseRate * altitude;
   }
 };
+
+// U.S. Standard Atmosphere 1976 to 86 km, isothermal above. The layers are
+// tabulated once on a uniform altitude grid; density and pressure are
+// interpolated in log space, so a lookup is an index, a lerp and one exp.
+// Outside the grid the log-linear trend is extrapolated.
+class StandardAtmosphere {
+public:
+  static constexpr double STEP = 250.0;   // Grid spacing (m)
+  static constexpr double TOP = 120000.0; // Highest grid altitude (m)
+
+private:
+  std::vector<double> logDensity_;
+  std::vector<double> logPressure_;
+  std::vector<double> temperature_;
+
+  StandardAtmosphere() {
+    // Base geopotential altitude (m) and lapse rate (K/m) of each layer
+    const double BASE[] = {0, 11000, 20000, 32000, 47000, 51000, 71000, 84852};
+    const double LAPSE[] = {-0.0065, 0, 0.001, 0.0028, 0, -0.0028, -0.002, 0};
+    const std::size_t LAYERS = sizeof(BASE) / sizeof(BASE[0]);
+    const double g0 = 9.80665, r0 = 6356766.0; // US76 reference values
+    const double R = Constants::AIR_GAS_CONSTANT;
+
+    double baseTemperature[LAYERS], basePressure[LAYERS];
+    baseTemperature[0] = Constants::SEA_LEVEL_TEMPERATURE;
+    basePressure[0] = Constants::SEA_LEVEL_PRESSURE;
+    auto layerState = [&](std::size_t b, double h, double &t, double &p) {
+      double dh = h - BASE[b];
+      t = baseTemperature[b] + LAPSE[b] * dh;
+      p = LAPSE[b] == 0.0
+              ? basePressure[b] * std::exp(-g0 * dh / (R * t))
+              : basePressure[b] *
+                    std::pow(baseTemperature[b] / t, g0 / (R * LAPSE[b]));
+    };
+    for (std::size_t b = 1; b < LAYERS; ++b)
+      layerState(b - 1, BASE[b], baseTemperature[b], basePressure[b]);
+
+    std::size_t n = static_cast<std::size_t>(TOP / STEP) + 1;
+    for (std::size_t i = 0; i < n; ++i) {
+      double z = i * STEP;
+      double h = r0 * z / (r0 + z); // Geopotential altitude
+      std::size_t b = LAYERS - 1;
+      while (b > 0 && h < BASE[b])
+        --b;
+      double t, p;
+      layerState(b, h, t, p);
+      temperature_.push_back(t);
+      logPressure_.push_back(std::log(p));
+      logDensity_.push_back(std::log(p / (R * t)));
+    }
+  }
+
+  template <class T>
+  T interpolate(const std::vector<double> &column, const T &altitude) const {
+    double x = std::floor(Scalar::value(altitude) / STEP);
+    std::size_t i = static_cast<std::size_t>(
+        std::clamp(x, 0.0, static_cast<double>(column.size() - 2)));
+    T t = altitude / STEP - static_cast<double>(i);
+    return column[i] + t * (column[i + 1] - column[i]);
+  }
+
+public:
+  static const StandardAtmosphere &instance() {
+    static const StandardAtmosphere atmosphere;
+    return atmosphere;
+  }
+
+  template <class Math = ExactMath, class T>
+  T getDensity(const T &altitude) const {
+    return Math::exp(interpolate(logDensity_, altitude));
+  }
+  template <class Math = ExactMath, class T>
+  T getPressure(const T &altitude) const {
+    return Math::exp(interpolate(logPressure_, altitude));
+  }
+  template <class T> T getTemperature(const T &altitude) const {
+    return interpolate(temperature_, altitude);
+  }
+};
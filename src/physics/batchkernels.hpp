@@ -0,0 +1,347 @@
+#pragma once
+#include "../math/cpufeatures.hpp"
+#include "constants.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+// Batched kernels over structure-of-arrays data (Vec3Array geometry,
+// telemetry encoding). One binary carries a copy of every kernel per
+// instruction set and BatchKernels picks the best one the CPU supports when
+// first used, so nothing has to be built with -march=native.
+//
+// Each ISA supplies a Pack type with the same interface; batchkernels.inl is
+// then included into that ISA's namespace under a target pragma. The AVX
+// variants need GCC on x86, elsewhere the baseline set is built.
+#if defined(__GNUC__) && !defined(__clang__) &&                               \
+    (defined(__x86_64__) || defined(__i386__))
+#define NOVA_BATCH_MULTITARGET 1
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Fixed-width bit packing (compressed telemetry). A block holds BLOCK
+// values of width bits each, value j at bit j * width of width little-endian
+// 64-bit words, so a block is exactly width words long.
+namespace BatchBits {
+constexpr std::size_t BLOCK = 64;
+
+inline std::uint64_t widthMask(unsigned width) {
+  return width >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << width) - 1;
+}
+
+inline void unpack(const std::uint64_t *words, unsigned width,
+                   std::uint64_t *out) {
+  if (width == 0) {
+    std::fill(out, out + BLOCK, std::uint64_t(0));
+    return;
+  }
+  std::uint64_t mask = widthMask(width);
+  for (std::size_t j = 0; j < BLOCK; ++j) {
+    std::size_t bit = j * width, k = bit >> 6;
+    unsigned shift = bit & 63;
+    std::uint64_t v = words[k] >> shift;
+    if (shift + width > 64)
+      v |= words[k + 1] << (64 - shift);
+    out[j] = v & mask;
+  }
+}
+} // namespace BatchBits
+
+namespace BatchScalar {
+struct Pack {
+  static constexpr std::size_t WIDTH = 1;
+  using Mask = bool;
+  double v;
+
+  static Pack load(const double *p) { return {*p}; }
+  void store(double *p) const { *p = v; }
+  static Pack broadcast(double s) { return {s}; }
+  static Pack gather(const double *base, std::size_t) { return {*base}; }
+
+  Pack operator+(Pack b) const { return {v + b.v}; }
+  Pack operator-(Pack b) const { return {v - b.v}; }
+  Pack operator*(Pack b) const { return {v * b.v}; }
+  Pack operator/(Pack b) const { return {v / b.v}; }
+  static Pack fma(Pack a, Pack b, Pack c) { return {a.v * b.v + c.v}; }
+  static Pack sqrt(Pack a) { return {std::sqrt(a.v)}; }
+  static Pack abs(Pack a) { return {std::abs(a.v)}; }
+  static Pack min(Pack a, Pack b) { return {a.v < b.v ? a.v : b.v}; }
+  static Pack max(Pack a, Pack b) { return {a.v > b.v ? a.v : b.v}; }
+  static Mask less(Pack a, Pack b) { return a.v < b.v; }
+  static Pack select(Mask m, Pack a, Pack b) { return m ? a : b; }
+
+};
+#include "batchkernels.inl"
+inline void unpackBits(const std::uint64_t *words, unsigned width,
+                       std::uint64_t *out) {
+  BatchBits::unpack(words, width, out);
+}
+} // namespace BatchScalar
+
+#if defined(NOVA_BATCH_MULTITARGET) || defined(__SSE2__)
+#if defined(NOVA_BATCH_MULTITARGET)
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif
+namespace BatchSse2 {
+struct Pack {
+  static constexpr std::size_t WIDTH = 2;
+  using Mask = __m128d;
+  __m128d v;
+
+  static Pack load(const double *p) { return {_mm_loadu_pd(p)}; }
+  void store(double *p) const { _mm_storeu_pd(p, v); }
+  static Pack broadcast(double s) { return {_mm_set1_pd(s)}; }
+  static Pack gather(const double *base, std::size_t stride) {
+    return {_mm_set_pd(base[stride], base[0])};
+  }
+
+  Pack operator+(Pack b) const { return {_mm_add_pd(v, b.v)}; }
+  Pack operator-(Pack b) const { return {_mm_sub_pd(v, b.v)}; }
+  Pack operator*(Pack b) const { return {_mm_mul_pd(v, b.v)}; }
+  Pack operator/(Pack b) const { return {_mm_div_pd(v, b.v)}; }
+  static Pack fma(Pack a, Pack b, Pack c) { return a * b + c; }
+  static Pack sqrt(Pack a) { return {_mm_sqrt_pd(a.v)}; }
+  static Pack abs(Pack a) {
+    return {_mm_andnot_pd(_mm_set1_pd(-0.0), a.v)};
+  }
+  static Pack min(Pack a, Pack b) { return {_mm_min_pd(a.v, b.v)}; }
+  static Pack max(Pack a, Pack b) { return {_mm_max_pd(a.v, b.v)}; }
+  static Mask less(Pack a, Pack b) { return _mm_cmplt_pd(a.v, b.v); }
+  static Pack select(Mask m, Pack a, Pack b) {
+    return {_mm_or_pd(_mm_and_pd(m, a.v), _mm_andnot_pd(m, b.v))};
+  }
+
+};
+#include "batchkernels.inl"
+// SSE2 has no per-lane 64-bit shifts or gathers
+inline void unpackBits(const std::uint64_t *words, unsigned width,
+                       std::uint64_t *out) {
+  BatchBits::unpack(words, width, out);
+}
+} // namespace BatchSse2
+#if defined(NOVA_BATCH_MULTITARGET)
+#pragma GCC pop_options
+#endif
+#endif
+
+#if defined(NOVA_BATCH_MULTITARGET)
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+namespace BatchAvx2 {
+struct Pack {
+  static constexpr std::size_t WIDTH = 4;
+  using Mask = __m256d;
+  __m256d v;
+
+  static Pack load(const double *p) { return {_mm256_loadu_pd(p)}; }
+  void store(double *p) const { _mm256_storeu_pd(p, v); }
+  static Pack broadcast(double s) { return {_mm256_set1_pd(s)}; }
+  static Pack gather(const double *base, std::size_t stride) {
+    long long s = static_cast<long long>(stride);
+    return {_mm256_i64gather_pd(base, _mm256_set_epi64x(3 * s, 2 * s, s, 0),
+                                8)};
+  }
+
+  Pack operator+(Pack b) const { return {_mm256_add_pd(v, b.v)}; }
+  Pack operator-(Pack b) const { return {_mm256_sub_pd(v, b.v)}; }
+  Pack operator*(Pack b) const { return {_mm256_mul_pd(v, b.v)}; }
+  Pack operator/(Pack b) const { return {_mm256_div_pd(v, b.v)}; }
+  static Pack fma(Pack a, Pack b, Pack c) {
+    return {_mm256_fmadd_pd(a.v, b.v, c.v)};
+  }
+  static Pack sqrt(Pack a) { return {_mm256_sqrt_pd(a.v)}; }
+  static Pack abs(Pack a) {
+    return {_mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v)};
+  }
+  static Pack min(Pack a, Pack b) { return {_mm256_min_pd(a.v, b.v)}; }
+  static Pack max(Pack a, Pack b) { return {_mm256_max_pd(a.v, b.v)}; }
+  static Mask less(Pack a, Pack b) {
+    return _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ);
+  }
+  static Pack select(Mask m, Pack a, Pack b) {
+    return {_mm256_blendv_pd(b.v, a.v, m)};
+  }
+
+};
+#include "batchkernels.inl"
+// Four values at a time: gather the word each starts in (and the next one
+// where it straddles a boundary), then shift every lane by its own offset
+inline void unpackBits(const std::uint64_t *words, unsigned width,
+                       std::uint64_t *out) {
+  if (width == 0) {
+    std::fill(out, out + BatchBits::BLOCK, std::uint64_t(0));
+    return;
+  }
+  const long long *base = reinterpret_cast<const long long *>(words);
+  const __m256i W = _mm256_set1_epi64x(width);
+  const __m256i MASK = _mm256_set1_epi64x(
+      static_cast<long long>(BatchBits::widthMask(width)));
+  const __m256i SIXTY_THREE = _mm256_set1_epi64x(63);
+  const __m256i SIXTY_FOUR = _mm256_set1_epi64x(64);
+  __m256i bit = _mm256_mul_epu32(_mm256_set_epi64x(3, 2, 1, 0), W);
+  const __m256i STEP = _mm256_set1_epi64x(4 * width);
+  for (std::size_t j = 0; j < BatchBits::BLOCK; j += 4) {
+    __m256i k = _mm256_srli_epi64(bit, 6);
+    __m256i shift = _mm256_and_si256(bit, SIXTY_THREE);
+    __m256i lo = _mm256_i64gather_epi64(base, k, 8);
+    __m256i straddles =
+        _mm256_cmpgt_epi64(_mm256_add_epi64(shift, W), SIXTY_FOUR);
+    __m256i next = _mm256_add_epi64(k, _mm256_set1_epi64x(1));
+    __m256i hi = _mm256_mask_i64gather_epi64(_mm256_setzero_si256(), base,
+                                             next, straddles, 8);
+    // A count of 64 shifts in zeros, which covers shift == 0
+    __m256i v = _mm256_or_si256(
+        _mm256_srlv_epi64(lo, shift),
+        _mm256_sllv_epi64(hi, _mm256_sub_epi64(SIXTY_FOUR, shift)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + j),
+                        _mm256_and_si256(v, MASK));
+    bit = _mm256_add_epi64(bit, STEP);
+  }
+}
+} // namespace BatchAvx2
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx2,fma")
+// GCC 12's avx512fintrin.h trips this on its own _mm512_undefined_pd()
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+namespace BatchAvx512 {
+struct Pack {
+  static constexpr std::size_t WIDTH = 8;
+  using Mask = __mmask8;
+  __m512d v;
+
+  static Pack load(const double *p) { return {_mm512_loadu_pd(p)}; }
+  void store(double *p) const { _mm512_storeu_pd(p, v); }
+  static Pack broadcast(double s) { return {_mm512_set1_pd(s)}; }
+  static Pack gather(const double *base, std::size_t stride) {
+    long long s = static_cast<long long>(stride);
+    __m512i index =
+        _mm512_set_epi64(7 * s, 6 * s, 5 * s, 4 * s, 3 * s, 2 * s, s, 0);
+    return {_mm512_i64gather_pd(index, base, 8)};
+  }
+
+  Pack operator+(Pack b) const { return {_mm512_add_pd(v, b.v)}; }
+  Pack operator-(Pack b) const { return {_mm512_sub_pd(v, b.v)}; }
+  Pack operator*(Pack b) const { return {_mm512_mul_pd(v, b.v)}; }
+  Pack operator/(Pack b) const { return {_mm512_div_pd(v, b.v)}; }
+  static Pack fma(Pack a, Pack b, Pack c) {
+    return {_mm512_fmadd_pd(a.v, b.v, c.v)};
+  }
+  static Pack sqrt(Pack a) { return {_mm512_sqrt_pd(a.v)}; }
+  static Pack abs(Pack a) { return {_mm512_abs_pd(a.v)}; }
+  static Pack min(Pack a, Pack b) { return {_mm512_min_pd(a.v, b.v)}; }
+  static Pack max(Pack a, Pack b) { return {_mm512_max_pd(a.v, b.v)}; }
+  static Mask less(Pack a, Pack b) {
+    return _mm512_cmp_pd_mask(a.v, b.v, _CMP_LT_OQ);
+  }
+  static Pack select(Mask m, Pack a, Pack b) {
+    return {_mm512_mask_blend_pd(m, b.v, a.v)};
+  }
+
+};
+#include "batchkernels.inl"
+// As the AVX2 version, eight values at a time
+inline void unpackBits(const std::uint64_t *words, unsigned width,
+                       std::uint64_t *out) {
+  if (width == 0) {
+    std::fill(out, out + BatchBits::BLOCK, std::uint64_t(0));
+    return;
+  }
+  const __m512i W = _mm512_set1_epi64(width);
+  const __m512i MASK =
+      _mm512_set1_epi64(static_cast<long long>(BatchBits::widthMask(width)));
+  const __m512i SIXTY_FOUR = _mm512_set1_epi64(64);
+  __m512i bit = _mm512_mul_epu32(_mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0), W);
+  const __m512i STEP = _mm512_set1_epi64(8 * width);
+  for (std::size_t j = 0; j < BatchBits::BLOCK; j += 8) {
+    __m512i k = _mm512_srli_epi64(bit, 6);
+    __m512i shift = _mm512_and_si512(bit, _mm512_set1_epi64(63));
+    __m512i lo = _mm512_i64gather_epi64(k, words, 8);
+    __mmask8 straddles = _mm512_cmpgt_epi64_mask(
+        _mm512_add_epi64(shift, W), SIXTY_FOUR);
+    __m512i hi = _mm512_mask_i64gather_epi64(
+        _mm512_setzero_si512(), straddles,
+        _mm512_add_epi64(k, _mm512_set1_epi64(1)), words, 8);
+    __m512i v = _mm512_or_si512(
+        _mm512_srlv_epi64(lo, shift),
+        _mm512_sllv_epi64(hi, _mm512_sub_epi64(SIXTY_FOUR, shift)));
+    _mm512_storeu_si512(out + j, _mm512_and_si512(v, MASK));
+    bit = _mm512_add_epi64(bit, STEP);
+  }
+}
+} // namespace BatchAvx512
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+#endif
+
+// The kernel set for one instruction-set level
+struct BatchKernels {
+  SimdPath path;
+  // Row-major records to per-column arrays
+  void (*transpose)(const double *rows, std::size_t rowCount,
+                    std::size_t columnCount, double *const *columns);
+  // Vector geometry over x, y, z columns (see Vec3Array)
+  void (*magnitude)(const double *x, const double *y, const double *z,
+                    double *out, std::size_t n);
+  void (*altitude)(const double *x, const double *y, const double *z,
+                   double *out, std::size_t n);
+  void (*normalize)(const double *x, const double *y, const double *z,
+                    double *ox, double *oy, double *oz, std::size_t n);
+  void (*dot)(const double *ax, const double *ay, const double *az,
+              const double *bx, const double *by, const double *bz,
+              double *out, std::size_t n);
+  void (*cross)(const double *ax, const double *ay, const double *az,
+                const double *bx, const double *by, const double *bz,
+                double *ox, double *oy, double *oz, std::size_t n);
+  // One BatchBits block of BLOCK width-bit values to out
+  void (*unpackBits)(const std::uint64_t *words, unsigned width,
+                     std::uint64_t *out);
+
+  // Throws if the level was not built in or the CPU lacks it
+  static BatchKernels forPath(SimdPath path) {
+    if (path > detectSimdPath())
+      throw std::runtime_error(std::string("CPU does not support ") +
+                               simdPathName(path) + " kernels");
+// Every kernel of one ISA namespace, in member order
+#define NOVA_BATCH_KERNELS(isa)                                               \
+  {path,           isa::transpose, isa::magnitude, isa::altitude,             \
+   isa::normalize, isa::dot,       isa::cross,     isa::unpackBits}
+    switch (path) {
+#if defined(NOVA_BATCH_MULTITARGET)
+    case SimdPath::Avx512:
+      return NOVA_BATCH_KERNELS(BatchAvx512);
+    case SimdPath::Avx2:
+      return NOVA_BATCH_KERNELS(BatchAvx2);
+#endif
+#if defined(NOVA_BATCH_MULTITARGET) || defined(__SSE2__)
+    case SimdPath::Sse2:
+      return NOVA_BATCH_KERNELS(BatchSse2);
+#endif
+    case SimdPath::Scalar:
+      return NOVA_BATCH_KERNELS(BatchScalar);
+    default:
+      throw std::runtime_error(std::string(simdPathName(path)) +
+                               " kernels are not built into this binary");
+    }
+#undef NOVA_BATCH_KERNELS
+  }
+
+  // Kernels in use; the best supported level unless select() overrode it
+  static const BatchKernels &active() { return current(); }
+  static void select(SimdPath path) { current() = forPath(path); }
+
+private:
+  static BatchKernels &current() {
+    static BatchKernels kernels = forPath(detectSimdPath());
+    return kernels;
+  }
+};
@@ -0,0 +1,116 @@
+// Kernel bodies shared by every instruction set. batchkernels.hpp includes
+// this file once per target, inside a namespace that defines Pack and under
+// the matching target pragma, so each copy is compiled for its own ISA.
+// Arrays are structure-of-arrays and need no particular alignment.
+
+inline Pack loadAt(const double *p, std::size_t i, std::size_t count) {
+  if (count == Pack::WIDTH)
+    return Pack::load(p + i);
+  double lanes[Pack::WIDTH] = {};
+  for (std::size_t l = 0; l < count; ++l)
+    lanes[l] = p[i + l];
+  return Pack::load(lanes);
+}
+
+inline void storeAt(double *p, std::size_t i, std::size_t count,
+                    const Pack &v) {
+  if (count == Pack::WIDTH) {
+    v.store(p + i);
+    return;
+  }
+  double lanes[Pack::WIDTH];
+  v.store(lanes);
+  for (std::size_t l = 0; l < count; ++l)
+    p[i + l] = lanes[l];
+}
+
+// Geometry over Vec3Array columns. Sums of squares use fused multiply-adds,
+// so results can differ from the Vec3 methods in the last bit.
+
+inline Pack squaredNorm(Pack x, Pack y, Pack z) {
+  return Pack::fma(x, x, Pack::fma(y, y, z * z));
+}
+
+inline void magnitude(const double *x, const double *y, const double *z,
+                      double *out, std::size_t n) {
+  for (std::size_t i = 0; i < n; i += Pack::WIDTH) {
+    std::size_t count = std::min(Pack::WIDTH, n - i);
+    storeAt(out, i, count,
+            Pack::sqrt(squaredNorm(loadAt(x, i, count), loadAt(y, i, count),
+                                   loadAt(z, i, count))));
+  }
+}
+
+// Distance above the spherical Earth for each position
+inline void altitude(const double *x, const double *y, const double *z,
+                     double *out, std::size_t n) {
+  const Pack RADIUS = Pack::broadcast(Constants::EARTH_RADIUS);
+  for (std::size_t i = 0; i < n; i += Pack::WIDTH) {
+    std::size_t count = std::min(Pack::WIDTH, n - i);
+    Pack r = Pack::sqrt(squaredNorm(loadAt(x, i, count), loadAt(y, i, count),
+                                    loadAt(z, i, count)));
+    storeAt(out, i, count, r - RADIUS);
+  }
+}
+
+// Unit vectors; zero vectors are left as they are, like Vec3::normalize.
+// One division per vector, then three multiplies.
+inline void normalize(const double *x, const double *y, const double *z,
+                      double *ox, double *oy, double *oz, std::size_t n) {
+  const Pack ZERO = Pack::broadcast(0.0);
+  const Pack ONE = Pack::broadcast(1.0);
+  for (std::size_t i = 0; i < n; i += Pack::WIDTH) {
+    std::size_t count = std::min(Pack::WIDTH, n - i);
+    Pack px = loadAt(x, i, count), py = loadAt(y, i, count),
+         pz = loadAt(z, i, count);
+    Pack m = Pack::sqrt(squaredNorm(px, py, pz));
+    Pack inverse = Pack::select(Pack::less(ZERO, m), ONE / m, ONE);
+    storeAt(ox, i, count, px * inverse);
+    storeAt(oy, i, count, py * inverse);
+    storeAt(oz, i, count, pz * inverse);
+  }
+}
+
+inline void dot(const double *ax, const double *ay, const double *az,
+                const double *bx, const double *by, const double *bz,
+                double *out, std::size_t n) {
+  for (std::size_t i = 0; i < n; i += Pack::WIDTH) {
+    std::size_t count = std::min(Pack::WIDTH, n - i);
+    storeAt(out, i, count,
+            Pack::fma(loadAt(ax, i, count), loadAt(bx, i, count),
+                      Pack::fma(loadAt(ay, i, count), loadAt(by, i, count),
+                                loadAt(az, i, count) * loadAt(bz, i, count))));
+  }
+}
+
+// The output may alias either input
+inline void cross(const double *ax, const double *ay, const double *az,
+                  const double *bx, const double *by, const double *bz,
+                  double *ox, double *oy, double *oz, std::size_t n) {
+  for (std::size_t i = 0; i < n; i += Pack::WIDTH) {
+    std::size_t count = std::min(Pack::WIDTH, n - i);
+    Pack px = loadAt(ax, i, count), py = loadAt(ay, i, count),
+         pz = loadAt(az, i, count);
+    Pack qx = loadAt(bx, i, count), qy = loadAt(by, i, count),
+         qz = loadAt(bz, i, count);
+    storeAt(ox, i, count, py * qz - pz * qy);
+    storeAt(oy, i, count, pz * qx - px * qz);
+    storeAt(oz, i, count, px * qy - py * qx);
+  }
+}
+
+// Row-major records (rowCount x columnCount) to one array per column, the
+// layout the telemetry writers encode
+inline void transpose(const double *rows, std::size_t rowCount,
+                      std::size_t columnCount, double *const *columns) {
+  std::size_t full = rowCount - rowCount % Pack::WIDTH;
+  for (std::size_t r = 0; r < full; r += Pack::WIDTH) {
+    for (std::size_t c = 0; c < columnCount; ++c)
+      Pack::gather(rows + r * columnCount + c, columnCount)
+          .store(columns[c] + r);
+  }
+  for (std::size_t r = full; r < rowCount; ++r) {
+    for (std::size_t c = 0; c < columnCount; ++c)
+      columns[c][r] = rows[r * columnCount + c];
+  }
+}
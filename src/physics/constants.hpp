@@ -7,6 +7,11 @@ constexpr double EARTH_RADIUS = 6371000.0;
 constexpr double SEA_LEVEL_PRESSURE = 101325.0;
 constexpr double SEA_LEVEL_TEMPERATURE = 288.15;
 constexpr double AIR_GAS_CONSTANT = 287.05;
+// Gravity used to convert specific impulse to exhaust velocity
+constexpr double STANDARD_GRAVITY = 9.81;
 // Earth angular velocity
 constexpr double EARTH_ANGULAR_VELOCITY = 7.9e-5;
+// Oblateness (second zonal harmonic) and the radius it is referred to
+constexpr double EARTH_J2 = 1.08263e-3;
+constexpr double EARTH_EQUATORIAL_RADIUS = 6378137.0;
 } // namespace Constants
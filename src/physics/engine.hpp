@@ -1,48 +1,69 @@
 #pragma once
+#include "../math/table1d.hpp"
 #include "../math/vec3.hpp"
+#include "constants.hpp"
+#include "nozzle.hpp"
+#include "thrustcurve.hpp"
 #include <cmath>
+#include <memory>
+#include <utility>
 
+// Thrust relative to the sea-level rating for engines without a nozzle
+// model: grows linearly to 1.3x the rating in vacuum
+inline double linearThrustFactor(double atmosphericPressure) {
+  double pressureRatio = atmosphericPressure / Constants::SEA_LEVEL_PRESSURE;
+  return 1.0 + (1.0 - pressureRatio) * 0.3;
+}
+
+// Definition of a single engine. Run-time state (lit, throttle, gimbal) lives
+// in the EngineCluster that the engine is added to.
 class Engine {
 private:
   double maxThrust_;
   double specificImpulse_;
-  double throatArea_;
-  double expansionRatio_;
   double massFlowRate_;
-  double currentThrottle_;
-  bool isActive_;
+  Vec3 mountPosition_; // Nozzle position in the body frame (m)
+  std::shared_ptr<const NozzlePerformance> nozzle_; // Optional, from load
+  std::shared_ptr<const ThrustCurve> thrustCurve_; // Optional, replaces rating
+  std::shared_ptr<const Table1D> ispTable_;        // Optional Isp (s) vs Pa
 
 public:
-  Engine(double maxThrust, double isp, double throatArea, double expansionRatio)
-      : maxThrust_(maxThrust), specificImpulse_(isp), throatArea_(throatArea),
-        expansionRatio_(expansionRatio),
-        massFlowRate_(maxThrust / (specificImpulse_ * 9.81)),
-        currentThrottle_(0.0), isActive_(false) {}
-
-  void start() { isActive_ = true; }
-  void shutdown() {
-    isActive_ = false;
-    currentThrottle_ = 0.0;
+  // maxThrust and isp are sea-level ratings, scaled with ambient pressure by
+  // linearThrustFactor
+  Engine(double maxThrust, double isp, const Vec3 &mountPosition = Vec3())
+      : maxThrust_(maxThrust), specificImpulse_(isp),
+        massFlowRate_(maxThrust /
+                      (specificImpulse_ * Constants::STANDARD_GRAVITY)),
+        mountPosition_(mountPosition) {}
+  // As above, with the nozzle geometry setting how the ratings change with
+  // ambient pressure
+  Engine(double maxThrust, double isp, const Nozzle &nozzle,
+         const Vec3 &mountPosition = Vec3())
+      : Engine(maxThrust, isp, mountPosition) {
+    nozzle_ = std::make_shared<const NozzlePerformance>(nozzle, maxThrust, isp);
   }
 
-  void setThrottle(double throttle) {
-    currentThrottle_ = std::clamp(throttle, 0.0, 1.0);
+  double getMaxThrust() const { return maxThrust_; }
+  double getSpecificImpulse() const { return specificImpulse_; }
+  double getMassFlowRate() const { return massFlowRate_; }
+  const Vec3 &getMountPosition() const { return mountPosition_; }
+  // Null for engines without a nozzle model
+  const std::shared_ptr<const NozzlePerformance> &getNozzlePerformance() const {
+    return nozzle_;
   }
-  double getCurrentThrust(double atmosphericPressure) const {
-    if (!isActive_)
-      return 0.0;
-
-    double pressureRatio = atmosphericPressure / Constants::SEA_LEVEL_PRESSURE;
-    double altitudeCompensation = 1.0 + (1.0 - pressureRatio) * 0.3;
 
-    return maxThrust_ * currentThrottle_ * altitudeCompensation;
+  // Thrust and propellant flow follow the curve instead of the rating
+  void setThrustCurve(std::shared_ptr<const ThrustCurve> curve) {
+    thrustCurve_ = std::move(curve);
   }
-  double getFuelConsumption(double dt) const {
-    if (isActive_ == false)
-      return 0.0;
-    return massFlowRate_ * currentThrottle_ * dt;
+  // Thrust becomes mass flow * g0 * Isp(ambient pressure)
+  void setIspTable(std::shared_ptr<const Table1D> table) {
+    ispTable_ = std::move(table);
+  }
+  const std::shared_ptr<const ThrustCurve> &getThrustCurve() const {
+    return thrustCurve_;
+  }
+  const std::shared_ptr<const Table1D> &getIspTable() const {
+    return ispTable_;
   }
-
-  bool isActive() const { return isActive_; }
-  double getThrottle() const { return currentThrottle_; }
 };
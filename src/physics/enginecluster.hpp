@@ -0,0 +1,274 @@
+#pragma once
+#include "../math/mat3.hpp"
+#include "../math/table1d.hpp"
+#include "../math/vec3.hpp"
+#include "constants.hpp"
+#include "engine.hpp"
+#include "nozzle.hpp"
+#include "thrustcurve.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// Cluster totals from one pass over all engines
+struct ClusterOutput {
+  Vec3 thrust;     // World frame (N)
+  Vec3 torque;     // Body frame, about the body origin (N·m)
+  double massFlow; // Propellant flow (kg/s)
+};
+
+// Engines stored structure-of-arrays, one contiguous array per field, so the
+// cluster totals come out of a single sweep the compiler can vectorize.
+// Arrays are padded to a multiple of LANES with zero-thrust slots.
+//
+// Gimbal rotations are cached per engine together with the torque arm
+// p × (R·ez), and only rebuilt when the gimbal angles change.
+//
+// Rated engines scale with their precomputed nozzle table, if they have one. Engines with
+// thrust curves or Isp tables get a short scalar pre-pass that fills their
+// lane of tableThrust_; the main sweep blends it in by mask.
+class EngineCluster {
+public:
+  static constexpr std::size_t LANES = 4;
+  static_assert(LANES == 4, "Lane reductions below are written for 4 lanes");
+
+private:
+  // Engine driven by tables; cursors make the time and pressure lookups O(1)
+  struct TabulatedEngine {
+    std::size_t lane;
+    std::shared_ptr<const ThrustCurve> curve;
+    std::shared_ptr<const Table1D> isp;
+    double burnTime;                // Seconds lit, advances with the step
+    std::size_t curveCursor;        // Only moves forward with burnTime
+    mutable std::size_t ispCursor;  // Follows the ambient pressure
+    double curveThrust;             // Curve thrust over the next step (N)
+  };
+
+  std::size_t count_;
+  // Definition
+  std::vector<double> maxThrust_; // N
+  std::vector<double> flowRate_;  // Current flow at full throttle (kg/s)
+  std::vector<double> posX_, posY_, posZ_;
+  std::vector<double> tabulated_; // 1 when thrust comes from tableThrust_
+  std::vector<TabulatedEngine> tables_;
+  std::vector<std::shared_ptr<const NozzlePerformance>> nozzles_;
+  double step_ = 0.0; // Curve thrust is averaged over this (s); 0 samples it
+  // State
+  std::vector<double> lit_; // 1 while running, 0 when shut down
+  std::vector<double> throttle_;
+  std::vector<double> gimbalX_, gimbalY_; // rad
+  // Cache, valid for the current gimbal angles
+  std::array<std::vector<double>, 9> rotation_; // Row-major 3x3
+  std::array<std::vector<double>, 3> torqueArm_;
+  mutable std::vector<double> tableThrust_;    // Full-throttle thrust (N)
+  mutable std::vector<double> pressureFactor_; // Nozzle thrust / rating
+
+  static std::size_t padded(std::size_t n) {
+    return (n + LANES - 1) / LANES * LANES;
+  }
+
+  void resizeLanes(std::size_t n) {
+    for (auto *field :
+         {&maxThrust_, &flowRate_, &posX_, &posY_, &posZ_, &tabulated_, &lit_,
+          &throttle_, &gimbalX_, &gimbalY_, &tableThrust_, &pressureFactor_})
+      field->resize(n, 0.0);
+    for (auto &field : rotation_)
+      field.resize(n, 0.0);
+    for (auto &field : torqueArm_)
+      field.resize(n, 0.0);
+  }
+
+  // Gimbal rotation R = Rx(angleX) * Ry(angleY)
+  void rebuildRotation(std::size_t i) {
+    Mat3 r = Mat3::rotationX(gimbalX_[i]) * Mat3::rotationY(gimbalY_[i]);
+    for (std::size_t k = 0; k < 9; ++k)
+      rotation_[k][i] = r(k / 3, k % 3);
+
+    const Vec3 &axis = r.column(2);
+    Vec3 arm = Vec3(posX_[i], posY_[i], posZ_[i]).cross(axis);
+    torqueArm_[0][i] = arm.x();
+    torqueArm_[1][i] = arm.y();
+    torqueArm_[2][i] = arm.z();
+  }
+
+  // Thrust and flow for the step starting at burnTime: the mean over the
+  // step, so the impulse delivered matches the propellant advance() burns
+  void refreshCurve(TabulatedEngine &engine) {
+    if (!engine.curve)
+      return;
+    const ThrustCurve &curve = *engine.curve;
+    if (step_ > 0) {
+      double impulse =
+          curve.getImpulse(engine.burnTime + step_, engine.curveCursor) -
+          curve.getImpulse(engine.burnTime, engine.curveCursor);
+      engine.curveThrust = impulse / step_;
+      flowRate_[engine.lane] = curve.getPropellantMass() * impulse /
+                               (curve.getTotalImpulse() * step_);
+      return;
+    }
+    engine.curveThrust = curve.getThrust(engine.burnTime, engine.curveCursor);
+    flowRate_[engine.lane] =
+        curve.getMassFlow(engine.burnTime, engine.curveCursor);
+  }
+
+  // Pressure-dependent lane inputs: nozzle factors from each engine's
+  // precomputed table (or the linear factor), and the table-driven thrusts
+  void updatePressureTerms(double atmosphericPressure) const {
+    for (std::size_t i = 0; i < count_; ++i)
+      pressureFactor_[i] =
+          nozzles_[i] ? nozzles_[i]->getThrustFactor(atmosphericPressure)
+                      : linearThrustFactor(atmosphericPressure);
+    for (const auto &engine : tables_) {
+      tableThrust_[engine.lane] =
+          engine.isp ? flowRate_[engine.lane] * Constants::STANDARD_GRAVITY *
+                           engine.isp->lookup(atmosphericPressure,
+                                              engine.ispCursor)
+                     : engine.curveThrust;
+    }
+  }
+
+public:
+  EngineCluster() : count_(0) {}
+
+  void add(const Engine &engine) {
+    std::size_t i = count_++;
+    if (padded(count_) > maxThrust_.size())
+      resizeLanes(padded(count_));
+
+    maxThrust_[i] = engine.getMaxThrust();
+    flowRate_[i] = engine.getMassFlowRate();
+    posX_[i] = engine.getMountPosition().x();
+    posY_[i] = engine.getMountPosition().y();
+    posZ_[i] = engine.getMountPosition().z();
+    nozzles_.push_back(engine.getNozzlePerformance());
+    rebuildRotation(i);
+
+    if (engine.getThrustCurve() || engine.getIspTable()) {
+      tabulated_[i] = 1.0;
+      tables_.push_back({i, engine.getThrustCurve(), engine.getIspTable(), 0.0,
+                         0, 0, 0.0});
+      refreshCurve(tables_.back());
+    }
+  }
+
+  std::size_t size() const { return count_; }
+
+  // Length of the steps advance() will be called with; curve engines then
+  // deliver each step's thrust as its mean over the step
+  void setStep(double dt) {
+    step_ = dt;
+    for (auto &engine : tables_)
+      refreshCurve(engine);
+  }
+
+  void start() { std::fill(lit_.begin(), lit_.begin() + count_, 1.0); }
+  void shutdown() {
+    std::fill(lit_.begin(), lit_.end(), 0.0);
+    std::fill(throttle_.begin(), throttle_.end(), 0.0);
+  }
+  bool anyLit() const {
+    return std::any_of(lit_.begin(), lit_.end(),
+                       [](double lit) { return lit != 0.0; });
+  }
+  bool isLit(std::size_t i) const { return lit_.at(i) != 0.0; }
+
+  void setThrottle(double throttle) {
+    std::fill(throttle_.begin(), throttle_.begin() + count_,
+              std::clamp(throttle, 0.0, 1.0));
+  }
+  double getThrottle(std::size_t i) const { return throttle_.at(i); }
+
+  void setGimbalAngles(double angleX, double angleY) {
+    for (std::size_t i = 0; i < count_; ++i)
+      setGimbalAngles(i, angleX, angleY);
+  }
+  void setGimbalAngles(std::size_t i, double angleX, double angleY) {
+    if (i >= count_)
+      throw std::out_of_range("Engine index out of range");
+    if (gimbalX_[i] == angleX && gimbalY_[i] == angleY)
+      return;
+    gimbalX_[i] = angleX;
+    gimbalY_[i] = angleY;
+    rebuildRotation(i);
+  }
+
+  // Propellant flow of the lit engines at their current throttle (kg/s)
+  double getMassFlow() const {
+    double lanes[LANES] = {};
+    for (std::size_t i = 0; i < lit_.size(); i += LANES)
+      for (std::size_t l = 0; l < LANES; ++l)
+        lanes[l] += lit_[i + l] * throttle_[i + l] * flowRate_[i + l];
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  }
+
+  // Move the lit engines dt seconds along their burn and return the
+  // propellant used (kg). Curve engines integrate their table exactly (with
+  // dt equal to setStep's, this is what their mean flow burned) and shut
+  // down at burnout.
+  double advance(double dt) {
+    double consumed = getMassFlow() * dt;
+    for (auto &engine : tables_) {
+      std::size_t i = engine.lane;
+      if (!engine.curve || lit_[i] == 0.0)
+        continue;
+
+      const ThrustCurve &curve = *engine.curve;
+      double impulse = curve.getImpulse(engine.burnTime + dt,
+                                        engine.curveCursor) -
+                       curve.getImpulse(engine.burnTime, engine.curveCursor);
+      consumed += throttle_[i] *
+                      (curve.getPropellantMass() * impulse /
+                       curve.getTotalImpulse()) -
+                  throttle_[i] * flowRate_[i] * dt;
+
+      engine.burnTime += dt;
+      refreshCurve(engine);
+      if (engine.burnTime >= curve.getBurnTime())
+        lit_[i] = 0.0;
+    }
+    return consumed;
+  }
+
+  // Totals for the whole cluster with the thrust axis along direction
+  // (world frame, unit length). Each quantity is accumulated in LANES
+  // independent partial sums so the loop vectorizes without reassociation.
+  ClusterOutput evaluate(double atmosphericPressure,
+                         const Vec3 &direction) const {
+    updatePressureTerms(atmosphericPressure);
+
+    // [0] mass flow, [1..9] sum of thrust * R, [10..12] torque
+    double acc[13][LANES] = {};
+    for (std::size_t i = 0; i < lit_.size(); i += LANES) {
+      for (std::size_t l = 0; l < LANES; ++l) {
+        double duty = lit_[i + l] * throttle_[i + l];
+        double tabulated = tabulated_[i + l];
+        double thrust =
+            duty * (tabulated * tableThrust_[i + l] +
+                    (1.0 - tabulated) * maxThrust_[i + l] *
+                        pressureFactor_[i + l]);
+        acc[0][l] += duty * flowRate_[i + l];
+        for (std::size_t k = 0; k < 9; ++k)
+          acc[1 + k][l] += thrust * rotation_[k][i + l];
+        for (std::size_t k = 0; k < 3; ++k)
+          acc[10 + k][l] += thrust * torqueArm_[k][i + l];
+      }
+    }
+
+    double sum[13];
+    for (std::size_t k = 0; k < 13; ++k)
+      sum[k] = (acc[k][0] + acc[k][1]) + (acc[k][2] + acc[k][3]);
+
+    const double *m = sum + 1;
+    Vec3 thrust(m[0] * direction.x() + m[1] * direction.y() +
+                    m[2] * direction.z(),
+                m[3] * direction.x() + m[4] * direction.y() +
+                    m[5] * direction.z(),
+                m[6] * direction.x() + m[7] * direction.y() +
+                    m[8] * direction.z());
+    return {thrust, Vec3(sum[10], sum[11], sum[12]), sum[0]};
+  }
+};
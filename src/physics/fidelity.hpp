@@ -0,0 +1,147 @@
+#pragma once
+#include "../math/mathpolicy.hpp"
+#include "../math/table1d.hpp"
+#include "../math/vec3.hpp"
+#include "atmosphere.hpp"
+#include "gravity.hpp"
+#include "rocketbody.hpp"
+#include <cstddef>
+
+// Physics fidelity levels. A level is a stateless policy that the force
+// models, the pipeline and BasicSimulationEngine are instantiated with, so
+// each level compiles to its own hot loop with nothing decided at run time.
+// Every level supplies the same static interface:
+//   NAME, CORIOLIS (whether the default pipeline includes it),
+//   density/pressure<Math>(altitude), temperature(altitude),
+//   dragCoefficient(mach), gravity(position) and wind(position).
+
+// Quick look: exponential atmosphere, one drag coefficient, point-mass
+// gravity and no Coriolis term
+struct FastFidelity {
+  static constexpr const char *NAME = "fast";
+  static constexpr bool CORIOLIS = false;
+  static constexpr double DRAG_COEFFICIENT = 0.3;
+
+  template <class Math = ExactMath, class T>
+  static T density(const T &altitude) {
+    return Atmosphere::getDensity<Math>(altitude);
+  }
+  template <class Math = ExactMath, class T>
+  static T pressure(const T &altitude) {
+    return Atmosphere::getPressure<Math>(altitude);
+  }
+  template <class T> static T temperature(const T &altitude) {
+    return Atmosphere::getTemperature(altitude);
+  }
+  template <class T> static T dragCoefficient(const T &) {
+    return T(DRAG_COEFFICIENT);
+  }
+  template <class T>
+  static BasicVec3<T> gravity(const BasicVec3<T> &position) {
+    return Gravity::getAcceleration(position);
+  }
+  template <class T> static BasicVec3<T> wind(const BasicVec3<T> &) {
+    return BasicVec3<T>();
+  }
+};
+
+// The long-standing model set: exponential atmosphere, the three-regime
+// drag model, point-mass gravity and Coriolis, in still air
+struct StandardFidelity {
+  static constexpr const char *NAME = "standard";
+  static constexpr bool CORIOLIS = true;
+
+  template <class Math = ExactMath, class T>
+  static T density(const T &altitude) {
+    return Atmosphere::getDensity<Math>(altitude);
+  }
+  template <class Math = ExactMath, class T>
+  static T pressure(const T &altitude) {
+    return Atmosphere::getPressure<Math>(altitude);
+  }
+  template <class T> static T temperature(const T &altitude) {
+    return Atmosphere::getTemperature(altitude);
+  }
+  template <class T> static T dragCoefficient(const T &mach) {
+    return RocketBody::dragCoefficientAt(mach);
+  }
+  template <class T>
+  static BasicVec3<T> gravity(const BasicVec3<T> &position) {
+    return Gravity::getAcceleration(position);
+  }
+  template <class T> static BasicVec3<T> wind(const BasicVec3<T> &) {
+    return BasicVec3<T>();
+  }
+};
+
+// Full fidelity: the 1976 standard atmosphere, a tabulated transonic drag
+// rise, J2 gravity and a mid-latitude westerly wind profile
+struct HighFidelity {
+  static constexpr const char *NAME = "high";
+  static constexpr bool CORIOLIS = true;
+
+  // Cd against Mach for a slender ogive body
+  static const Table1D &dragTable() {
+    static const Table1D table(
+        {0.0, 0.6, 0.8, 0.9, 1.0, 1.1, 1.2, 1.5, 2.0, 3.0, 5.0},
+        {0.20, 0.20, 0.22, 0.28, 0.40, 0.45, 0.44, 0.40, 0.36, 0.32, 0.30});
+    return table;
+  }
+  // Each table's lookups start from the segment the last one ended in, so
+  // a flight moving through it walks O(1) segments per call. The cursor is
+  // only a starting point: flights sharing a thread just walk further.
+  static std::size_t &dragCursor() {
+    static thread_local std::size_t cursor = 0;
+    return cursor;
+  }
+  static std::size_t &windCursor() {
+    static thread_local std::size_t cursor = 0;
+    return cursor;
+  }
+
+  // Eastward wind speed (m/s) against altitude (m), with the jet stream
+  // near the tropopause
+  static const Table1D &windTable() {
+    static const Table1D table(
+        {0.0, 1000.0, 5000.0, 11000.0, 15000.0, 20000.0, 30000.0, 50000.0,
+         80000.0},
+        {3.0, 8.0, 18.0, 35.0, 25.0, 8.0, 12.0, 30.0, 0.0});
+    return table;
+  }
+
+  template <class Math = ExactMath, class T>
+  static T density(const T &altitude) {
+    return StandardAtmosphere::instance().getDensity<Math>(altitude);
+  }
+  template <class Math = ExactMath, class T>
+  static T pressure(const T &altitude) {
+    return StandardAtmosphere::instance().getPressure<Math>(altitude);
+  }
+  template <class T> static T temperature(const T &altitude) {
+    return StandardAtmosphere::instance().getTemperature(altitude);
+  }
+  template <class T> static T dragCoefficient(const T &mach) {
+    const Table1D &table = dragTable();
+    std::size_t &cursor = dragCursor();
+    cursor = table.seek(Scalar::value(mach), cursor);
+    return table.interpolate(mach, cursor);
+  }
+  template <class T>
+  static BasicVec3<T> gravity(const BasicVec3<T> &position) {
+    return Gravity::getAccelerationJ2(position);
+  }
+  // Due east (spin axis z cross position) at the windTable speed for the
+  // altitude, 3 m/s at the ground up to 35 m/s in the jet stream, the same
+  // at every latitude. East is undefined on the axis, so the wind is zero
+  // there.
+  template <class T>
+  static BasicVec3<T> wind(const BasicVec3<T> &position) {
+    const Table1D &table = windTable();
+    T altitude = position.magnitude() - Constants::EARTH_RADIUS;
+    std::size_t &cursor = windCursor();
+    cursor = table.seek(Scalar::value(altitude), cursor);
+    T speed = table.interpolate(altitude, cursor);
+    BasicVec3<T> east = BasicVec3<T>(0.0, 0.0, 1.0).cross(position);
+    return east.normalize() * speed;
+  }
+};
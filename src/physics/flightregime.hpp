@@ -0,0 +1,126 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <iomanip>
+#include <ostream>
+
+// Flight phases in which some force models are negligible and can be skipped
+enum class FlightRegime {
+  OnPad,              // Resting on the pad, no thrust: nothing to integrate
+  PoweredAtmospheric, // Thrust + gravity + aerodynamics
+  PoweredVacuum,      // Thrust + gravity, air too thin for aero
+  CoastAtmospheric,   // Gravity + aerodynamics, engines off or dry
+  CoastVacuum,        // Gravity only (plus Coriolis)
+  Count
+};
+
+namespace RegimeDefaults {
+// Below this density (kg/m³) aerodynamic forces are treated as zero
+constexpr double VACUUM_DENSITY_THRESHOLD = 1e-8;
+// Speed (m/s) under which an unpowered vehicle at pad altitude is at rest
+constexpr double REST_SPEED = 1e-6;
+// Altitude band (m) above the launch altitude still considered on the pad
+constexpr double PAD_ALTITUDE_TOLERANCE = 0.01;
+} // namespace RegimeDefaults
+
+class RegimeDetector {
+private:
+  double vacuumDensityThreshold_; // kg/m³
+  double padAltitude_;            // Launch altitude (m)
+
+public:
+  explicit RegimeDetector(
+      double padAltitude = 0.0,
+      double vacuumDensityThreshold = RegimeDefaults::VACUUM_DENSITY_THRESHOLD)
+      : vacuumDensityThreshold_(vacuumDensityThreshold),
+        padAltitude_(padAltitude) {}
+
+  FlightRegime classify(double altitude, double density, double speed,
+                        bool powered) const {
+    bool vacuum = density < vacuumDensityThreshold_;
+    if (powered)
+      return vacuum ? FlightRegime::PoweredVacuum
+                    : FlightRegime::PoweredAtmospheric;
+    if (speed < RegimeDefaults::REST_SPEED &&
+        altitude <= padAltitude_ + RegimeDefaults::PAD_ALTITUDE_TOLERANCE)
+      return FlightRegime::OnPad;
+    return vacuum ? FlightRegime::CoastVacuum : FlightRegime::CoastAtmospheric;
+  }
+
+  void setVacuumDensityThreshold(double threshold) {
+    vacuumDensityThreshold_ = threshold;
+  }
+  double getVacuumDensityThreshold() const { return vacuumDensityThreshold_; }
+  void setPadAltitude(double altitude) { padAltitude_ = altitude; }
+  double getPadAltitude() const { return padAltitude_; }
+};
+
+constexpr bool hasAerodynamics(FlightRegime regime) {
+  return regime == FlightRegime::PoweredAtmospheric ||
+         regime == FlightRegime::CoastAtmospheric;
+}
+
+constexpr bool hasThrust(FlightRegime regime) {
+  return regime == FlightRegime::PoweredAtmospheric ||
+         regime == FlightRegime::PoweredVacuum;
+}
+
+inline const char *regimeName(FlightRegime regime) {
+  switch (regime) {
+  case FlightRegime::OnPad:
+    return "On pad";
+  case FlightRegime::PoweredAtmospheric:
+    return "Powered, atmospheric";
+  case FlightRegime::PoweredVacuum:
+    return "Powered, vacuum";
+  case FlightRegime::CoastAtmospheric:
+    return "Coast, atmospheric";
+  case FlightRegime::CoastVacuum:
+    return "Coast, vacuum";
+  default:
+    return "Unknown";
+  }
+}
+
+// Per-regime step counts, simulated time and wall-clock time
+class RegimeReport {
+private:
+  static constexpr std::size_t N =
+      static_cast<std::size_t>(FlightRegime::Count);
+  std::array<std::size_t, N> steps_{};
+  std::array<double, N> simTime_{};  // Simulated seconds
+  std::array<double, N> wallTime_{}; // Wall-clock seconds spent stepping
+
+public:
+  void record(FlightRegime regime, double simDt, double wallDt) {
+    std::size_t i = static_cast<std::size_t>(regime);
+    steps_[i]++;
+    simTime_[i] += simDt;
+    wallTime_[i] += wallDt;
+  }
+
+  std::size_t getSteps(FlightRegime regime) const {
+    return steps_[static_cast<std::size_t>(regime)];
+  }
+  double getSimTime(FlightRegime regime) const {
+    return simTime_[static_cast<std::size_t>(regime)];
+  }
+  double getWallTime(FlightRegime regime) const {
+    return wallTime_[static_cast<std::size_t>(regime)];
+  }
+
+  void print(std::ostream &out) const {
+    out << "Regime                  Steps    Sim time (s)  Wall time (ms)"
+           "  us/step\n";
+    for (std::size_t i = 0; i < N; ++i) {
+      if (steps_[i] == 0)
+        continue;
+      out << std::left << std::setw(22)
+          << regimeName(static_cast<FlightRegime>(i)) << std::right
+          << std::setw(7) << steps_[i] << std::fixed << std::setprecision(2)
+          << std::setw(16) << simTime_[i] << std::setprecision(3)
+          << std::setw(16) << wallTime_[i] * 1e3 << std::setprecision(3)
+          << std::setw(9) << wallTime_[i] * 1e6 / steps_[i] << "\n";
+    }
+  }
+};
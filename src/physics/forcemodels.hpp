@@ -0,0 +1,238 @@
+#pragma once
+#include "../math/mathpolicy.hpp"
+#include "aerodynamics.hpp"
+#include "fidelity.hpp"
+#include "flightregime.hpp"
+#include "gravity.hpp"
+#include "propulsionsystem.hpp"
+#include "rocketbody.hpp"
+#include "state.hpp"
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Everything a force model may read besides the state being evaluated. T is
+// the state's scalar type; for Dual runs the thrust and drag scale carry the
+// derivatives with respect to the sensitivity parameters.
+template <class T> struct BasicForceContext {
+  RocketBody &rocket;
+  const PropulsionSystem &propulsion;
+  double pressure;     // Ambient pressure at the start of the step (Pa)
+  BasicVec3<T> thrust; // Cluster thrust, fixed over the step's RK4 stages (N)
+  T dragScale;         // Multiplies the drag coefficient
+};
+using ForceContext = BasicForceContext<double>;
+
+// A force model is a stateless functor with a name, a compile-time regime
+// filter and BasicVec3<T> operator()(const BasicState<T> &,
+// const BasicForceContext<T> &) in Newtons. Models are templates over the
+// scalar type so the same code runs on double and on Dual. Fidelity is the
+// model level (see fidelity.hpp).
+
+template <class Fidelity> struct BasicGravityForce {
+  static constexpr const char *NAME = "gravity";
+  static constexpr bool appliesIn(FlightRegime) { return true; }
+  template <class T>
+  BasicVec3<T> operator()(const BasicState<T> &s,
+                          const BasicForceContext<T> &) const {
+    return Fidelity::gravity(s.position) * s.mass;
+  }
+};
+using GravityForce = BasicGravityForce<StandardFidelity>;
+
+// Math is the accuracy policy for exp/sqrt/acos (see mathpolicy.hpp)
+template <class Math, class Fidelity = StandardFidelity>
+struct BasicAerodynamicForce {
+  static constexpr const char *NAME = "aero";
+  static constexpr bool appliesIn(FlightRegime regime) {
+    return hasAerodynamics(regime);
+  }
+  template <class T>
+  BasicVec3<T> operator()(const BasicState<T> &s,
+                          const BasicForceContext<T> &ctx) const {
+    return Aerodynamics::calculateAirloads<Math, Fidelity>(
+        s, ctx.rocket, Fidelity::wind(s.position), ctx.dragScale);
+  }
+};
+using AerodynamicForce = BasicAerodynamicForce<ExactMath>;
+
+struct CoriolisForce {
+  static constexpr const char *NAME = "coriolis";
+  static constexpr bool appliesIn(FlightRegime regime) {
+    return regime != FlightRegime::OnPad;
+  }
+  template <class T>
+  BasicVec3<T> operator()(const BasicState<T> &s,
+                          const BasicForceContext<T> &) const {
+    return Aerodynamics::calculateCoriolisForce(s, s.mass);
+  }
+};
+
+struct ThrustForce {
+  static constexpr const char *NAME = "thrust";
+  static constexpr bool appliesIn(FlightRegime regime) {
+    return hasThrust(regime);
+  }
+  template <class T>
+  BasicVec3<T> operator()(const BasicState<T> &,
+                          const BasicForceContext<T> &ctx) const {
+    return ctx.thrust;
+  }
+};
+
+// Compile-time list of force models. The sum is a fold over a tuple, so each
+// regime instantiation inlines only the models that apply to it.
+template <class... Models> class ForcePipeline {
+private:
+  std::tuple<Models...> models_;
+
+public:
+  ForcePipeline() = default;
+  explicit ForcePipeline(Models... models) : models_(std::move(models)...) {}
+
+  template <FlightRegime Regime, class T>
+  BasicVec3<T> evaluate(const BasicState<T> &s,
+                        const BasicForceContext<T> &ctx) const {
+    return std::apply(
+        [&](const auto &...model) {
+          BasicVec3<T> total;
+          ((total = total + evaluateOne<Regime>(model, s, ctx)), ...);
+          return total;
+        },
+        models_);
+  }
+
+  // Calls visit(name, force) for each model active in the regime
+  template <FlightRegime Regime, class T, class Visitor>
+  void forEachForce(const BasicState<T> &s, const BasicForceContext<T> &ctx,
+                    Visitor &&visit) const {
+    std::apply(
+        [&](const auto &...model) {
+          (visitOne<Regime>(model, s, ctx, visit), ...);
+        },
+        models_);
+  }
+
+private:
+  template <FlightRegime Regime, class Model, class T>
+  static BasicVec3<T> evaluateOne(const Model &model, const BasicState<T> &s,
+                                  const BasicForceContext<T> &ctx) {
+    if constexpr (Model::appliesIn(Regime))
+      return model(s, ctx);
+    else
+      return BasicVec3<T>();
+  }
+
+  template <FlightRegime Regime, class Model, class T, class Visitor>
+  static void visitOne(const Model &model, const BasicState<T> &s,
+                       const BasicForceContext<T> &ctx, Visitor &visit) {
+    if constexpr (Model::appliesIn(Regime))
+      visit(Model::NAME, model(s, ctx));
+  }
+};
+
+// Every model of the fidelity level; Coriolis only where the level has it
+template <class Math, class Fidelity = StandardFidelity>
+using BasicDefaultForcePipeline = std::conditional_t<
+    Fidelity::CORIOLIS,
+    ForcePipeline<BasicGravityForce<Fidelity>,
+                  BasicAerodynamicForce<Math, Fidelity>, CoriolisForce,
+                  ThrustForce>,
+    ForcePipeline<BasicGravityForce<Fidelity>,
+                  BasicAerodynamicForce<Math, Fidelity>, ThrustForce>>;
+using DefaultForcePipeline = BasicDefaultForcePipeline<ExactMath>;
+
+// Type-erased model for pipelines assembled at run time from a config.
+// Virtual calls cannot be templates, so these run on double states only.
+class ForceModel {
+public:
+  virtual ~ForceModel() = default;
+  virtual const char *name() const = 0;
+  virtual bool appliesIn(FlightRegime regime) const = 0;
+  virtual Vec3 evaluate(const State &s, const ForceContext &ctx) const = 0;
+};
+
+template <class Model> class ForceModelAdapter : public ForceModel {
+private:
+  Model model_;
+
+public:
+  explicit ForceModelAdapter(Model model = Model())
+      : model_(std::move(model)) {}
+
+  const char *name() const override { return Model::NAME; }
+  bool appliesIn(FlightRegime regime) const override {
+    return Model::appliesIn(regime);
+  }
+  Vec3 evaluate(const State &s, const ForceContext &ctx) const override {
+    return model_(s, ctx);
+  }
+};
+
+// Runtime-configurable counterpart of ForcePipeline with the same interface.
+// Each model costs a virtual call and a regime check per evaluation.
+class DynamicForcePipeline {
+private:
+  std::vector<std::unique_ptr<ForceModel>> models_;
+
+public:
+  void add(std::unique_ptr<ForceModel> model) {
+    models_.push_back(std::move(model));
+  }
+  template <class Model> void add(Model model = Model()) {
+    models_.push_back(
+        std::make_unique<ForceModelAdapter<Model>>(std::move(model)));
+  }
+
+  std::size_t size() const { return models_.size(); }
+
+  template <FlightRegime Regime>
+  Vec3 evaluate(const State &s, const ForceContext &ctx) const {
+    Vec3 total;
+    for (const auto &model : models_) {
+      if (model->appliesIn(Regime))
+        total = total + model->evaluate(s, ctx);
+    }
+    return total;
+  }
+
+  template <FlightRegime Regime, class Visitor>
+  void forEachForce(const State &s, const ForceContext &ctx,
+                    Visitor &&visit) const {
+    for (const auto &model : models_) {
+      if (model->appliesIn(Regime))
+        visit(model->name(), model->evaluate(s, ctx));
+    }
+  }
+
+  // Build from model names as listed in the config, e.g. "gravity", "aero".
+  // Naming a model the level leaves out ("coriolis" at the fast level) is
+  // an error rather than a model that silently does nothing.
+  template <class Math = ExactMath, class Fidelity = StandardFidelity>
+  static DynamicForcePipeline fromNames(const std::vector<std::string> &names) {
+    using Gravity = BasicGravityForce<Fidelity>;
+    using Aero = BasicAerodynamicForce<Math, Fidelity>;
+    DynamicForcePipeline pipeline;
+    for (const auto &name : names) {
+      if (name == Gravity::NAME)
+        pipeline.add<Gravity>();
+      else if (name == Aero::NAME)
+        pipeline.add<Aero>();
+      else if (name == CoriolisForce::NAME) {
+        if (!Fidelity::CORIOLIS)
+          throw std::invalid_argument(
+              "Force model " + name + " is not part of the " +
+              Fidelity::NAME + " fidelity level");
+        pipeline.add<CoriolisForce>();
+      } else if (name == ThrustForce::NAME)
+        pipeline.add<ThrustForce>();
+      else
+        throw std::invalid_argument("Unknown force model: " + name);
+    }
+    return pipeline;
+  }
+};
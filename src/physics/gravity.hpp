@@ -4,12 +4,26 @@
 
 class Gravity {
 public:
-  static Vec3 getAcceleration(const Vec3 &position) {
-    double altitude = position.magnitude() - Constants::EARTH_RADIUS;
-    if (altitude < 0)
-      altitude = 0.0;
-    double r = position.magnitude();
-    double g = Constants::G * Constants::EARTH_MASS / (r * r);
+  template <class T>
+  static BasicVec3<T> getAcceleration(const BasicVec3<T> &position) {
+    T r = position.magnitude();
+    T g = Constants::G * Constants::EARTH_MASS / (r * r);
     return position.normalize() * (-g);
   }
+
+  // Point mass plus the J2 oblateness term, with z along the spin axis
+  template <class T>
+  static BasicVec3<T> getAccelerationJ2(const BasicVec3<T> &position) {
+    const double mu = Constants::G * Constants::EARTH_MASS;
+    const double re = Constants::EARTH_EQUATORIAL_RADIUS;
+    T r2 = position.dot(position);
+    T r = Scalar::sqrt(r2);
+    T z2 = position.z() * position.z() / r2; // sin^2 of the latitude
+    T j2 = 1.5 * Constants::EARTH_J2 * re * re / r2;
+    T radial = -mu / (r2 * r);
+    T equatorial = radial * (1.0 + j2 * (1.0 - 5.0 * z2));
+    T polar = radial * (1.0 + j2 * (3.0 - 5.0 * z2));
+    return BasicVec3<T>(position.x() * equatorial, position.y() * equatorial,
+                        position.z() * polar);
+  }
 };
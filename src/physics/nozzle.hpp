@@ -0,0 +1,190 @@
+#pragma once
+#include "constants.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace NozzleConstants {
+// Ratio of specific heats for typical combustion products
+constexpr double EXHAUST_GAMMA = 1.2;
+// Exit area / throat area of a typical first-stage engine
+constexpr double EXPANSION_RATIO = 16.0;
+// Summerfield criterion: flow separates where wall pressure < 0.4 * ambient
+constexpr double SEPARATION_RATIO = 0.4;
+} // namespace NozzleConstants
+
+// Quasi-1D isentropic nozzle flow for a given throat area, area expansion
+// ratio and gamma. All quantities are ratios to chamber conditions.
+class Nozzle {
+private:
+  double throatArea_;     // m²
+  double expansionRatio_; // Exit area / throat area
+  double gamma_;
+  double exitMach_;
+  double exitPressureRatio_; // Exit static pressure / chamber pressure
+
+  // Area ratio A/A* at Mach number mach
+  double areaRatio(double mach) const {
+    double g = gamma_;
+    double t = (2.0 / (g + 1.0)) * (1.0 + 0.5 * (g - 1.0) * mach * mach);
+    return std::pow(t, (g + 1.0) / (2.0 * (g - 1.0))) / mach;
+  }
+
+  // Supersonic Mach number at area ratio ratio (bisection, area is monotonic)
+  double supersonicMach(double ratio) const {
+    double lo = 1.0, hi = 100.0;
+    for (int i = 0; i < 200; ++i) {
+      double mid = 0.5 * (lo + hi);
+      if (areaRatio(mid) < ratio)
+        lo = mid;
+      else
+        hi = mid;
+    }
+    return 0.5 * (lo + hi);
+  }
+
+  double staticPressureRatio(double mach) const {
+    double g = gamma_;
+    return std::pow(1.0 + 0.5 * (g - 1.0) * mach * mach, -g / (g - 1.0));
+  }
+
+  double machAtPressureRatio(double ratio) const {
+    double g = gamma_;
+    return std::sqrt(2.0 / (g - 1.0) *
+                     (std::pow(ratio, -(g - 1.0) / g) - 1.0));
+  }
+
+  // Momentum part of the thrust coefficient with the flow expanded to ratio
+  double momentumCoefficient(double ratio) const {
+    double g = gamma_;
+    double k = 2.0 * g * g / (g - 1.0) *
+               std::pow(2.0 / (g + 1.0), (g + 1.0) / (g - 1.0));
+    return std::sqrt(k * (1.0 - std::pow(ratio, (g - 1.0) / g)));
+  }
+
+public:
+  Nozzle(double throatArea, double expansionRatio,
+         double gamma = NozzleConstants::EXHAUST_GAMMA)
+      : throatArea_(throatArea), expansionRatio_(expansionRatio),
+        gamma_(gamma) {
+    if (throatArea_ <= 0)
+      throw std::invalid_argument("Throat area must be positive");
+    if (expansionRatio_ < 1.0)
+      throw std::invalid_argument("Expansion ratio must be at least 1");
+    if (gamma_ <= 1.0)
+      throw std::invalid_argument("Gamma must be greater than 1");
+    exitMach_ = expansionRatio_ > 1.0 ? supersonicMach(expansionRatio_) : 1.0;
+    exitPressureRatio_ = staticPressureRatio(exitMach_);
+  }
+
+  double getThroatArea() const { return throatArea_; }
+  double getExpansionRatio() const { return expansionRatio_; }
+  double getGamma() const { return gamma_; }
+  double getExitMach() const { return exitMach_; }
+  double getExitPressureRatio() const { return exitPressureRatio_; }
+
+  // Thrust coefficient F / (pc * At). When the exit is heavily over-expanded
+  // the flow is assumed to separate where the wall pressure drops to
+  // SEPARATION_RATIO * ambient, and the nozzle beyond adds nothing.
+  double thrustCoefficient(double chamberPressure,
+                           double ambientPressure) const {
+    double exitPressure = exitPressureRatio_ * chamberPressure;
+    double separationPressure =
+        NozzleConstants::SEPARATION_RATIO * ambientPressure;
+    if (exitPressure >= separationPressure) {
+      return momentumCoefficient(exitPressureRatio_) +
+             expansionRatio_ * (exitPressure - ambientPressure) /
+                 chamberPressure;
+    }
+
+    double ratio = separationPressure / chamberPressure;
+    if (ratio >= 1.0)
+      return 0.0; // Chamber pressure too low to reach the throat choked
+    double separationArea = areaRatio(machAtPressureRatio(ratio));
+    return momentumCoefficient(ratio) +
+           separationArea * (separationPressure - ambientPressure) /
+               chamberPressure;
+  }
+
+  double thrust(double chamberPressure, double ambientPressure) const {
+    return std::max(0.0, chamberPressure * throatArea_ *
+                             thrustCoefficient(chamberPressure,
+                                               ambientPressure));
+  }
+
+  // Chamber pressure that delivers thrust at ambientPressure (bisection in
+  // log space; thrust grows monotonically with chamber pressure)
+  double chamberPressureFor(double targetThrust,
+                            double ambientPressure) const {
+    double lo = std::log(1.0), hi = std::log(1e10);
+    if (thrust(std::exp(hi), ambientPressure) < targetThrust)
+      throw std::invalid_argument("Nozzle cannot reach the rated thrust");
+    for (int i = 0; i < 200; ++i) {
+      double mid = 0.5 * (lo + hi);
+      if (thrust(std::exp(mid), ambientPressure) < targetThrust)
+        lo = mid;
+      else
+        hi = mid;
+    }
+    return std::exp(0.5 * (lo + hi));
+  }
+};
+
+// Thrust and Isp of one engine against ambient pressure. Solving the nozzle
+// needs root finding, so it is done once at load time into a table on a
+// uniform pressure grid; a per-step lookup is an index and one lerp.
+class NozzlePerformance {
+public:
+  static constexpr std::size_t TABLE_SIZE = 129;
+
+private:
+  Nozzle nozzle_;
+  double ratedThrust_;     // At ratedPressure (N)
+  double ratedIsp_;        // At ratedPressure (s)
+  double chamberPressure_; // Pa
+  double pressureStep_;    // Table spacing (Pa)
+  std::vector<double> thrustFactor_; // Thrust / rated thrust
+
+public:
+  NozzlePerformance(const Nozzle &nozzle, double ratedThrust, double ratedIsp,
+                    double ratedPressure = Constants::SEA_LEVEL_PRESSURE)
+      : nozzle_(nozzle), ratedThrust_(ratedThrust), ratedIsp_(ratedIsp),
+        chamberPressure_(
+            nozzle.chamberPressureFor(ratedThrust, ratedPressure)),
+        pressureStep_(1.2 * Constants::SEA_LEVEL_PRESSURE /
+                      (TABLE_SIZE - 1)),
+        thrustFactor_(TABLE_SIZE) {
+    for (std::size_t i = 0; i < TABLE_SIZE; ++i) {
+      thrustFactor_[i] =
+          nozzle_.thrust(chamberPressure_, i * pressureStep_) / ratedThrust_;
+    }
+  }
+
+  // Thrust relative to the rating at ambientPressure (Pa)
+  double getThrustFactor(double ambientPressure) const {
+    double x = std::max(ambientPressure, 0.0) / pressureStep_;
+    std::size_t i = std::min(static_cast<std::size_t>(x), TABLE_SIZE - 2);
+    double t = std::min(x - static_cast<double>(i), 1.0);
+    return thrustFactor_[i] + t * (thrustFactor_[i + 1] - thrustFactor_[i]);
+  }
+
+  // Flow is fixed by the chamber, so Isp scales with thrust
+  double getThrust(double ambientPressure) const {
+    return ratedThrust_ * getThrustFactor(ambientPressure);
+  }
+  double getSpecificImpulse(double ambientPressure) const {
+    return ratedIsp_ * getThrustFactor(ambientPressure);
+  }
+  double getThrustCoefficient(double ambientPressure) const {
+    return getThrust(ambientPressure) /
+           (chamberPressure_ * nozzle_.getThroatArea());
+  }
+
+  const Nozzle &getNozzle() const { return nozzle_; }
+  double getChamberPressure() const { return chamberPressure_; }
+  double getExitPressure() const {
+    return nozzle_.getExitPressureRatio() * chamberPressure_;
+  }
+};
@@ -1,17 +1,17 @@
 #pragma once
 #include "../math/vec3.hpp"
 #include "engine.hpp"
-#include <memory>
-#include <vector>
+#include "enginecluster.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 
 class PropulsionSystem {
 private:
-  std::vector<std::unique_ptr<Engine>> engines_;
+  EngineCluster engines_;
   double totalFuelMass_;   // Current fuel mass (kg)
   double initialFuelMass_; // Initial fuel mass (kg)
   Vec3 thrustDirection_;   // Normalized thrust direction
-  double gimbalAngleX_;    // Gimbal angle in X axis (rad)
-  double gimbalAngleY_;    // Gimbal angle in Y axis (rad)
   double maxGimbalAngle_;  // Maximum gimbal angle (rad)
 
 public:
@@ -20,108 +20,80 @@ public:
       : totalFuelMass_(initialFuel), initialFuelMass_(initialFuel),
         thrustDirection_(0, 0, 1) // Default thrust direction (up)
         ,
-        gimbalAngleX_(0), gimbalAngleY_(0),
         maxGimbalAngle_(maxGimbalAngleDeg * M_PI / 180.0) {}
 
-  // Delete copy constructor and assignment operator
-  PropulsionSystem(const PropulsionSystem &) = delete;
-  PropulsionSystem &operator=(const PropulsionSystem &) = delete;
-
-  // Move constructor
-  PropulsionSystem(PropulsionSystem &&other) noexcept
-      : engines_(std::move(other.engines_)),
-        totalFuelMass_(other.totalFuelMass_),
-        initialFuelMass_(other.initialFuelMass_),
-        thrustDirection_(other.thrustDirection_),
-        gimbalAngleX_(other.gimbalAngleX_), gimbalAngleY_(other.gimbalAngleY_),
-        maxGimbalAngle_(other.maxGimbalAngle_) {}
-
-  // Move assignment operator
-  PropulsionSystem &operator=(PropulsionSystem &&other) noexcept {
-    if (this != &other) {
-      engines_ = std::move(other.engines_);
-      totalFuelMass_ = other.totalFuelMass_;
-      initialFuelMass_ = other.initialFuelMass_;
-      thrustDirection_ = other.thrustDirection_;
-      gimbalAngleX_ = other.gimbalAngleX_;
-      gimbalAngleY_ = other.gimbalAngleY_;
-      maxGimbalAngle_ = other.maxGimbalAngle_;
-    }
-    return *this;
+  void addEngine(double maxThrust, double isp, double throatArea,
+                 double expansionRatio, const Vec3 &mountPosition = Vec3()) {
+    addEngine(Engine(maxThrust, isp, Nozzle(throatArea, expansionRatio),
+                     mountPosition));
   }
+  void addEngine(const Engine &engine) { engines_.add(engine); }
 
-  void addEngine(double maxThrust, double isp, double throatArea,
-                 double expansionRatio) {
-    engines_.push_back(
-        std::make_unique<Engine>(maxThrust, isp, throatArea, expansionRatio));
+  // Step length consumeFuel will be called with (s)
+  void setTimeStep(double dt) { engines_.setStep(dt); }
+
+  // Cluster thrust, torque and mass flow for the current engine settings.
+  // Does not burn fuel, so it can be evaluated at every integrator stage.
+  ClusterOutput evaluate(double atmosphericPressure) const {
+    if (totalFuelMass_ <= 0)
+      return {Vec3(), Vec3(), 0.0};
+    return engines_.evaluate(atmosphericPressure, thrustDirection_);
   }
 
-  Vec3 updateThrust(double atmosphericPressure, double dt) {
+  Vec3 getThrust(double atmosphericPressure) const {
+    return evaluate(atmosphericPressure).thrust;
+  }
+
+  // Burn one time step worth of fuel, shutting down when the tanks run dry
+  void consumeFuel(double dt) {
     if (totalFuelMass_ <= 0) {
       shutdownAllEngines();
-      return Vec3();
+      return;
     }
 
-    double totalThrust = 0.0;
-    double fuelConsumed = 0.0;
-
-    for (auto &engine : engines_) {
-      if (engine->isActive()) {
-        totalThrust += engine->getCurrentThrust(atmosphericPressure);
-        fuelConsumed += engine->getFuelConsumption(dt);
-      }
-    }
-
-    totalFuelMass_ -= fuelConsumed;
-    if (totalFuelMass_ < 0)
+    totalFuelMass_ -= engines_.advance(dt);
+    if (totalFuelMass_ <= 0) {
       totalFuelMass_ = 0;
+      shutdownAllEngines();
+    }
+  }
 
-    Vec3 gimbaled_direction = applyGimbal(thrustDirection_);
-    return gimbaled_direction.normalize() * totalThrust;
+  Vec3 updateThrust(double atmosphericPressure, double dt) {
+    Vec3 thrust = getThrust(atmosphericPressure);
+    consumeFuel(dt);
+    return thrust;
   }
+
+  // Gimbal every engine to the same angles
   void setGimbalAngles(double angleX, double angleY) {
-    gimbalAngleX_ = std::clamp(angleX, -maxGimbalAngle_, maxGimbalAngle_);
-    gimbalAngleY_ = std::clamp(angleY, -maxGimbalAngle_, maxGimbalAngle_);
+    engines_.setGimbalAngles(
+        std::clamp(angleX, -maxGimbalAngle_, maxGimbalAngle_),
+        std::clamp(angleY, -maxGimbalAngle_, maxGimbalAngle_));
   }
+  void setGimbalAngles(std::size_t engine, double angleX, double angleY) {
+    engines_.setGimbalAngles(
+        engine, std::clamp(angleX, -maxGimbalAngle_, maxGimbalAngle_),
+        std::clamp(angleY, -maxGimbalAngle_, maxGimbalAngle_));
+  }
+
+  // True while at least one engine is lit and there is fuel left to burn
+  bool isPowered() const { return totalFuelMass_ > 0 && engines_.anyLit(); }
 
   double getRemainingFuelRatio() const {
     return totalFuelMass_ / initialFuelMass_;
   }
 
-  void startEngines() {
-    for (auto &engine : engines_) {
-      engine->start();
-    }
-  }
+  const EngineCluster &getEngines() const { return engines_; }
+  const Vec3 &getThrustDirection() const { return thrustDirection_; }
 
-  void shutdownAllEngines() {
-    for (auto &engine : engines_) {
-      engine->shutdown();
-    }
-  }
+  void startEngines() { engines_.start(); }
 
-  void setThrottle(double throttle) {
-    for (auto &engine : engines_) {
-      engine->setThrottle(throttle);
-    }
-  }
+  void shutdownAllEngines() { engines_.shutdown(); }
+
+  void setThrottle(double throttle) { engines_.setThrottle(throttle); }
 
   void updateThrustDirection(const Vec3 &position) {
     // Point thrust in the direction away from Earth's center
     thrustDirection_ = position.normalize();
   }
-
-private:
-  Vec3 applyGimbal(Vec3 &baseDirection) const {
-    double cx = std::cos(gimbalAngleX_);
-    double sx = std::sin(gimbalAngleX_);
-    double cy = std::cos(gimbalAngleY_);
-    double sy = std::sin(gimbalAngleY_);
-    double x = baseDirection.x() * cy + baseDirection.z() * sy;
-    double y = baseDirection.y() * cx -
-               (baseDirection.x() * sy - baseDirection.z() * cy) * sx;
-    double z = baseDirection.y() * sx +
-               (baseDirection.x() * sy - baseDirection.z() * cy) * cx;
-    return Vec3(x, y, z).normalize();
-  }
 };
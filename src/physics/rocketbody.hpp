@@ -1,4 +1,5 @@
 #pragma once
+#include "../math/scalar.hpp"
 #include "../math/vec3.hpp"
 #include <algorithm>
 #include <stdexcept>
@@ -59,16 +60,21 @@ public:
   }
 
   void updateAeroCoefficients(double machNumber, double angleOfAttack) {
-    // Simple subsonic-transonic-supersonic drag model
-    if (machNumber < 0.8)
-      dragCoefficient_ = 0.2;
-    else if (machNumber < 1.2)
-      dragCoefficient_ = 0.2 + 0.6 * (machNumber - 0.8);
-    else
-      dragCoefficient_ = 0.4;
+    dragCoefficient_ = dragCoefficientAt(machNumber);
+    liftCoefficient_ = liftCoefficientAt(angleOfAttack);
+  }
+
+  // Simple subsonic-transonic-supersonic drag model
+  template <class T> static T dragCoefficientAt(const T &machNumber) {
+    return Scalar::select(
+        machNumber < T(0.8), T(0.2),
+        Scalar::select(machNumber < T(1.2), T(0.2 + 0.6 * (machNumber - 0.8)),
+                       T(0.4)));
+  }
 
-    // Simple lift model based on angle of attack
-    liftCoefficient_ = 0.1 * std::sin(2 * angleOfAttack);
+  // Simple lift model based on angle of attack
+  template <class T> static T liftCoefficientAt(const T &angleOfAttack) {
+    return 0.1 * Scalar::sin(2 * angleOfAttack);
   }
 
   // Calculate center of mass based on fuel level
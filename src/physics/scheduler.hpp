@@ -0,0 +1,91 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Simulation time kept as a whole number of fixed steps. Times are derived
+// as tick * step rather than summed, so they never drift and periodic
+// events land on exact ticks.
+class SimulationClock {
+private:
+  std::uint64_t tick_;
+  double step_; // s
+
+public:
+  explicit SimulationClock(double step) : tick_(0), step_(step) {
+    if (!(step > 0.0))
+      throw std::invalid_argument("Time step must be positive");
+  }
+
+  void advance() { ++tick_; }
+  std::uint64_t tick() const { return tick_; }
+  double step() const { return step_; }
+  double time() const { return static_cast<double>(tick_) * step_; }
+
+  // An interval (s) as a tick count; it must be a whole number of steps
+  std::uint64_t ticksFor(double seconds) const {
+    double ticks = std::round(seconds / step_);
+    if (ticks < 1.0 ||
+        std::abs(ticks * step_ - seconds) > 1e-9 * std::max(seconds, 1.0))
+      throw std::invalid_argument(
+          "Interval is not a whole number of time steps");
+    return static_cast<std::uint64_t>(ticks);
+  }
+};
+
+// Runs tasks (logging, guidance, sensor sampling, progress reports) at
+// fixed multiples of the clock tick. When nothing is due, dispatch() is a
+// single compare against the earliest due tick. Tasks due on the same tick
+// run in the order they were added; a task must not add tasks.
+class TaskScheduler {
+public:
+  using Callback = std::function<void(std::uint64_t tick)>;
+
+private:
+  struct Task {
+    std::string name;
+    std::uint64_t period; // Ticks
+    std::uint64_t next;   // Tick of the next run
+    Callback run;
+  };
+  std::vector<Task> tasks_;
+  std::uint64_t nextDue_ = std::numeric_limits<std::uint64_t>::max();
+
+  void runDue(std::uint64_t tick) {
+    nextDue_ = std::numeric_limits<std::uint64_t>::max();
+    for (auto &task : tasks_) {
+      if (task.next <= tick) {
+        task.run(tick);
+        // Skip periods missed while the clock jumped ahead
+        task.next += task.period * ((tick - task.next) / task.period + 1);
+      }
+      nextDue_ = std::min(nextDue_, task.next);
+    }
+  }
+
+public:
+  // Run every period ticks, the first time at tick phase
+  void add(std::string name, std::uint64_t period, Callback run,
+           std::uint64_t phase = 0) {
+    if (period == 0)
+      throw std::invalid_argument("Task period must be at least one tick");
+    tasks_.push_back({std::move(name), period, phase, std::move(run)});
+    nextDue_ = std::min(nextDue_, phase);
+  }
+
+  void dispatch(std::uint64_t tick) {
+    if (tick >= nextDue_)
+      runDue(tick);
+  }
+
+  std::size_t size() const { return tasks_.size(); }
+  const std::string &name(std::size_t i) const { return tasks_[i].name; }
+  std::uint64_t period(std::size_t i) const { return tasks_[i].period; }
+};
@@ -1,103 +1,219 @@
 #pragma once
-#include "aerodynamics.hpp"
-#include "gravity.hpp"
+#include "flightregime.hpp"
+#include "forcemodels.hpp"
 #include "integrator.hpp"
 #include "propulsionsystem.hpp"
 #include "rocketbody.hpp"
+#include "scheduler.hpp"
 #include "state.hpp"
+#include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <type_traits>
+
+// Perturbations of the configured vehicle. The nominal values leave the
+// run unchanged; seeded as Dual variables they give the trajectory's
+// derivatives with respect to each in the same pass.
+template <class T> struct FlightParameters {
+  T thrustScale = 1.0; // Multiplies delivered thrust, propellant flow unchanged
+  T dragScale = 1.0;   // Multiplies the drag coefficient
+  T massOffset = 0.0;  // Added to the vehicle mass (kg)
+};
+
+// Pipeline is a ForcePipeline<...> (fused at compile time) or a
+// DynamicForcePipeline (assembled from the config at run time). T is the
+// state's scalar type: double, or Dual<double, N> for forward-mode
+// sensitivities, which needs a ForcePipeline. Regime, fuel and aero table
+// bookkeeping run on the value part. F is the fidelity level whose
+// atmosphere the engine reads; it should match the pipeline's.
+template <class Pipeline, class T = double, class F = StandardFidelity>
+class BasicSimulationEngine {
+public:
+  using Fidelity = F;
 
-class SimulationEngine {
 private:
-  State state_;
+  BasicState<T> state_;
   RocketBody rocket_;
   PropulsionSystem propulsion_;
+  Pipeline forces_;
   double timeStep_;
-  double totalTime_;
+  SimulationClock clock_;
+  RegimeDetector regimeDetector_;
+  FlightRegime regime_;
+  RegimeReport regimeReport_;
+  FlightParameters<T> parameters_;
+  std::ostream *forceReport_ = nullptr; // Set for one step on request
+
+  // The cluster thrust depends only on the engine settings and the ambient
+  // pressure, so it is evaluated once per step rather than per RK4 stage.
+  BasicVec3<T> stepThrust(double pressure) const {
+    Vec3 thrust = propulsion_.getThrust(pressure);
+    BasicVec3<T> result(thrust);
+    if constexpr (!std::is_arithmetic_v<T>) {
+      // Dependencies the double run treats as constants over the step: the
+      // thrust direction follows the start position, and nozzle thrust the
+      // ambient pressure at the start altitude. Both differences are zero in
+      // value and carry the derivatives. Thrust is piecewise linear in
+      // pressure, so a one-sided difference gives its slope.
+      constexpr double PRESSURE_STEP = 1.0; // Pa
+      T altitude = state_.position.magnitude() - Constants::EARTH_RADIUS;
+      Vec3 slope = (propulsion_.getThrust(pressure + PRESSURE_STEP) - thrust) /
+                   PRESSURE_STEP;
+      BasicVec3<T> turn = state_.position.normalize() -
+                          BasicVec3<T>(propulsion_.getThrustDirection());
+      result = result + turn * T(thrust.magnitude()) +
+               BasicVec3<T>(slope) * (Fidelity::pressure(altitude) - pressure);
+    }
+    return result * parameters_.thrustScale;
+  }
+
+  // Instantiated per regime so the pipeline inlines only the force models
+  // that apply; skipped models cost nothing inside the RK4 stages.
+  template <FlightRegime Regime> void integrate(double pressure) {
+    BasicForceContext<T> ctx{rocket_, propulsion_, pressure, BasicVec3<T>(),
+                             parameters_.dragScale};
+    if constexpr (hasThrust(Regime))
+      ctx.thrust = stepThrust(pressure);
+
+    if (forceReport_) {
+      std::ostream &out = *forceReport_;
+      out << "Forces (N):";
+      forces_.template forEachForce<Regime>(
+          state_, ctx, [&out](const char *name, const auto &force) {
+            out << "\n" << name << ": " << Scalar::value(force.magnitude());
+          });
+      out << std::endl;
+    }
+
+    state_ = Integrator::integrateRK4(
+        state_,
+        [this, &ctx](const BasicState<T> &s) {
+          return forces_.template evaluate<Regime>(s, ctx) / s.mass;
+        },
+        timeStep_);
+  }
 
 public:
   // Modified constructor to take PropulsionSystem by rvalue reference
-  SimulationEngine(const State &initialState, const RocketBody &rocket,
-                   PropulsionSystem &&propulsion, double dt = 0.01)
+  BasicSimulationEngine(const BasicState<T> &initialState,
+                        const RocketBody &rocket, PropulsionSystem &&propulsion,
+                        double dt = 0.01, Pipeline forces = Pipeline(),
+                        const FlightParameters<T> &parameters = {})
       : state_(initialState), rocket_(rocket),
         propulsion_(std::move(propulsion)) // Use std::move here
         ,
-        timeStep_(dt), totalTime_(0.0) {}
+        forces_(std::move(forces)), timeStep_(dt), clock_(dt),
+        regimeDetector_(valueOf(initialState.position).magnitude() -
+                        Constants::EARTH_RADIUS),
+        regime_(FlightRegime::OnPad), parameters_(parameters) {
+    state_.mass = state_.mass + parameters_.massOffset;
+    propulsion_.setTimeStep(dt);
+  }
 
   // Delete copy constructor and assignment operator
-  SimulationEngine(const SimulationEngine &) = delete;
-  SimulationEngine &operator=(const SimulationEngine &) = delete;
+  BasicSimulationEngine(const BasicSimulationEngine &) = delete;
+  BasicSimulationEngine &operator=(const BasicSimulationEngine &) = delete;
 
   // Add move constructor and assignment operator
-  SimulationEngine(SimulationEngine &&other) noexcept
+  BasicSimulationEngine(BasicSimulationEngine &&other) noexcept
       : state_(std::move(other.state_)), rocket_(std::move(other.rocket_)),
-        propulsion_(std::move(other.propulsion_)), timeStep_(other.timeStep_),
-        totalTime_(other.totalTime_) {}
+        propulsion_(std::move(other.propulsion_)),
+        forces_(std::move(other.forces_)), timeStep_(other.timeStep_),
+        clock_(other.clock_), regimeDetector_(other.regimeDetector_),
+        regime_(other.regime_), regimeReport_(other.regimeReport_),
+        parameters_(std::move(other.parameters_)),
+        forceReport_(other.forceReport_) {}
 
-  SimulationEngine &operator=(SimulationEngine &&other) noexcept {
+  BasicSimulationEngine &operator=(BasicSimulationEngine &&other) noexcept {
     if (this != &other) {
       state_ = std::move(other.state_);
       rocket_ = std::move(other.rocket_);
       propulsion_ = std::move(other.propulsion_);
+      forces_ = std::move(other.forces_);
       timeStep_ = other.timeStep_;
-      totalTime_ = other.totalTime_;
+      clock_ = other.clock_;
+      regimeDetector_ = other.regimeDetector_;
+      regime_ = other.regime_;
+      regimeReport_ = other.regimeReport_;
+      parameters_ = std::move(other.parameters_);
+      forceReport_ = other.forceReport_;
     }
     return *this;
   }
 
   void step() {
-    double altitude = state_.position.magnitude() - Constants::EARTH_RADIUS;
-    double pressure = Atmosphere::getPressure(altitude);
-
-    // Update thrust direction to point away from Earth
-    propulsion_.updateThrustDirection(state_.position);
-
-    auto calculateAcceleration = [this, pressure](const State &s) {
-      // Calculate gravitational force (points towards Earth's center)
-      Vec3 gravityForce = Gravity::getAcceleration(s.position) * s.mass;
-
-      // Calculate aerodynamic forces
-      Vec3 aeroForce = Aerodynamics::calculateForces(s, rocket_);
+    auto wallStart = std::chrono::steady_clock::now();
 
-      // Get thrust force (should point away from Earth)
-      Vec3 thrustForce = propulsion_.updateThrust(pressure, timeStep_);
+    const Vec3 &position = valueOf(state_.position);
+    double altitude = position.magnitude() - Constants::EARTH_RADIUS;
+    double pressure = Fidelity::pressure(altitude);
+    regime_ = regimeDetector_.classify(
+        altitude, Fidelity::density(altitude),
+        valueOf(state_.velocity).magnitude(), propulsion_.isPowered());
 
-      // Debug output
-      if (std::fmod(totalTime_, 1.0) < timeStep_) {
-        std::cout << "Forces (N):"
-                  << "\nGravity: " << gravityForce.magnitude()
-                  << "\nThrust: " << thrustForce.magnitude()
-                  << "\nAero: " << aeroForce.magnitude() << std::endl;
-      }
+    // Update thrust direction to point away from Earth
+    propulsion_.updateThrustDirection(position);
 
-      // Calculate total acceleration
-      Vec3 totalForce = gravityForce + aeroForce + thrustForce;
-      return totalForce / s.mass;
-    };
+    // Update state using RK4 integration; the pad holds the vehicle in place
+    switch (regime_) {
+    case FlightRegime::OnPad:
+      state_.acceleration = BasicVec3<T>();
+      break;
+    case FlightRegime::PoweredAtmospheric:
+      integrate<FlightRegime::PoweredAtmospheric>(pressure);
+      break;
+    case FlightRegime::PoweredVacuum:
+      integrate<FlightRegime::PoweredVacuum>(pressure);
+      break;
+    case FlightRegime::CoastAtmospheric:
+      integrate<FlightRegime::CoastAtmospheric>(pressure);
+      break;
+    default:
+      integrate<FlightRegime::CoastVacuum>(pressure);
+      break;
+    }
+    clock_.advance();
+    state_.time = clock_.time();
+    forceReport_ = nullptr;
 
-    // Update state using RK4 integration
-    state_ = Integrator::integrateRK4(state_, calculateAcceleration, timeStep_);
-    totalTime_ += timeStep_;
+    // Burn fuel once per step, not once per force evaluation
+    if (hasThrust(regime_))
+      propulsion_.consumeFuel(timeStep_);
 
     // Update rocket mass based on remaining fuel
     double fuelRatio = propulsion_.getRemainingFuelRatio();
     rocket_.updateMass(fuelRatio);
-    state_.mass = rocket_.getMass();
+    state_.mass = rocket_.getMass() + parameters_.massOffset;
 
     // Update center of mass and aerodynamic properties
     rocket_.updateCenterOfMass();
-    double velocity = state_.velocity.magnitude();
+    double velocity = valueOf(state_.velocity).magnitude();
     if (velocity > 0) {
       double machNumber = velocity / 340.0; // Approximate speed of sound
       double angleOfAttack = 0.0; // We could calculate this properly if needed
       rocket_.updateAeroCoefficients(machNumber, angleOfAttack);
     }
+
+    std::chrono::duration<double> wallTime =
+        std::chrono::steady_clock::now() - wallStart;
+    regimeReport_.record(regime_, timeStep_, wallTime.count());
   }
   void startEngines() { propulsion_.startEngines(); }
   void setThrottle(double throttle) { propulsion_.setThrottle(throttle); }
-  const State &getState() const { return state_; }
-  double getTime() const { return totalTime_; }
+  const BasicState<T> &getState() const { return state_; }
+  double getTime() const { return clock_.time(); }
+  std::uint64_t getTick() const { return clock_.tick(); }
+  const SimulationClock &getClock() const { return clock_; }
+  // Print the force breakdown during the next integrated step
+  void requestForceReport(std::ostream &out) { forceReport_ = &out; }
   double getRemainingFuelRatio() const {
     return propulsion_.getRemainingFuelRatio();
   }
+  FlightRegime getRegime() const { return regime_; }
+  const RegimeReport &getRegimeReport() const { return regimeReport_; }
+  void setVacuumDensityThreshold(double threshold) {
+    regimeDetector_.setVacuumDensityThreshold(threshold);
+  }
 };
+
+using SimulationEngine = BasicSimulationEngine<DefaultForcePipeline>;
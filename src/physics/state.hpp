@@ -1,12 +1,27 @@
 #pragma once
 #include "../math/vec3.hpp"
 
-struct State {
-  Vec3 position, velocity, acceleration;
-  double mass, time;
+template <class T> struct BasicState {
+  BasicVec3<T> position, velocity, acceleration;
+  T mass, time;
 
-  State() : position(), velocity(), acceleration(), mass(0.0), time(0.0) {}
-  State(const Vec3 &pos, const Vec3 &vel, const Vec3 &acc, const double &m,
-        const double &t)
+  BasicState()
+      : position(), velocity(), acceleration(), mass(0.0), time(0.0) {}
+  BasicState(const BasicVec3<T> &pos, const BasicVec3<T> &vel,
+             const BasicVec3<T> &acc, const T &m, const T &t)
       : position(pos), velocity(vel), acceleration(acc), mass(m), time(t) {}
+  // From a state of another scalar type, e.g. to seed a Dual run
+  template <class U>
+  explicit BasicState(const BasicState<U> &s)
+      : position(s.position), velocity(s.velocity),
+        acceleration(s.acceleration), mass(s.mass), time(s.time) {}
 };
+
+using State = BasicState<double>;
+
+template <class T> State valueOf(const BasicState<T> &s) {
+  return State(valueOf(s.position), valueOf(s.velocity),
+               valueOf(s.acceleration), Scalar::value(s.mass),
+               Scalar::value(s.time));
+}
+inline const State &valueOf(const State &s) { return s; }
@@ -0,0 +1,173 @@
+#pragma once
+#include "../math/table1d.hpp"
+#include "constants.hpp"
+#include <cstddef>
+#include <fstream>
+#include <istream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Measured thrust versus time since ignition. Propellant is drawn in
+// proportion to delivered impulse, so integrating the flow over any interval
+// gives exactly propellantMass * impulse(interval) / totalImpulse.
+class ThrustCurve {
+private:
+  Table1D thrust_;              // N vs s since ignition
+  std::vector<double> impulse_; // Cumulative impulse at each breakpoint (N·s)
+  double propellantMass_;       // kg
+
+public:
+  ThrustCurve(Table1D thrust, double propellantMass)
+      : thrust_(std::move(thrust)), propellantMass_(propellantMass) {
+    impulse_.resize(thrust_.size(), 0.0);
+    for (std::size_t i = 1; i < thrust_.size(); ++i) {
+      impulse_[i] = impulse_[i - 1] + 0.5 * (thrust_.y(i) + thrust_.y(i - 1)) *
+                                          (thrust_.x(i) - thrust_.x(i - 1));
+    }
+    if (impulse_.back() <= 0)
+      throw std::invalid_argument("Thrust curve delivers no impulse");
+    if (propellantMass_ <= 0)
+      throw std::invalid_argument("Propellant mass must be positive");
+  }
+
+  double getBurnTime() const { return thrust_.back(); }
+  double getTotalImpulse() const { return impulse_.back(); }
+  double getPropellantMass() const { return propellantMass_; }
+
+  // Thrust (N) at t seconds after ignition, zero after burnout
+  double getThrust(double t, std::size_t &cursor) const {
+    if (t >= thrust_.back())
+      return 0.0;
+    return thrust_.lookup(t, cursor);
+  }
+
+  // Impulse (N·s) delivered between ignition and t
+  double getImpulse(double t, std::size_t &cursor) const {
+    if (t <= thrust_.front())
+      return 0.0;
+    if (t >= thrust_.back())
+      return impulse_.back();
+    cursor = thrust_.seek(t, cursor);
+    return impulse_[cursor] + 0.5 *
+                                  (thrust_.y(cursor) +
+                                   thrust_.interpolate(t, cursor)) *
+                                  (t - thrust_.x(cursor));
+  }
+
+  // Propellant flow (kg/s) matching getThrust
+  double getMassFlow(double t, std::size_t &cursor) const {
+    return propellantMass_ * getThrust(t, cursor) / impulse_.back();
+  }
+
+  // RASP .eng: ';' comments, a header line
+  // "name diameter length delays propellantMass totalMass maker",
+  // then "time thrust" rows
+  static ThrustCurve fromRasp(std::istream &in) {
+    std::vector<double> t{0.0}, f{0.0};
+    double propellantMass = 0.0;
+    bool haveHeader = false;
+    std::string line;
+    while (std::getline(in, line)) {
+      std::size_t comment = line.find(';');
+      if (comment != std::string::npos)
+        line.erase(comment);
+      std::istringstream row(line);
+      if (!haveHeader) {
+        std::string name, delays;
+        double diameter, length, totalMass;
+        if (row >> name >> diameter >> length >> delays >> propellantMass >>
+            totalMass)
+          haveHeader = true;
+        continue;
+      }
+      double time, thrust;
+      if (row >> time >> thrust) {
+        if (time <= t.back())
+          continue; // The implicit (0, 0) start point is already present
+        t.push_back(time);
+        f.push_back(thrust);
+      }
+    }
+    if (!haveHeader)
+      throw std::runtime_error("RASP file has no header line");
+    return ThrustCurve(Table1D(std::move(t), std::move(f)), propellantMass);
+  }
+
+  // Time/thrust CSV. The file has no propellant mass, so it is either given
+  // or derived from the total impulse at the engine's rated Isp.
+  static ThrustCurve fromCsv(std::istream &in, double propellantMass,
+                             double specificImpulse = 0.0) {
+    ThrustCurve curve(Table1D::fromCsv(in), 1.0);
+    if (propellantMass > 0)
+      curve.propellantMass_ = propellantMass;
+    else if (specificImpulse > 0)
+      curve.propellantMass_ = curve.getTotalImpulse() /
+                              (specificImpulse * Constants::STANDARD_GRAVITY);
+    else
+      throw std::invalid_argument(
+          "CSV thrust curve needs a propellant mass or specific impulse");
+    return curve;
+  }
+};
+
+// Loads tables once per file and hands out read-only shared copies, so every
+// PropulsionSystem built from the same config (e.g. ensemble members) uses
+// the same table memory. Cursors live with each engine, not in the tables.
+class CurveLibrary {
+private:
+  std::map<std::tuple<std::string, double, double>,
+           std::shared_ptr<const ThrustCurve>>
+      thrustCurves_;
+  std::map<std::string, std::shared_ptr<const Table1D>> ispTables_;
+
+  static std::ifstream open(const std::string &path) {
+    std::ifstream file(path);
+    if (!file)
+      throw std::runtime_error("Cannot open table file: " + path);
+    return file;
+  }
+
+  static bool hasExtension(const std::string &path, const std::string &ext) {
+    return path.size() >= ext.size() &&
+           path.compare(path.size() - ext.size(), ext.size(), ext) == 0;
+  }
+
+public:
+  // ".eng" files are read as RASP, anything else as time/thrust CSV.
+  // propellantMass and specificImpulse are only used for CSV curves.
+  std::shared_ptr<const ThrustCurve>
+  thrustCurve(const std::string &path, double propellantMass = 0.0,
+              double specificImpulse = 0.0) {
+    bool rasp = hasExtension(path, ".eng");
+    auto key = rasp ? std::make_tuple(path, 0.0, 0.0)
+                    : std::make_tuple(path, propellantMass, specificImpulse);
+    auto found = thrustCurves_.find(key);
+    if (found != thrustCurves_.end())
+      return found->second;
+
+    std::ifstream file = open(path);
+    auto curve = std::make_shared<const ThrustCurve>(
+        rasp ? ThrustCurve::fromRasp(file)
+             : ThrustCurve::fromCsv(file, propellantMass, specificImpulse));
+    thrustCurves_.emplace(key, curve);
+    return curve;
+  }
+
+  // Pressure (Pa) / specific impulse (s) CSV
+  std::shared_ptr<const Table1D> ispTable(const std::string &path) {
+    auto found = ispTables_.find(path);
+    if (found != ispTables_.end())
+      return found->second;
+
+    std::ifstream file = open(path);
+    auto table = std::make_shared<const Table1D>(Table1D::fromCsv(file));
+    ispTables_.emplace(path, table);
+    return table;
+  }
+};
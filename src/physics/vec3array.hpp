@@ -0,0 +1,147 @@
+#pragma once
+#include "../math/vec3.hpp"
+#include "batchkernels.hpp"
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+// Allocator for vectors whose data must start on an Alignment-byte boundary
+template <class T, std::size_t Alignment> struct AlignedAllocator {
+  using value_type = T;
+  template <class U> struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() = default;
+  template <class U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+  T *allocate(std::size_t n) {
+    // aligned_alloc wants the size to be a multiple of the alignment
+    std::size_t bytes =
+        (n * sizeof(T) + Alignment - 1) / Alignment * Alignment;
+    void *p = std::aligned_alloc(Alignment, bytes);
+    if (!p)
+      throw std::bad_alloc();
+    return static_cast<T *>(p);
+  }
+  void deallocate(T *p, std::size_t) noexcept { std::free(p); }
+
+  template <class U>
+  bool operator==(const AlignedAllocator<U, Alignment> &) const noexcept {
+    return true;
+  }
+  template <class U>
+  bool operator!=(const AlignedAllocator<U, Alignment> &) const noexcept {
+    return false;
+  }
+};
+
+// Structure-of-arrays vectors for batched callers (ensembles, debris
+// clouds, trajectory post-processing). Each component is its own
+// cache-line-aligned column, so the geometry runs through the BatchKernels
+// of the CPU's widest instruction set, one full register of vectors at a
+// time. Results are written to caller-owned arrays so large batches need no
+// per-call allocation.
+class Vec3Array {
+public:
+  static constexpr std::size_t ALIGNMENT = 64; // Bytes, one cache line
+
+private:
+  using Column = std::vector<double, AlignedAllocator<double, ALIGNMENT>>;
+  Column x_, y_, z_;
+
+public:
+  Vec3Array() = default;
+  explicit Vec3Array(std::size_t n) : x_(n), y_(n), z_(n) {}
+  // From a span of count Vec3s
+  Vec3Array(const Vec3 *vectors, std::size_t count)
+      : x_(count), y_(count), z_(count) {
+    for (std::size_t i = 0; i < count; ++i)
+      set(i, vectors[i]);
+  }
+
+  std::size_t size() const { return x_.size(); }
+  bool empty() const { return x_.empty(); }
+  void resize(std::size_t n) {
+    x_.resize(n);
+    y_.resize(n);
+    z_.resize(n);
+  }
+  void reserve(std::size_t n) {
+    x_.reserve(n);
+    y_.reserve(n);
+    z_.reserve(n);
+  }
+  void push_back(const Vec3 &v) {
+    x_.push_back(v.x());
+    y_.push_back(v.y());
+    z_.push_back(v.z());
+  }
+
+  Vec3 operator[](std::size_t i) const { return Vec3(x_[i], y_[i], z_[i]); }
+  void set(std::size_t i, const Vec3 &v) {
+    x_[i] = v.x();
+    y_[i] = v.y();
+    z_[i] = v.z();
+  }
+
+  // Component columns
+  const double *x() const { return x_.data(); }
+  const double *y() const { return y_.data(); }
+  const double *z() const { return z_.data(); }
+  double *x() { return x_.data(); }
+  double *y() { return y_.data(); }
+  double *z() { return z_.data(); }
+
+  // To a span of size() Vec3s
+  void copyTo(Vec3 *vectors) const {
+    for (std::size_t i = 0; i < size(); ++i)
+      vectors[i] = (*this)[i];
+  }
+  std::vector<Vec3> toVec3s() const {
+    std::vector<Vec3> vectors(size());
+    copyTo(vectors.data());
+    return vectors;
+  }
+
+  // The kernels below write size() results to out
+  void magnitude(double *out) const {
+    BatchKernels::active().magnitude(x(), y(), z(), out, size());
+  }
+  // Height above the spherical Earth, for positions (m)
+  void altitude(double *out) const {
+    BatchKernels::active().altitude(x(), y(), z(), out, size());
+  }
+  void dot(const Vec3Array &other, double *out) const {
+    requireSameSize(other);
+    BatchKernels::active().dot(x(), y(), z(), other.x(), other.y(), other.z(),
+                               out, size());
+  }
+
+  // Unit vectors in place; zero vectors stay zero
+  void normalize() {
+    BatchKernels::active().normalize(x(), y(), z(), x(), y(), z(), size());
+  }
+  Vec3Array normalized() const {
+    Vec3Array r(size());
+    BatchKernels::active().normalize(x(), y(), z(), r.x(), r.y(), r.z(),
+                                     size());
+    return r;
+  }
+  Vec3Array cross(const Vec3Array &other) const {
+    requireSameSize(other);
+    Vec3Array r(size());
+    BatchKernels::active().cross(x(), y(), z(), other.x(), other.y(),
+                                 other.z(), r.x(), r.y(), r.z(), size());
+    return r;
+  }
+
+private:
+  void requireSameSize(const Vec3Array &other) const {
+    if (other.size() != size())
+      throw std::invalid_argument("Vec3Array sizes differ");
+  }
+};
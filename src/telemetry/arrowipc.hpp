@@ -0,0 +1,344 @@
+#pragma once
+#include "bufferedfile.hpp"
+#include "columnblock.hpp"
+#include "flatbuffer.hpp"
+#include "telemetrysink.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Apache Arrow IPC file format (Feather v2), as read by pyarrow, pandas
+// (read_feather), Polars and DuckDB. Metadata is FlatBuffers (Schema.fbs,
+// Message.fbs and File.fbs of the Arrow format, version 5):
+//
+//   "ARROW1\0\0", schema message, dictionary batches, record batches,
+//   end-of-stream marker, footer, i32 footer bytes, "ARROW1"
+//
+// A message is 0xFFFFFFFF, an i32 metadata length, the Message flatbuffer
+// and then its body. Body buffers start on BUFFER_ALIGNMENT, so a reader
+// that memory-maps the file uses the column data in place.
+namespace ArrowIpc {
+constexpr char MAGIC[] = "ARROW1";
+constexpr std::size_t BUFFER_ALIGNMENT = 64;
+constexpr std::int16_t METADATA_V5 = 4;
+
+// MessageHeader and Type union tags
+constexpr std::uint8_t SCHEMA = 1;
+constexpr std::uint8_t DICTIONARY_BATCH = 2;
+constexpr std::uint8_t RECORD_BATCH = 3;
+constexpr std::uint8_t TYPE_INT = 2;
+constexpr std::uint8_t TYPE_FLOATING_POINT = 3;
+constexpr std::uint8_t TYPE_UTF8 = 5;
+constexpr std::uint8_t TYPE_BOOL = 6;
+constexpr std::int16_t DOUBLE_PRECISION = 2;
+
+// A message body being assembled: the buffers and the structs that
+// describe them
+class Body {
+private:
+  std::string data_;
+  std::string nodes_;   // FieldNode structs
+  std::string buffers_; // Buffer structs
+  std::size_t nodeCount_ = 0;
+  std::size_t bufferCount_ = 0;
+
+  template <class T> static void put(std::string &out, T value) {
+    out.append(reinterpret_cast<const char *>(&value), sizeof value);
+  }
+
+public:
+  void node(std::int64_t length) {
+    put(nodes_, length);
+    put(nodes_, std::int64_t(0)); // Null count
+    ++nodeCount_;
+  }
+  // Append a buffer; n == 0 is an absent validity bitmap
+  void buffer(const void *bytes, std::size_t n) {
+    put(buffers_, static_cast<std::int64_t>(data_.size()));
+    put(buffers_, static_cast<std::int64_t>(n));
+    ++bufferCount_;
+    data_.append(static_cast<const char *>(bytes), n);
+    data_.append((BUFFER_ALIGNMENT - n % BUFFER_ALIGNMENT) % BUFFER_ALIGNMENT,
+                 '\0');
+  }
+  void empty() { buffer(nullptr, 0); }
+
+  const std::string &data() const { return data_; }
+  // The RecordBatch table for length rows
+  Flatbuffer::Table recordBatch(std::int64_t length) const {
+    Flatbuffer::Table batch;
+    batch.scalar(0, length)
+        .structs(1, nodes_, nodeCount_, 8)
+        .structs(2, buffers_, bufferCount_, 8);
+    return batch;
+  }
+};
+
+inline Flatbuffer::Table intType(std::int32_t bits, bool isSigned) {
+  Flatbuffer::Table type;
+  type.scalar(0, bits).scalar(1, static_cast<std::uint8_t>(isSigned));
+  return type;
+}
+
+// A Field table for a telemetry column; Category columns are dictionary
+// id `dictionary` with int32 indices
+inline Flatbuffer::Table field(const TelemetryColumn &column,
+                               std::int64_t dictionary) {
+  Flatbuffer::Table f, type;
+  std::uint8_t tag = TYPE_FLOATING_POINT;
+  switch (column.type) {
+  case TelemetryType::Float64:
+    type.scalar(0, DOUBLE_PRECISION);
+    break;
+  case TelemetryType::Int64:
+    tag = TYPE_INT;
+    type = intType(64, true);
+    break;
+  case TelemetryType::Bool:
+    tag = TYPE_BOOL;
+    break;
+  case TelemetryType::Category:
+    tag = TYPE_UTF8;
+    f.table(4, Flatbuffer::Table()
+                   .scalar(0, dictionary)
+                   .table(1, intType(32, true))
+                   .scalar(2, std::uint8_t(0)));
+    break;
+  }
+  f.string(0, column.name)
+      .scalar(1, std::uint8_t(0)) // Not nullable
+      .scalar(2, tag)
+      .table(3, std::move(type))
+      .tables(5, {});
+  if (!column.unit.empty()) {
+    Flatbuffer::Table unit;
+    unit.string(0, "unit").string(1, column.unit);
+    f.tables(6, {std::move(unit)});
+  }
+  return f;
+}
+
+inline Flatbuffer::Table schema(const TelemetrySchema &columns) {
+  std::vector<Flatbuffer::Table> fields;
+  std::int64_t dictionary = 0;
+  for (const auto &column : columns.columns()) {
+    fields.push_back(field(column, dictionary));
+    if (column.type == TelemetryType::Category)
+      ++dictionary;
+  }
+  Flatbuffer::Table s;
+  s.scalar(0, std::int16_t(0)) // Little-endian
+      .tables(1, std::move(fields));
+  if (!columns.metadata().empty()) {
+    std::vector<Flatbuffer::Table> pairs;
+    for (const auto &entry : columns.metadata()) {
+      pairs.emplace_back();
+      pairs.back().string(0, entry.first).string(1, entry.second);
+    }
+    s.tables(2, std::move(pairs)); // custom_metadata
+  }
+  return s;
+}
+
+inline std::string message(std::uint8_t headerType, Flatbuffer::Table header,
+                           std::int64_t bodyBytes) {
+  Flatbuffer::Table m;
+  m.scalar(0, METADATA_V5)
+      .scalar(1, headerType)
+      .table(2, std::move(header))
+      .scalar(3, bodyBytes);
+  return Flatbuffer::Builder().finish(m);
+}
+} // namespace ArrowIpc
+
+// Streams telemetry to an Arrow IPC file, one record batch per batchRows
+// records. Float64 columns are copied as they are, Int64 and Bool columns
+// are converted, and Category columns become int32 indices into a
+// dictionary of their labels, written once after the schema.
+class ArrowFileWriter : public TelemetrySink {
+public:
+  static constexpr std::size_t DEFAULT_BATCH_ROWS = 65536;
+
+private:
+  // File offset and sizes of a message, for the footer
+  struct Block {
+    std::int64_t offset;
+    std::int32_t metadataBytes;
+    std::int32_t padding = 0;
+    std::int64_t bodyBytes;
+  };
+
+  std::string path_;
+  std::size_t batchRows_;
+  std::unique_ptr<BufferedFile> file_;
+  TelemetrySchema schema_;
+  ColumnBlock batch_;
+  std::vector<Block> dictionaries_;
+  std::vector<Block> batches_;
+  std::vector<char> scratch_;
+
+  Block writeMessage(std::uint8_t type, Flatbuffer::Table header,
+                     const std::string &body) {
+    std::string meta = ArrowIpc::message(
+        type, std::move(header), static_cast<std::int64_t>(body.size()));
+    // Pad the metadata so the body, and so every buffer, is aligned
+    std::size_t end = file_->offset() + 8 + meta.size();
+    meta.append((ArrowIpc::BUFFER_ALIGNMENT -
+                 end % ArrowIpc::BUFFER_ALIGNMENT) %
+                    ArrowIpc::BUFFER_ALIGNMENT,
+                '\0');
+    Block block{static_cast<std::int64_t>(file_->offset()),
+                static_cast<std::int32_t>(8 + meta.size()), 0,
+                static_cast<std::int64_t>(body.size())};
+    std::uint32_t prefix[2] = {0xffffffffu,
+                               static_cast<std::uint32_t>(meta.size())};
+    file_->append(prefix, sizeof prefix);
+    file_->append(meta.data(), meta.size());
+    file_->append(body.data(), body.size());
+    return block;
+  }
+
+  void writeDictionary(const TelemetryColumn &column, std::int64_t id) {
+    std::vector<std::int32_t> offsets{0};
+    std::string text;
+    for (const auto &label : column.labels) {
+      text += label;
+      offsets.push_back(static_cast<std::int32_t>(text.size()));
+    }
+    ArrowIpc::Body body;
+    body.node(static_cast<std::int64_t>(column.labels.size()));
+    body.empty();
+    body.buffer(offsets.data(), offsets.size() * sizeof(std::int32_t));
+    body.buffer(text.data(), text.size());
+    Flatbuffer::Table dictionary;
+    dictionary.scalar(0, id)
+        .table(1, body.recordBatch(
+                      static_cast<std::int64_t>(column.labels.size())))
+        .scalar(2, std::uint8_t(0));
+    dictionaries_.push_back(writeMessage(ArrowIpc::DICTIONARY_BATCH,
+                                         std::move(dictionary), body.data()));
+  }
+
+  // Column c of the batch as its Arrow buffer
+  void convert(std::size_t c, ArrowIpc::Body &body) {
+    const TelemetryColumn &column = schema_[c];
+    const double *values = batch_.column(c);
+    std::size_t rows = batch_.size();
+    switch (column.type) {
+    case TelemetryType::Float64:
+      body.buffer(values, rows * sizeof(double));
+      return;
+    case TelemetryType::Int64: {
+      scratch_.resize(rows * sizeof(std::int64_t));
+      std::int64_t *out = reinterpret_cast<std::int64_t *>(scratch_.data());
+      for (std::size_t i = 0; i < rows; ++i)
+        out[i] = std::llround(values[i]);
+      break;
+    }
+    case TelemetryType::Bool:
+      scratch_.assign((rows + 7) / 8, 0);
+      for (std::size_t i = 0; i < rows; ++i) {
+        if (values[i] != 0.0)
+          scratch_[i / 8] |= static_cast<char>(1 << (i % 8));
+      }
+      break;
+    case TelemetryType::Category: {
+      scratch_.resize(rows * sizeof(std::int32_t));
+      std::int32_t *out = reinterpret_cast<std::int32_t *>(scratch_.data());
+      for (std::size_t i = 0; i < rows; ++i) {
+        double index = values[i];
+        if (!(index >= 0 && index < double(column.labels.size())))
+          throw std::runtime_error("No label for " + column.name + " value");
+        out[i] = static_cast<std::int32_t>(index);
+      }
+      break;
+    }
+    }
+    body.buffer(scratch_.data(), scratch_.size());
+  }
+
+  void flushBatch() {
+    std::size_t rows = batch_.size();
+    if (rows == 0)
+      return;
+    batch_.transpose();
+    ArrowIpc::Body body;
+    for (std::size_t c = 0; c < schema_.size(); ++c) {
+      body.node(static_cast<std::int64_t>(rows));
+      body.empty();
+      convert(c, body);
+    }
+    batches_.push_back(
+        writeMessage(ArrowIpc::RECORD_BATCH,
+                     body.recordBatch(static_cast<std::int64_t>(rows)),
+                     body.data()));
+    batch_.clear();
+  }
+
+  static std::string blocks(const std::vector<Block> &list) {
+    return std::string(reinterpret_cast<const char *>(list.data()),
+                       list.size() * sizeof(Block));
+  }
+
+public:
+  explicit ArrowFileWriter(std::string path,
+                           std::size_t batchRows = DEFAULT_BATCH_ROWS)
+      : path_(std::move(path)), batchRows_(batchRows) {
+    if (batchRows_ == 0)
+      throw std::invalid_argument("Arrow batch rows must be positive");
+  }
+  ~ArrowFileWriter() override {
+    try {
+      close();
+    } catch (...) {
+    }
+  }
+
+  void open(const TelemetrySchema &schema) override {
+    static_assert(sizeof(Block) == 24, "Arrow Block struct layout");
+    schema_ = schema;
+    batch_ = ColumnBlock(schema.size(), batchRows_);
+    file_ = std::make_unique<BufferedFile>(path_);
+    file_->append(ArrowIpc::MAGIC, 6);
+    file_->pad(8);
+    writeMessage(ArrowIpc::SCHEMA, ArrowIpc::schema(schema_), {});
+    std::int64_t id = 0;
+    for (const auto &column : schema_.columns()) {
+      if (column.type == TelemetryType::Category)
+        writeDictionary(column, id++);
+    }
+  }
+
+  void write(const double *record) override {
+    batch_.push(record);
+    if (batch_.full())
+      flushBatch();
+  }
+
+  void close() override {
+    if (!file_)
+      return;
+    flushBatch();
+    std::uint32_t endOfStream[2] = {0xffffffffu, 0};
+    file_->append(endOfStream, sizeof endOfStream);
+
+    Flatbuffer::Table footer;
+    footer.scalar(0, ArrowIpc::METADATA_V5)
+        .table(1, ArrowIpc::schema(schema_))
+        .structs(2, blocks(dictionaries_), dictionaries_.size(), 8)
+        .structs(3, blocks(batches_), batches_.size(), 8);
+    std::string bytes = Flatbuffer::Builder().finish(footer);
+    std::int32_t size = static_cast<std::int32_t>(bytes.size());
+    file_->append(bytes.data(), bytes.size());
+    file_->append(&size, sizeof size);
+    file_->append(ArrowIpc::MAGIC, 6);
+    file_->close();
+    file_.reset();
+  }
+};
@@ -0,0 +1,206 @@
+#pragma once
+#include "recordring.hpp"
+#include "telemetrysink.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+// What write() does when the queue is full
+enum class OverflowPolicy {
+  Block, // Wait for the writer thread; nothing is lost
+  Drop,  // Discard the record and count it
+  Count, // Discard and count; the run reports the loss as a warning
+};
+
+inline OverflowPolicy overflowPolicyFromName(const std::string &name) {
+  if (name == "block")
+    return OverflowPolicy::Block;
+  if (name == "drop")
+    return OverflowPolicy::Drop;
+  if (name == "count")
+    return OverflowPolicy::Count;
+  throw std::invalid_argument("Unknown overflow policy: " + name);
+}
+
+// Lets one thread sleep until another signals that it may proceed. The
+// sleeper spins briefly, then blocks on a condition variable; the signaller
+// only checks a flag unless someone is asleep.
+class Wakeup {
+private:
+  static constexpr int SPINS = 64;
+
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::atomic<bool> sleeping_{false};
+
+public:
+  // Return once ready() holds; ready must become true only after a state
+  // change that is followed by signal()
+  template <class Ready> void wait(Ready &&ready) {
+    for (int i = 0; i < SPINS; ++i) {
+      if (ready())
+        return;
+      std::this_thread::yield();
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    sleeping_.store(true, std::memory_order_relaxed);
+    // Pairs with signal(): either ready() sees the change or the signaller
+    // sees sleeping_
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    ready_.wait(lock, ready);
+    sleeping_.store(false, std::memory_order_relaxed);
+  }
+
+  // Call after the state change that makes the waiter's ready() true
+  void signal() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed)) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ready_.notify_one();
+    }
+  }
+};
+
+// Moves another sink's encoding and file I/O onto a background thread.
+// write() copies the record into a RecordRing and returns; the writer
+// thread drains the ring in batches into the wrapped sink. write() must
+// be called from one thread only.
+class AsyncTelemetrySink : public TelemetrySink {
+public:
+  static constexpr std::size_t DEFAULT_CAPACITY = 4096; // Records
+
+private:
+  std::unique_ptr<TelemetrySink> sink_;
+  std::size_t capacity_;
+  OverflowPolicy policy_;
+  std::unique_ptr<RecordRing> ring_;
+  std::thread writer_;
+  std::atomic<bool> closing_{false};
+  std::exception_ptr error_; // From the writer thread, rethrown by close()
+
+  // Statistics. Only one thread writes each counter.
+  std::atomic<std::uint64_t> pushed_{0};
+  std::atomic<std::uint64_t> dropped_{0};
+  std::atomic<std::uint64_t> stalls_{0}; // Writes that had to wait
+  std::atomic<std::uint64_t> written_{0};
+  std::atomic<std::size_t> maxDepth_{0};
+
+  Wakeup queued_; // Writer thread: records queued or closing
+  Wakeup space_;  // Block policy: room in the ring
+
+  void drain() {
+    bool failed = false;
+    for (;;) {
+      bool closing = closing_.load(std::memory_order_acquire);
+      std::size_t n = ring_->consume([&](const double *record) {
+        if (failed)
+          return;
+        try {
+          sink_->write(record);
+        } catch (...) {
+          // Keep draining so a blocked producer cannot hang
+          error_ = std::current_exception();
+          failed = true;
+        }
+      });
+      if (n > 0)
+        space_.signal();
+      written_.fetch_add(failed ? 0 : n, std::memory_order_relaxed);
+      // Each batch is everything queued when the writer looked, so the
+      // peak is sampled here rather than by write() touching the tail
+      if (n > maxDepth_.load(std::memory_order_relaxed))
+        maxDepth_.store(n, std::memory_order_relaxed);
+      if (n == 0) {
+        if (closing)
+          return;
+        queued_.wait([this] {
+          return ring_->size() > 0 ||
+                 closing_.load(std::memory_order_acquire);
+        });
+      }
+    }
+  }
+
+public:
+  explicit AsyncTelemetrySink(std::unique_ptr<TelemetrySink> sink,
+                              std::size_t capacity = DEFAULT_CAPACITY,
+                              OverflowPolicy policy = OverflowPolicy::Block)
+      : sink_(std::move(sink)), capacity_(capacity), policy_(policy) {
+    if (!sink_)
+      throw std::invalid_argument("Async telemetry sink needs a sink");
+  }
+  ~AsyncTelemetrySink() override {
+    try {
+      close();
+    } catch (...) {
+    }
+  }
+
+  void open(const TelemetrySchema &schema) override {
+    sink_->open(schema);
+    ring_ = std::make_unique<RecordRing>(schema.size(), capacity_);
+    writer_ = std::thread([this] { drain(); });
+  }
+
+  void write(const double *record) override {
+    if (!ring_->tryPush(record)) {
+      if (policy_ != OverflowPolicy::Block) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      stalls_.fetch_add(1, std::memory_order_relaxed);
+      space_.wait([&] { return ring_->tryPush(record); });
+    }
+    pushed_.fetch_add(1, std::memory_order_relaxed);
+    queued_.signal();
+  }
+
+  // Drain the queue, stop the writer thread and close the wrapped sink.
+  // After a writer thread failure the sink is still closed, so what was
+  // written stays readable, and then the failure is rethrown.
+  void close() override {
+    if (!writer_.joinable())
+      return;
+    closing_.store(true, std::memory_order_release);
+    queued_.signal();
+    writer_.join();
+    if (!error_) {
+      sink_->close();
+      return;
+    }
+    try {
+      sink_->close();
+    } catch (...) {
+      // The first failure is the one to report
+    }
+    std::rethrow_exception(error_);
+  }
+
+  OverflowPolicy policy() const { return policy_; }
+  std::size_t capacity() const { return ring_ ? ring_->capacity() : 0; }
+  // Records waiting for the writer thread
+  std::size_t queueDepth() const { return ring_ ? ring_->size() : 0; }
+  std::size_t maxQueueDepth() const {
+    return maxDepth_.load(std::memory_order_relaxed);
+  }
+  std::uint64_t pushed() const {
+    return pushed_.load(std::memory_order_relaxed);
+  }
+  std::uint64_t dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+  std::uint64_t stalls() const {
+    return stalls_.load(std::memory_order_relaxed);
+  }
+  std::uint64_t written() const {
+    return written_.load(std::memory_order_relaxed);
+  }
+};
@@ -0,0 +1,337 @@
+#pragma once
+#include "bufferedfile.hpp"
+#include "columnblock.hpp"
+#include "deltacodec.hpp"
+#include "telemetrysink.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Binary columnar telemetry log (.ntl). All fields are little-endian and
+// every block starts on an 8-byte boundary, so columns can be mapped
+// straight into arrays.
+//
+//   header  "NOVATLM1", u32 version, u32 columns, u32 chunk rows,
+//           u32 header bytes, then per column: u8 encoding, u8 reserved,
+//           u16 name length, u16 unit length, name, unit; then (version 2)
+//           u16 metadata entries, per entry: u16 key length, u16 value
+//           length, key, value; padded to 8
+//   chunk   u32 "CHNK", u32 rows, then per column: u64 bytes, data,
+//           padded to 8
+//   footer  u32 "INDX", u32 chunks, u64 rows, then per chunk: u64 file
+//           offset, u64 rows
+//   trailer u64 footer offset, "NOVATLM1"
+namespace BinaryLog {
+constexpr char MAGIC[8] = {'N', 'O', 'V', 'A', 'T', 'L', 'M', '1'};
+constexpr std::uint32_t VERSION = 2; // 1 had no metadata
+constexpr std::uint32_t CHUNK_TAG = 0x4b4e4843; // "CHNK"
+constexpr std::uint32_t INDEX_TAG = 0x58444e49; // "INDX"
+constexpr std::size_t TRAILER_BYTES = 16;
+
+enum class Encoding : std::uint8_t {
+  Raw = 0,   // float64 values
+  Delta = 1, // DeltaCodec, lossless
+};
+
+inline Encoding encodingFromName(const std::string &name) {
+  if (name == "raw")
+    return Encoding::Raw;
+  if (name == "delta")
+    return Encoding::Delta;
+  throw std::invalid_argument("Unknown telemetry encoding: " + name);
+}
+} // namespace BinaryLog
+
+// Buffers a chunk of records, turns it into columns and writes each full
+// chunk with a single append to a BufferedFile
+class BinaryLogWriter : public TelemetrySink {
+public:
+  static constexpr std::size_t DEFAULT_CHUNK_ROWS = 4096;
+
+private:
+  struct ChunkEntry {
+    std::uint64_t offset;
+    std::uint64_t rows;
+  };
+
+  std::string path_;
+  std::size_t chunkRows_;
+  BinaryLog::Encoding defaultEncoding_;
+  std::vector<std::pair<std::string, BinaryLog::Encoding>> overrides_;
+  std::vector<BinaryLog::Encoding> encodings_; // Per column
+  std::vector<std::uint64_t> packed_;         // Scratch for encoded columns
+  std::unique_ptr<BufferedFile> file_;
+  std::size_t columns_ = 0;
+  ColumnBlock chunk_;
+  std::vector<ChunkEntry> index_;
+  std::uint64_t rows_ = 0;
+
+  template <class V> void put(V value) { file_->append(&value, sizeof value); }
+
+  void writeChunk() {
+    std::size_t pending = chunk_.size();
+    chunk_.transpose();
+    index_.push_back({file_->offset(), pending});
+    put(BinaryLog::CHUNK_TAG);
+    put(static_cast<std::uint32_t>(pending));
+    for (std::size_t c = 0; c < columns_; ++c) {
+      const double *values = chunk_.column(c);
+      if (encodings_[c] == BinaryLog::Encoding::Delta) {
+        packed_.clear();
+        DeltaCodec::encode(values, pending, packed_);
+        put(static_cast<std::uint64_t>(packed_.size() * 8));
+        file_->append(packed_.data(), packed_.size() * 8);
+      } else {
+        put(static_cast<std::uint64_t>(pending * sizeof(double)));
+        file_->append(values, pending * sizeof(double));
+      }
+    }
+    rows_ += pending;
+    chunk_.clear();
+  }
+
+public:
+  explicit BinaryLogWriter(
+      std::string path, std::size_t chunkRows = DEFAULT_CHUNK_ROWS,
+      BinaryLog::Encoding encoding = BinaryLog::Encoding::Raw)
+      : path_(std::move(path)), chunkRows_(chunkRows),
+        defaultEncoding_(encoding) {
+    if (chunkRows_ == 0)
+      throw std::invalid_argument("Chunk size must be at least one row");
+  }
+
+  // Encode the named column differently from the rest; before open()
+  void setEncoding(std::string column, BinaryLog::Encoding encoding) {
+    overrides_.emplace_back(std::move(column), encoding);
+  }
+
+  void open(const TelemetrySchema &schema) override {
+    file_ = std::make_unique<BufferedFile>(path_);
+    columns_ = schema.size();
+    chunk_ = ColumnBlock(columns_, chunkRows_);
+    encodings_.assign(columns_, defaultEncoding_);
+    for (const auto &entry : overrides_)
+      encodings_[schema.indexOf(entry.first)] = entry.second;
+
+    std::uint32_t headerBytes = 24 + 2;
+    for (const auto &column : schema.columns())
+      headerBytes += 6 + column.name.size() + column.unit.size();
+    for (const auto &entry : schema.metadata())
+      headerBytes += 4 + entry.first.size() + entry.second.size();
+    headerBytes = (headerBytes + 7) / 8 * 8;
+
+    file_->append(BinaryLog::MAGIC, sizeof BinaryLog::MAGIC);
+    put(BinaryLog::VERSION);
+    put(static_cast<std::uint32_t>(columns_));
+    put(static_cast<std::uint32_t>(chunkRows_));
+    put(headerBytes);
+    for (std::size_t c = 0; c < columns_; ++c) {
+      const TelemetryColumn &column = schema[c];
+      put(static_cast<std::uint8_t>(encodings_[c]));
+      put(std::uint8_t(0));
+      put(static_cast<std::uint16_t>(column.name.size()));
+      put(static_cast<std::uint16_t>(column.unit.size()));
+      file_->append(column.name.data(), column.name.size());
+      file_->append(column.unit.data(), column.unit.size());
+    }
+    put(static_cast<std::uint16_t>(schema.metadata().size()));
+    for (const auto &entry : schema.metadata()) {
+      put(static_cast<std::uint16_t>(entry.first.size()));
+      put(static_cast<std::uint16_t>(entry.second.size()));
+      file_->append(entry.first.data(), entry.first.size());
+      file_->append(entry.second.data(), entry.second.size());
+    }
+    file_->pad(8);
+  }
+
+  void write(const double *record) override {
+    chunk_.push(record);
+    if (chunk_.full())
+      writeChunk();
+  }
+
+  void close() override {
+    if (!file_)
+      return;
+    if (chunk_.size() > 0)
+      writeChunk();
+
+    std::uint64_t footer = file_->offset();
+    put(BinaryLog::INDEX_TAG);
+    put(static_cast<std::uint32_t>(index_.size()));
+    put(rows_);
+    for (const auto &chunk : index_) {
+      put(chunk.offset);
+      put(chunk.rows);
+    }
+    put(footer);
+    file_->append(BinaryLog::MAGIC, sizeof BinaryLog::MAGIC);
+    file_->close();
+    file_.reset();
+  }
+};
+
+// Memory-maps a .ntl file and decodes whole columns on request
+class BinaryLogReader {
+private:
+  struct Chunk {
+    std::uint64_t offset;
+    std::uint64_t rows;
+  };
+
+  MappedFile file_;
+  TelemetrySchema schema_;
+  std::vector<BinaryLog::Encoding> encodings_;
+  std::vector<Chunk> chunks_;
+  std::uint64_t rows_ = 0;
+
+  [[noreturn]] static void corrupt(const char *what) {
+    throw std::runtime_error(std::string("Corrupt telemetry log: ") + what);
+  }
+
+  void require(std::uint64_t offset, std::uint64_t bytes) const {
+    if (offset > file_.size() || bytes > file_.size() - offset)
+      corrupt("truncated");
+  }
+  template <class V> V get(std::uint64_t offset) const {
+    require(offset, sizeof(V));
+    V value;
+    std::memcpy(&value, file_.data() + offset, sizeof value);
+    return value;
+  }
+
+  // The offset of a column block's u64 size, following the block at at;
+  // throws if the block runs past end
+  std::uint64_t nextBlock(std::uint64_t at, std::uint64_t end) const {
+    std::uint64_t bytes = get<std::uint64_t>(at);
+    std::uint64_t padded = bytes / 8 * 8 + (bytes % 8 ? 8 : 0);
+    if (at + 8 > end || bytes > end - at - 8 || padded > end - at - 8)
+      corrupt("truncated chunk");
+    return at + 8 + padded;
+  }
+
+  // Every column block of the chunk lies before the footer, and raw columns
+  // hold exactly the chunk's rows, so readColumn stays within its buffer
+  void checkChunk(const Chunk &chunk, std::uint64_t footer) const {
+    if (chunk.offset >= footer)
+      corrupt("bad chunk");
+    std::uint64_t at = chunk.offset + 8;
+    for (std::size_t c = 0; c < encodings_.size(); ++c) {
+      std::uint64_t bytes = get<std::uint64_t>(at);
+      if (encodings_[c] == BinaryLog::Encoding::Raw
+              ? bytes % sizeof(double) != 0 ||
+                    bytes / sizeof(double) != chunk.rows
+              : bytes % 8 != 0)
+        corrupt("column size");
+      at = nextBlock(at, footer);
+    }
+  }
+
+public:
+  explicit BinaryLogReader(const std::string &path) : file_(path) {
+    using namespace BinaryLog;
+    require(0, 24 + TRAILER_BYTES);
+    if (std::memcmp(file_.data(), MAGIC, sizeof MAGIC) != 0 ||
+        std::memcmp(file_.data() + file_.size() - 8, MAGIC, sizeof MAGIC))
+      corrupt("not a telemetry log");
+    std::uint32_t version = get<std::uint32_t>(8);
+    if (version < 1 || version > VERSION)
+      throw std::runtime_error("Unsupported telemetry log version");
+
+    std::uint32_t columns = get<std::uint32_t>(12);
+    std::uint64_t at = 24;
+    for (std::uint32_t c = 0; c < columns; ++c) {
+      std::uint8_t encoding = get<std::uint8_t>(at);
+      if (encoding > static_cast<std::uint8_t>(Encoding::Delta))
+        corrupt("unknown column encoding");
+      encodings_.push_back(static_cast<Encoding>(encoding));
+      std::uint16_t nameLength = get<std::uint16_t>(at + 2);
+      std::uint16_t unitLength = get<std::uint16_t>(at + 4);
+      require(at + 6, nameLength + unitLength);
+      const char *text = file_.data() + at + 6;
+      schema_.add(std::string(text, nameLength),
+                  std::string(text + nameLength, unitLength));
+      at += 6 + nameLength + unitLength;
+    }
+    if (version >= 2) {
+      std::uint16_t entries = get<std::uint16_t>(at);
+      at += 2;
+      for (std::uint16_t i = 0; i < entries; ++i) {
+        std::uint16_t keyLength = get<std::uint16_t>(at);
+        std::uint16_t valueLength = get<std::uint16_t>(at + 2);
+        require(at + 4, keyLength + valueLength);
+        const char *text = file_.data() + at + 4;
+        schema_.setMetadata(std::string(text, keyLength),
+                            std::string(text + keyLength, valueLength));
+        at += 4 + keyLength + valueLength;
+      }
+    }
+
+    std::uint64_t footer =
+        get<std::uint64_t>(file_.size() - TRAILER_BYTES);
+    if (get<std::uint32_t>(footer) != INDEX_TAG)
+      corrupt("bad index");
+    std::uint32_t chunkCount = get<std::uint32_t>(footer + 4);
+    rows_ = get<std::uint64_t>(footer + 8);
+    require(footer + 16, std::uint64_t(chunkCount) * 16);
+    std::uint64_t total = 0;
+    for (std::uint32_t i = 0; i < chunkCount; ++i) {
+      std::uint64_t entry = footer + 16 + std::uint64_t(i) * 16;
+      Chunk chunk{get<std::uint64_t>(entry), get<std::uint64_t>(entry + 8)};
+      if (get<std::uint32_t>(chunk.offset) != CHUNK_TAG ||
+          get<std::uint32_t>(chunk.offset + 4) != chunk.rows)
+        corrupt("bad chunk");
+      if (chunk.rows > std::numeric_limits<std::uint64_t>::max() - total)
+        corrupt("row count");
+      total += chunk.rows;
+      checkChunk(chunk, footer);
+      chunks_.push_back(chunk);
+    }
+    // column() sizes its buffer from rows_, which must cover every chunk
+    if (total != rows_)
+      corrupt("row count");
+  }
+
+  const TelemetrySchema &schema() const { return schema_; }
+  BinaryLog::Encoding encoding(std::size_t column) const {
+    return encodings_.at(column);
+  }
+  std::uint64_t rowCount() const { return rows_; }
+  std::size_t chunkCount() const { return chunks_.size(); }
+
+  // Decode all rowCount() values of a column into out
+  void readColumn(std::size_t column, double *out) const {
+    if (column >= schema_.size())
+      throw std::out_of_range("Telemetry column index out of range");
+    for (const auto &chunk : chunks_) {
+      // Skip to the column's block within the chunk
+      std::uint64_t at = chunk.offset + 8;
+      for (std::size_t c = 0; c < column; ++c)
+        at = nextBlock(at, file_.size());
+      // Sizes were checked against the chunk's rows when the log was opened
+      std::uint64_t bytes = get<std::uint64_t>(at);
+      const char *data = file_.data() + at + 8;
+      if (encodings_[column] == BinaryLog::Encoding::Delta)
+        DeltaCodec::decode(reinterpret_cast<const std::uint64_t *>(data),
+                           bytes / 8, chunk.rows, out);
+      else
+        std::memcpy(out, data, bytes);
+      out += chunk.rows;
+    }
+  }
+
+  std::vector<double> column(std::size_t index) const {
+    std::vector<double> values(rows_);
+    readColumn(index, values.data());
+    return values;
+  }
+  std::vector<double> column(const std::string &name) const {
+    return column(schema_.indexOf(name));
+  }
+};
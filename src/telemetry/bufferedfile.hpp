@@ -0,0 +1,396 @@
+#pragma once
+#include "uringqueue.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+// How BufferedFiles reach the disk, for the whole process; set before any
+// log is opened
+namespace FileOutput {
+enum class Io {
+  Sync, // pwrite(2) of each full buffer
+  Uring // Full buffers queued to io_uring while the next one fills
+};
+
+inline Io ioFromName(const std::string &name) {
+  if (name == "sync")
+    return Io::Sync;
+  if (name == "uring")
+    return Io::Uring;
+  throw std::invalid_argument("Unknown log I/O: " + name);
+}
+
+struct Options {
+  Io io = Io::Sync;
+  bool direct = false;          // O_DIRECT where the filesystem allows it
+  std::size_t uringBuffers = 4; // Per file; at most this many in flight
+};
+inline Options &options() {
+  static Options current;
+  return current;
+}
+
+// What closed files did, summed
+struct Stats {
+  std::uint64_t files = 0;
+  std::uint64_t bytes = 0;
+  double blockedSeconds = 0; // Inside write, submit and wait calls
+  std::uint64_t writes = 0;  // pwrite calls or io_uring submissions
+  std::uint64_t uringFiles = 0;
+  std::uint64_t fixedFiles = 0;  // With registered buffers
+  std::uint64_t directFiles = 0; // Opened O_DIRECT
+  std::uint64_t fallbacks = 0;   // io_uring wanted but unavailable
+  std::uint64_t enters = 0;      // io_uring_enter calls
+  std::uint64_t waits = 0;       // Every buffer of a file in flight
+  std::uint64_t maxInFlight = 0;
+
+  void add(const Stats &s) {
+    files += s.files;
+    bytes += s.bytes;
+    blockedSeconds += s.blockedSeconds;
+    writes += s.writes;
+    uringFiles += s.uringFiles;
+    fixedFiles += s.fixedFiles;
+    directFiles += s.directFiles;
+    fallbacks += s.fallbacks;
+    enters += s.enters;
+    waits += s.waits;
+    maxInFlight = std::max(maxInFlight, s.maxInFlight);
+  }
+};
+inline std::mutex &totalsMutex() {
+  static std::mutex m;
+  return m;
+}
+inline Stats &totals() {
+  static Stats sum;
+  return sum;
+}
+} // namespace FileOutput
+
+// Append-only output file behind a large buffer, so a stream of small
+// appends costs one write per buffer-full rather than one per record. With
+// FileOutput::Io::Uring full buffers go to a UringQueue and filling moves on
+// to the next registered buffer; if io_uring is unavailable the file falls
+// back to pwrite. Under O_DIRECT only whole blocks are written and the tail
+// of a partial block stays buffered; the last block is padded and the file
+// truncated back on close.
+class BufferedFile {
+public:
+  static constexpr std::size_t DEFAULT_BUFFER = std::size_t(1) << 20;
+
+private:
+  using Memory = std::unique_ptr<char, void (*)(void *)>;
+
+  std::string path_;
+  int fd_ = -1;
+  int patchFd_ = -1;      // Direct I/O: unaligned overwrites and reads
+  std::size_t align_ = 1; // Direct I/O: block size of every write
+  std::unique_ptr<UringQueue> uring_;
+  Memory own_{nullptr, std::free}; // The buffer, unless io_uring owns it
+  char *buffer_ = nullptr;
+  std::size_t capacity_ = 0;
+  std::size_t used_ = 0;
+  std::uint64_t written_ = 0; // Bytes already handed to the kernel
+  FileOutput::Stats stats_;
+
+  static Memory allocate(std::size_t bytes) {
+    constexpr std::size_t ALIGN = UringQueue::BUFFER_ALIGNMENT;
+    void *p = std::aligned_alloc(ALIGN, (bytes + ALIGN - 1) / ALIGN * ALIGN);
+    if (!p)
+      throw std::bad_alloc();
+    return Memory(static_cast<char *>(p), std::free);
+  }
+
+  // Times a blocking call into stats_
+  template <class F> void blocking(F call) {
+    auto start = std::chrono::steady_clock::now();
+    call();
+    stats_.blockedSeconds += std::chrono::duration<double>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count();
+  }
+
+  void writeAt(int fd, const char *data, std::size_t n, std::uint64_t at) {
+    ++stats_.writes;
+    blocking([&] {
+      while (n > 0) {
+        ssize_t done = ::pwrite(fd, data, n, static_cast<off_t>(at));
+        if (done < 0) {
+          if (errno == EINTR)
+            continue;
+          throw std::runtime_error("Cannot write " + path_ + ": " +
+                                   std::strerror(errno));
+        }
+        data += done;
+        n -= static_cast<std::size_t>(done);
+        at += static_cast<std::uint64_t>(done);
+      }
+    });
+  }
+
+  // Hand buffer_[0..n) to the kernel at written_
+  void submit(std::size_t n) {
+    if (uring_) {
+      ++stats_.writes;
+      blocking([&] {
+        uring_->write(fd_, buffer_, n, written_);
+        buffer_ = uring_->acquire();
+      });
+    } else {
+      writeAt(fd_, buffer_, n, written_);
+    }
+    written_ += n;
+  }
+
+  // Flush, then wait until everything handed over is written
+  void settle() {
+    flush();
+    if (uring_)
+      blocking([&] { uring_->drain(); });
+  }
+
+  // Where bytes before written_ are patched and read back
+  int patchFd() {
+    if (align_ == 1)
+      return fd_;
+    if (patchFd_ < 0) {
+      patchFd_ = ::open(path_.c_str(), O_RDWR);
+      if (patchFd_ < 0)
+        throw std::runtime_error("Cannot open " + path_ + ": " +
+                                 std::strerror(errno));
+    }
+    return patchFd_;
+  }
+
+public:
+  explicit BufferedFile(std::string path,
+                        std::size_t bufferSize = DEFAULT_BUFFER)
+      : path_(std::move(path)) {
+    const FileOutput::Options &options = FileOutput::options();
+    int flags = O_RDWR | O_CREAT | O_TRUNC;
+    if (options.direct) {
+      fd_ = ::open(path_.c_str(), flags | O_DIRECT, 0644);
+      if (fd_ >= 0)
+        align_ = UringQueue::BUFFER_ALIGNMENT;
+    }
+    if (fd_ < 0)
+      fd_ = ::open(path_.c_str(), flags, 0644);
+    if (fd_ < 0)
+      throw std::runtime_error("Cannot open " + path_ + ": " +
+                               std::strerror(errno));
+    if (options.io == FileOutput::Io::Uring) {
+      try {
+        uring_ = std::make_unique<UringQueue>(options.uringBuffers, bufferSize);
+      } catch (const std::exception &) {
+        stats_.fallbacks = 1;
+      }
+    }
+    if (uring_) {
+      capacity_ = uring_->bufferBytes();
+      buffer_ = uring_->acquire();
+    } else {
+      capacity_ = (bufferSize + align_ - 1) / align_ * align_;
+      own_ = allocate(capacity_);
+      buffer_ = own_.get();
+    }
+  }
+  ~BufferedFile() {
+    try {
+      close();
+    } catch (...) {
+    }
+  }
+  BufferedFile(const BufferedFile &) = delete;
+  BufferedFile &operator=(const BufferedFile &) = delete;
+
+  void append(const void *data, std::size_t n) {
+    const char *bytes = static_cast<const char *>(data);
+    if (!uring_ && align_ == 1 && n >= capacity_) { // Not worth copying
+      flush();
+      writeAt(fd_, bytes, n, written_);
+      written_ += n;
+      return;
+    }
+    while (n > 0) {
+      if (used_ == capacity_)
+        flush();
+      std::size_t k = std::min(n, capacity_ - used_);
+      std::memcpy(buffer_ + used_, bytes, k);
+      used_ += k;
+      bytes += k;
+      n -= k;
+    }
+  }
+  // Room for n bytes written in place at the returned pointer; commit()
+  // how many were used. Invalidated by any other call.
+  char *reserve(std::size_t n) {
+    if (used_ + n > capacity_) {
+      flush();
+      if (used_ + n > capacity_) {
+        if (uring_)
+          throw std::length_error("Record larger than the buffers of " +
+                                  path_);
+        std::size_t grown = (used_ + n + align_ - 1) / align_ * align_;
+        Memory bigger = allocate(grown);
+        std::memcpy(bigger.get(), buffer_, used_);
+        own_ = std::move(bigger);
+        buffer_ = own_.get();
+        capacity_ = grown;
+      }
+    }
+    return buffer_ + used_;
+  }
+  void commit(std::size_t n) { used_ += n; }
+
+  // Zero bytes up to the next multiple of alignment
+  void pad(std::size_t alignment) {
+    static const char ZEROS[64] = {};
+    std::size_t n = (alignment - offset() % alignment) % alignment;
+    append(ZEROS, n);
+  }
+
+  // Bytes appended so far, i.e. the file offset of the next append
+  std::uint64_t offset() const { return written_ + used_; }
+
+  // Hand the buffer to the kernel (under O_DIRECT, its whole blocks)
+  void flush() {
+    std::size_t n = used_ / align_ * align_;
+    if (n == 0)
+      return;
+    char *full = buffer_;
+    submit(n);
+    used_ -= n;
+    std::memmove(buffer_, full + n, used_);
+  }
+
+  // Replace n bytes already appended at offset (e.g. a header whose sizes
+  // are only known at the end); the append position is unchanged
+  void overwrite(std::uint64_t offset, const void *data, std::size_t n) {
+    if (offset + n > this->offset())
+      throw std::out_of_range("Overwrite past the end of " + path_);
+    settle();
+    const char *bytes = static_cast<const char *>(data);
+    if (offset < written_) {
+      std::size_t k = static_cast<std::size_t>(
+          std::min<std::uint64_t>(n, written_ - offset));
+      writeAt(patchFd(), bytes, k, offset);
+      bytes += k;
+      offset += k;
+      n -= k;
+    }
+    std::memcpy(buffer_ + (offset - written_), bytes, n);
+  }
+  // Read back n bytes already appended at offset
+  void read(std::uint64_t offset, void *data, std::size_t n) {
+    if (offset + n > this->offset())
+      throw std::out_of_range("Read past the end of " + path_);
+    settle();
+    char *bytes = static_cast<char *>(data);
+    int fd = patchFd();
+    while (n > 0 && offset < written_) {
+      std::size_t want = static_cast<std::size_t>(
+          std::min<std::uint64_t>(n, written_ - offset));
+      ssize_t done = ::pread(fd, bytes, want, static_cast<off_t>(offset));
+      if (done <= 0) {
+        if (done < 0 && errno == EINTR)
+          continue;
+        throw std::runtime_error("Cannot read " + path_);
+      }
+      bytes += done;
+      n -= static_cast<std::size_t>(done);
+      offset += static_cast<std::uint64_t>(done);
+    }
+    std::memcpy(bytes, buffer_ + (offset - written_), n);
+  }
+
+  void close() {
+    if (fd_ < 0)
+      return;
+    flush();
+    std::uint64_t size = offset();
+    if (used_ > 0) { // Direct I/O: the last block, zero-padded
+      std::size_t n = (used_ + align_ - 1) / align_ * align_;
+      std::memset(buffer_ + used_, 0, n - used_);
+      used_ = 0;
+      submit(n);
+    }
+    if (uring_) {
+      blocking([&] { uring_->drain(); });
+      const UringQueue::Stats &u = uring_->stats();
+      stats_.uringFiles = 1;
+      stats_.fixedFiles = u.fixed;
+      stats_.enters = u.enters;
+      stats_.waits = u.waits;
+      stats_.maxInFlight = u.maxInFlight;
+      uring_.reset();
+    }
+    if (written_ != size && ::ftruncate(fd_, static_cast<off_t>(size)) != 0)
+      throw std::runtime_error("Cannot truncate " + path_);
+    written_ = size;
+    ::close(fd_);
+    fd_ = -1;
+    if (patchFd_ >= 0)
+      ::close(patchFd_);
+    patchFd_ = -1;
+
+    stats_.files = 1;
+    stats_.bytes = size;
+    stats_.directFiles = align_ > 1;
+    std::lock_guard<std::mutex> lock(FileOutput::totalsMutex());
+    FileOutput::totals().add(stats_);
+  }
+};
+
+// Read-only memory map of a whole file
+class MappedFile {
+private:
+  const char *data_ = nullptr;
+  std::size_t size_ = 0;
+
+public:
+  explicit MappedFile(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw std::runtime_error("Cannot open " + path + ": " +
+                               std::strerror(errno));
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+      ::close(fd);
+      throw std::runtime_error("Cannot stat " + path);
+    }
+    size_ = static_cast<std::size_t>(info.st_size);
+    if (size_ > 0) {
+      void *p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("Cannot map " + path);
+      }
+      data_ = static_cast<const char *>(p);
+    }
+    ::close(fd);
+  }
+  ~MappedFile() {
+    if (data_)
+      ::munmap(const_cast<char *>(data_), size_);
+  }
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const char *data() const { return data_; }
+  std::size_t size() const { return size_; }
+};
@@ -0,0 +1,103 @@
+#pragma once
+#include "telemetrysink.hpp"
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Named telemetry channels, each a column plus a producer that computes its
+// value from a Sample (whatever view of the simulation the caller builds at
+// a sample instant). A run selects the channels it logs; producers of
+// unselected channels are never called, so registering a channel is free.
+template <class Sample> class ChannelRegistry {
+public:
+  using Producer = std::function<double(Sample &)>;
+
+  // The channels a run logs, in output order
+  class Selection {
+  private:
+    TelemetrySchema schema_;
+    std::vector<Producer> producers_;
+
+    friend class ChannelRegistry;
+
+  public:
+    const TelemetrySchema &schema() const { return schema_; }
+    std::size_t size() const { return producers_.size(); }
+
+    // Evaluate every selected channel into record[0..size())
+    void sample(Sample &source, double *record) const {
+      for (std::size_t i = 0; i < producers_.size(); ++i)
+        record[i] = producers_[i](source);
+    }
+  };
+
+private:
+  struct Channel {
+    TelemetryColumn column;
+    Producer produce;
+    bool byDefault; // Logged when the run selects no channels
+  };
+  std::vector<Channel> channels_;
+
+  const Channel &find(const std::string &name) const {
+    for (const auto &channel : channels_) {
+      if (channel.column.name == name)
+        return channel;
+    }
+    throw std::invalid_argument("Unknown telemetry channel: " + name);
+  }
+
+public:
+  void add(TelemetryColumn column, Producer produce, bool byDefault = true) {
+    for (const auto &channel : channels_) {
+      if (channel.column.name == column.name)
+        throw std::invalid_argument("Duplicate telemetry channel: " +
+                                    column.name);
+    }
+    channels_.push_back({std::move(column), std::move(produce), byDefault});
+  }
+  void add(std::string name, std::string unit, Producer produce) {
+    add({std::move(name), std::move(unit), TelemetryType::Float64, {}},
+        std::move(produce));
+  }
+
+  std::size_t size() const { return channels_.size(); }
+  const TelemetryColumn &column(std::size_t i) const {
+    return channels_[i].column;
+  }
+
+  // The named channels, in the given order
+  Selection select(const std::vector<std::string> &names) const {
+    Selection selection;
+    for (const auto &name : names) {
+      const Channel &channel = find(name);
+      for (const auto &column : selection.schema_.columns()) {
+        if (column.name == name)
+          throw std::invalid_argument("Telemetry channel listed twice: " +
+                                      name);
+      }
+      selection.schema_.add(channel.column);
+      selection.producers_.push_back(channel.produce);
+    }
+    return selection;
+  }
+  // Every channel, in registration order
+  Selection selectAll() const {
+    std::vector<std::string> names;
+    for (const auto &channel : channels_)
+      names.push_back(channel.column.name);
+    return select(names);
+  }
+  // The channels registered as logged by default, in registration order
+  Selection selectDefault() const {
+    std::vector<std::string> names;
+    for (const auto &channel : channels_) {
+      if (channel.byDefault)
+        names.push_back(channel.column.name);
+    }
+    return select(names);
+  }
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include "../physics/batchkernels.hpp"
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+// Records staged row by row for a writer that stores columns. transpose()
+// turns the staged rows into one array per column with the dispatched
+// BatchKernels::transpose, a gather per column and vector width of rows.
+class ColumnBlock {
+private:
+  std::size_t width_ = 0;
+  std::size_t capacity_ = 0;
+  std::size_t rows_ = 0;
+  std::vector<double> staged_;  // Row-major, capacity_ x width_
+  std::vector<double> columns_; // Column c from c * capacity_
+  std::vector<double *> pointers_;
+
+public:
+  ColumnBlock() = default;
+  ColumnBlock(std::size_t width, std::size_t capacity)
+      : width_(width), capacity_(capacity), staged_(width * capacity),
+        columns_(width * capacity), pointers_(width) {
+    for (std::size_t c = 0; c < width_; ++c)
+      pointers_[c] = columns_.data() + c * capacity_;
+  }
+  // Moving keeps the column storage, so pointers_ stay valid
+  ColumnBlock(ColumnBlock &&) = default;
+  ColumnBlock &operator=(ColumnBlock &&) = default;
+
+  std::size_t width() const { return width_; }
+  std::size_t size() const { return rows_; }
+  std::size_t capacity() const { return capacity_; }
+  bool full() const { return rows_ == capacity_; }
+
+  // Stage one record of width() values; the block must not be full
+  void push(const double *record) {
+    std::memcpy(&staged_[rows_ * width_], record, width_ * sizeof(double));
+    ++rows_;
+  }
+
+  // Turn the rows staged so far into columns, read with column(c) until the
+  // next transpose()
+  void transpose() {
+    BatchKernels::active().transpose(staged_.data(), rows_, width_,
+                                     pointers_.data());
+  }
+  const double *column(std::size_t c) const { return pointers_[c]; }
+
+  void clear() { rows_ = 0; }
+};
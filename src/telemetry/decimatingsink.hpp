@@ -0,0 +1,182 @@
+#pragma once
+#include "telemetrysink.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Online decimation: passes on only the records needed to rebuild every
+// column, by linear interpolation over the axis column (Time), to within
+// its tolerance. This is a swing-door test against the true endpoint: the
+// records since the last kept one (the anchor) bound the slopes a line from
+// the anchor may take and still pass within tolerance of each, so a new
+// record is a valid endpoint when its own slope lies inside those bounds.
+// The first record that is not forwards the one before it, which becomes
+// the new anchor. Each record costs O(columns), and nothing in a kept
+// segment is ever further from the interpolated line than its tolerance.
+//
+// Int64 columns use a tolerance just under 0.5, so rounding the
+// interpolation recovers them; Bool and Category columns use 0, so every
+// change is kept. NaN interpolates only between NaNs.
+class DecimatingSink : public TelemetrySink {
+public:
+  static constexpr const char *DEFAULT_AXIS = "Time";
+  static constexpr double INT_TOLERANCE = 0.49;
+
+private:
+  std::unique_ptr<TelemetrySink> inner_;
+  double defaultTolerance_;
+  std::vector<std::pair<std::string, double>> overrides_;
+  std::string axisName_;
+  std::size_t axis_ = 0;
+  std::size_t columns_ = 0;
+  std::vector<double> tolerance_;
+  std::vector<double> anchor_;    // Last record forwarded
+  std::vector<double> held_;      // Newest record, a valid endpoint
+  std::vector<double> low_;       // Slope bounds over the records
+  std::vector<double> high_;      // strictly between anchor and held
+  std::vector<char> anyNan_, allNan_;
+  bool started_ = false;
+  bool holding_ = false;
+  std::uint64_t received_ = 0;
+  std::uint64_t forwarded_ = 0;
+
+  void forward(const std::vector<double> &record) {
+    inner_->write(record.data());
+    ++forwarded_;
+  }
+
+  void resetDoor() {
+    std::fill(low_.begin(), low_.end(),
+              -std::numeric_limits<double>::infinity());
+    std::fill(high_.begin(), high_.end(),
+              std::numeric_limits<double>::infinity());
+    std::fill(anyNan_.begin(), anyNan_.end(), 0);
+    std::fill(allNan_.begin(), allNan_.end(), 1);
+  }
+
+  // Narrow the door by the held record, which is about to be passed over
+  void narrow() {
+    double dt = held_[axis_] - anchor_[axis_];
+    if (!(dt > 0)) { // The axis went backwards: nothing passes over held
+      std::fill(low_.begin(), low_.end(),
+                std::numeric_limits<double>::infinity());
+      return;
+    }
+    for (std::size_t c = 0; c < columns_; ++c) {
+      double v = held_[c];
+      bool nan = std::isnan(v);
+      anyNan_[c] |= nan;
+      allNan_[c] &= nan;
+      if (nan)
+        continue;
+      low_[c] = std::max(low_[c], (v - tolerance_[c] - anchor_[c]) / dt);
+      high_[c] = std::min(high_[c], (v + tolerance_[c] - anchor_[c]) / dt);
+    }
+  }
+
+  // Whether the line from the anchor to record passes every record between
+  bool reaches(const double *record) const {
+    double dt = record[axis_] - anchor_[axis_];
+    if (!(dt > 0))
+      return false;
+    for (std::size_t c = 0; c < columns_; ++c) {
+      if (c == axis_)
+        continue;
+      double a = anchor_[c], v = record[c];
+      if (std::isnan(a) || std::isnan(v)) {
+        if (!(std::isnan(a) && std::isnan(v) && allNan_[c]))
+          return false;
+        continue;
+      }
+      double slope = (v - a) / dt;
+      if (anyNan_[c] || !(slope >= low_[c] && slope <= high_[c]))
+        return false;
+    }
+    return true;
+  }
+
+public:
+  // Tolerances are absolute, in each column's unit
+  DecimatingSink(std::unique_ptr<TelemetrySink> inner,
+                 double defaultTolerance, std::string axis = DEFAULT_AXIS)
+      : inner_(std::move(inner)), defaultTolerance_(defaultTolerance),
+        axisName_(std::move(axis)) {
+    if (!(defaultTolerance_ >= 0))
+      throw std::invalid_argument("Decimation tolerance must not be negative");
+  }
+  ~DecimatingSink() override {
+    try {
+      close();
+    } catch (...) {
+    }
+  }
+
+  // Tolerance for the named Float64 column; before open()
+  void setTolerance(std::string column, double tolerance) {
+    if (!(tolerance >= 0))
+      throw std::invalid_argument("Decimation tolerance must not be negative");
+    overrides_.emplace_back(std::move(column), tolerance);
+  }
+
+  void open(const TelemetrySchema &schema) override {
+    columns_ = schema.size();
+    axis_ = schema.indexOf(axisName_);
+    tolerance_.assign(columns_, defaultTolerance_);
+    for (const auto &[name, tolerance] : overrides_)
+      tolerance_[schema.indexOf(name)] = tolerance;
+    for (std::size_t c = 0; c < columns_; ++c) {
+      if (schema[c].type == TelemetryType::Int64)
+        tolerance_[c] = INT_TOLERANCE;
+      else if (schema[c].type != TelemetryType::Float64)
+        tolerance_[c] = 0;
+    }
+    anchor_.assign(columns_, 0.0);
+    held_.assign(columns_, 0.0);
+    low_.resize(columns_);
+    high_.resize(columns_);
+    anyNan_.resize(columns_);
+    allNan_.resize(columns_);
+    resetDoor();
+    inner_->open(schema);
+  }
+
+  void write(const double *record) override {
+    ++received_;
+    if (!started_) {
+      anchor_.assign(record, record + columns_);
+      forward(anchor_);
+      started_ = true;
+      return;
+    }
+    if (holding_) {
+      narrow();
+      if (!reaches(record)) {
+        forward(held_);
+        anchor_.swap(held_);
+        resetDoor();
+      }
+    }
+    held_.assign(record, record + columns_);
+    holding_ = true;
+  }
+
+  void close() override {
+    if (!inner_)
+      return;
+    if (holding_)
+      forward(held_);
+    holding_ = false;
+    inner_->close();
+    inner_.reset();
+  }
+
+  std::uint64_t received() const { return received_; }
+  std::uint64_t forwarded() const { return forwarded_; }
+};
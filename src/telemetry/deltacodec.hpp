@@ -0,0 +1,215 @@
+#pragma once
+#include "../physics/batchkernels.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+// Lossless difference compression for a column of doubles. Values are taken
+// as their 64-bit patterns, which a smooth series moves through almost
+// polynomially, so a low-order finite difference (delta, delta-of-delta and
+// up) is a small integer; constant and linear stretches give zeros. The
+// encoder keeps the difference order (1 to MAX_ORDER) whose residuals pack
+// smallest, zigzag-codes them and bit-packs each block of BLOCK as a
+// BatchBits block at the width of its largest residual. Unpacking runs on
+// the active BatchKernels.
+//
+//   u64 first value, u64 order, then a width byte per block of the
+//   remaining values, padded to 8, then each block's width words
+//
+// Before the first value the series is taken to be constant, so every
+// difference starts at zero and the values are the first value plus the
+// order-fold running sum of the residuals.
+namespace DeltaCodec {
+constexpr std::size_t BLOCK = BatchBits::BLOCK;
+constexpr unsigned MAX_ORDER = 4;
+
+inline std::uint64_t toBits(double value) {
+  std::uint64_t bits;
+  std::memcpy(&bits, &value, sizeof bits);
+  return bits;
+}
+inline double fromBits(std::uint64_t bits) {
+  double value;
+  std::memcpy(&value, &bits, sizeof value);
+  return value;
+}
+
+// Small signed differences to small unsigned ones: 0, -1, 1, -2, ...
+inline std::uint64_t zigzag(std::uint64_t d) {
+  std::uint64_t sign =
+      static_cast<std::uint64_t>(static_cast<std::int64_t>(d) >> 63);
+  return (d << 1) ^ sign;
+}
+inline std::uint64_t unzigzag(std::uint64_t z) {
+  return (z >> 1) ^ (0 - (z & 1));
+}
+
+// The last value and its first three differences, in wrapping arithmetic
+struct History {
+  std::uint64_t value = 0, d1 = 0, d2 = 0, d3 = 0;
+
+  // Append x; d receives its differences of order 1 to 4
+  void push(std::uint64_t x, std::uint64_t (&d)[MAX_ORDER]) {
+    d[0] = x - value;
+    d[1] = d[0] - d1;
+    d[2] = d[1] - d2;
+    d[3] = d[2] - d3;
+    value = x;
+    d1 = d[0];
+    d2 = d[1];
+    d3 = d[2];
+  }
+
+  // Append and return the value whose Order-th difference is r
+  template <unsigned Order> std::uint64_t pop(std::uint64_t r) {
+    std::uint64_t e1, e2, e3;
+    if constexpr (Order == 1) {
+      e1 = r;
+      e2 = e1 - d1;
+      e3 = e2 - d2;
+    } else if constexpr (Order == 2) {
+      e2 = r;
+      e1 = d1 + e2;
+      e3 = e2 - d2;
+    } else if constexpr (Order == 3) {
+      e3 = r;
+      e2 = d2 + e3;
+      e1 = d1 + e2;
+    } else {
+      e3 = d3 + r;
+      e2 = d2 + e3;
+      e1 = d1 + e2;
+    }
+    value += e1;
+    d1 = e1;
+    d2 = e2;
+    d3 = e3;
+    return value;
+  }
+};
+
+// Blocks after the first value
+inline std::size_t blockCount(std::size_t n) {
+  return n > 1 ? (n - 1 + BLOCK - 1) / BLOCK : 0;
+}
+inline std::size_t headerWords(std::size_t n) {
+  return 2 + (blockCount(n) + 7) / 8;
+}
+
+inline unsigned packedWidth(const std::uint64_t *block) {
+  std::uint64_t all = 0;
+  for (std::size_t j = 0; j < BLOCK; ++j)
+    all |= block[j];
+  return all ? 64 - __builtin_clzll(all) : 0;
+}
+
+// Append the encoding of values[0..n) to out
+inline void encode(const double *values, std::size_t n,
+                   std::vector<std::uint64_t> &out) {
+  std::size_t blocks = blockCount(n);
+  // Zigzagged residuals of every order, zero past the end
+  std::vector<std::uint64_t> residuals(MAX_ORDER * blocks * BLOCK, 0);
+  History history;
+  history.value = n > 0 ? toBits(values[0]) : 0;
+  for (std::size_t i = 1; i < n; ++i) {
+    std::uint64_t d[MAX_ORDER];
+    history.push(toBits(values[i]), d);
+    for (unsigned o = 0; o < MAX_ORDER; ++o)
+      residuals[o * blocks * BLOCK + i - 1] = zigzag(d[o]);
+  }
+
+  // The lowest order that packs smallest
+  unsigned order = 0;
+  std::size_t best = 0;
+  for (unsigned o = 0; o < MAX_ORDER; ++o) {
+    std::size_t words = 0;
+    for (std::size_t b = 0; b < blocks; ++b)
+      words += packedWidth(&residuals[(o * blocks + b) * BLOCK]);
+    if (o == 0 || words < best) {
+      best = words;
+      order = o;
+    }
+  }
+
+  out.push_back(n > 0 ? toBits(values[0]) : 0);
+  out.push_back(order + 1);
+  std::size_t widthsAt = out.size();
+  out.resize(out.size() + headerWords(n) - 2, 0);
+  for (std::size_t b = 0; b < blocks; ++b) {
+    const std::uint64_t *block = &residuals[(order * blocks + b) * BLOCK];
+    unsigned width = packedWidth(block);
+    reinterpret_cast<unsigned char *>(out.data() + widthsAt)[b] =
+        static_cast<unsigned char>(width);
+    std::size_t at = out.size();
+    out.resize(at + width, 0);
+    std::uint64_t *words = out.data() + at;
+    for (std::size_t j = 0; j < BLOCK && width > 0; ++j) {
+      std::size_t bit = j * width, k = bit >> 6;
+      unsigned shift = bit & 63;
+      words[k] |= block[j] << shift;
+      if (shift + width > 64)
+        words[k + 1] |= block[j] >> (64 - shift);
+    }
+  }
+}
+
+template <unsigned Order>
+void decodeBlocks(std::uint64_t first, const std::uint64_t *packed,
+                  const unsigned char *widths, std::size_t n, double *out) {
+  auto unpack = BatchKernels::active().unpackBits;
+  History history;
+  history.value = first;
+  std::uint64_t block[BLOCK];
+  for (std::size_t b = 0, i = 1; i < n; ++b) {
+    unpack(packed, widths[b], block);
+    packed += widths[b];
+    std::size_t m = std::min(BLOCK, n - i);
+    for (std::size_t j = 0; j < m; ++j)
+      out[i + j] = fromBits(history.pop<Order>(unzigzag(block[j])));
+    i += m;
+  }
+}
+
+// Decode n values from words[0..count) into out; throws if the encoding
+// does not fill count words exactly
+inline void decode(const std::uint64_t *words, std::size_t count,
+                   std::size_t n, double *out) {
+  std::size_t blocks = blockCount(n);
+  std::size_t header = headerWords(n);
+  if (count < header)
+    throw std::runtime_error("Corrupt delta column: truncated");
+  if (words[1] < 1 || words[1] > MAX_ORDER)
+    throw std::runtime_error("Corrupt delta column: bad order");
+  const unsigned char *widths =
+      reinterpret_cast<const unsigned char *>(words + 2);
+  std::size_t total = header;
+  for (std::size_t b = 0; b < blocks; ++b) {
+    if (widths[b] > 64)
+      throw std::runtime_error("Corrupt delta column: bad width");
+    total += widths[b];
+  }
+  if (total != count)
+    throw std::runtime_error("Corrupt delta column: size");
+
+  if (n > 0)
+    out[0] = fromBits(words[0]);
+  const std::uint64_t *packed = words + header;
+  switch (words[1]) {
+  case 1:
+    decodeBlocks<1>(words[0], packed, widths, n, out);
+    break;
+  case 2:
+    decodeBlocks<2>(words[0], packed, widths, n, out);
+    break;
+  case 3:
+    decodeBlocks<3>(words[0], packed, widths, n, out);
+    break;
+  default:
+    decodeBlocks<4>(words[0], packed, widths, n, out);
+    break;
+  }
+}
+} // namespace DeltaCodec
@@ -0,0 +1,146 @@
+#pragma once
+#include "arrowipc.hpp"
+#include "bufferedfile.hpp"
+#include "npyformat.hpp"
+#include "telemetrysink.hpp"
+#include "zipwriter.hpp"
+#include <cerrno>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <sys/stat.h>
+#include <utility>
+#include <vector>
+
+// Telemetry of an ensemble as one (members, samples) float64 array per
+// column, for export as .npz or a directory of .npy files. Members that end
+// early (a crash) leave NaN in their remaining samples. Each column is held
+// contiguously, so an export is one write per column.
+class EnsembleArrays {
+public:
+  static constexpr double MISSING = std::numeric_limits<double>::quiet_NaN();
+
+private:
+  TelemetrySchema schema_;
+  std::size_t members_;
+  std::size_t samples_;
+  std::vector<std::vector<double>> columns_;
+
+  // Records appended to one member, in sample order
+  class MemberSink : public TelemetrySink {
+  private:
+    EnsembleArrays &arrays_;
+    std::size_t member_;
+    std::size_t next_ = 0;
+
+  public:
+    MemberSink(EnsembleArrays &arrays, std::size_t member)
+        : arrays_(arrays), member_(member) {}
+
+    void open(const TelemetrySchema &schema) override {
+      if (schema.size() != arrays_.schema_.size())
+        throw std::invalid_argument("Ensemble member schema mismatch");
+    }
+    void write(const double *record) override {
+      arrays_.set(member_, next_++, record);
+    }
+    void close() override {}
+  };
+
+  std::string header() const {
+    return Npy::header("<f8", {members_, samples_});
+  }
+
+public:
+  EnsembleArrays(TelemetrySchema schema, std::size_t members,
+                 std::size_t samples)
+      : schema_(std::move(schema)), members_(members), samples_(samples),
+        columns_(schema_.size(),
+                 std::vector<double>(members * samples, MISSING)) {}
+
+  const TelemetrySchema &schema() const { return schema_; }
+  std::size_t members() const { return members_; }
+  std::size_t samples() const { return samples_; }
+
+  void set(std::size_t member, std::size_t sample, const double *record) {
+    if (member >= members_ || sample >= samples_)
+      throw std::out_of_range("Ensemble sample out of range");
+    for (std::size_t c = 0; c < columns_.size(); ++c)
+      columns_[c][member * samples_ + sample] = record[c];
+  }
+  // Row-major (members, samples) values of a column
+  const std::vector<double> &column(std::size_t c) const {
+    return columns_[c];
+  }
+
+  // A sink that fills member's samples from the first
+  std::unique_ptr<TelemetrySink> memberSink(std::size_t member) {
+    if (member >= members_)
+      throw std::out_of_range("Ensemble member out of range");
+    return std::make_unique<MemberSink>(*this, member);
+  }
+
+  // Uncompressed .npz: an array per column plus "columns" and "units"
+  void writeNpz(const std::string &path) const {
+    ZipWriter zip(path);
+    std::string h = header();
+    std::vector<std::string> names, units;
+    for (std::size_t c = 0; c < columns_.size(); ++c) {
+      names.push_back(schema_[c].name);
+      units.push_back(schema_[c].unit);
+      zip.begin(schema_[c].name + ".npy");
+      zip.append(h.data(), h.size());
+      zip.append(columns_[c].data(), columns_[c].size() * sizeof(double));
+      zip.end();
+    }
+    std::string npy = Npy::stringArray(names);
+    zip.add("columns.npy", npy.data(), npy.size());
+    npy = Npy::stringArray(units);
+    zip.add("units.npy", npy.data(), npy.size());
+    zip.close();
+  }
+
+  // Arrow IPC file in long form: an int64 "Member" column, then the
+  // columns, member by member. Samples a member never reached are left
+  // out.
+  void writeArrow(const std::string &path) const {
+    TelemetrySchema schema;
+    schema.add({"Member", "", TelemetryType::Int64, {}});
+    for (const auto &column : schema_.columns())
+      schema.add(column);
+    ArrowFileWriter file(path, samples_ > 0 ? samples_ : 1);
+    file.open(schema);
+    std::vector<double> record(schema.size());
+    for (std::size_t m = 0; m < members_; ++m) {
+      record[0] = double(m);
+      for (std::size_t t = 0; t < samples_; ++t) {
+        bool reached = false;
+        for (std::size_t c = 0; c < columns_.size(); ++c) {
+          record[c + 1] = columns_[c][m * samples_ + t];
+          reached = reached || !std::isnan(record[c + 1]);
+        }
+        if (reached)
+          file.write(record.data());
+      }
+    }
+    file.close();
+  }
+
+  // A <column>.npy per column in directory, which is created if need be
+  void writeNpy(const std::string &directory) const {
+    if (::mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST)
+      throw std::runtime_error("Cannot create " + directory + ": " +
+                               std::strerror(errno));
+    std::string h = header();
+    for (std::size_t c = 0; c < columns_.size(); ++c) {
+      BufferedFile file(directory + "/" + schema_[c].name + ".npy");
+      file.append(h.data(), h.size());
+      file.append(columns_[c].data(), columns_[c].size() * sizeof(double));
+      file.close();
+    }
+  }
+};
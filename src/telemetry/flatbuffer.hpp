@@ -0,0 +1,179 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Just enough of the FlatBuffers wire format to write Arrow IPC metadata: a
+// Table is a set of fields by index (scalars, strings, sub-tables and
+// vectors of structs or tables), and finish() lays the tree out front to
+// back. Each table is preceded by its vtable and followed by its children,
+// so every uoffset points forward as the format requires. Nothing is
+// deduplicated; Arrow metadata is small.
+namespace Flatbuffer {
+class Table;
+
+struct Field {
+  enum class Kind { Scalar, String, Structs, Table, Tables };
+  Kind kind;
+  std::uint16_t index;
+  std::string bytes;        // Scalar or struct bytes, or string text
+  std::size_t size = 0;     // Scalar: width. Structs: element alignment
+  std::size_t count = 0;    // Structs: element count
+  std::vector<Table> tables; // Table (one) or Tables
+};
+
+class Table {
+private:
+  std::vector<Field> fields_;
+
+  friend class Builder;
+
+  Field &add(Field::Kind kind, std::uint16_t index) {
+    fields_.push_back({kind, index, {}, 0, 0, {}});
+    return fields_.back();
+  }
+
+public:
+  template <class T> Table &scalar(std::uint16_t index, T value) {
+    Field &f = add(Field::Kind::Scalar, index);
+    f.bytes.assign(reinterpret_cast<const char *>(&value), sizeof value);
+    f.size = sizeof value;
+    return *this;
+  }
+  Table &string(std::uint16_t index, std::string text) {
+    add(Field::Kind::String, index).bytes = std::move(text);
+    return *this;
+  }
+  // A vector of count structs of alignment align, already laid out
+  Table &structs(std::uint16_t index, std::string bytes, std::size_t count,
+                 std::size_t align) {
+    Field &f = add(Field::Kind::Structs, index);
+    f.bytes = std::move(bytes);
+    f.count = count;
+    f.size = align;
+    return *this;
+  }
+  Table &table(std::uint16_t index, Table child) {
+    add(Field::Kind::Table, index).tables.push_back(std::move(child));
+    return *this;
+  }
+  Table &tables(std::uint16_t index, std::vector<Table> children) {
+    add(Field::Kind::Tables, index).tables = std::move(children);
+    return *this;
+  }
+};
+
+class Builder {
+private:
+  std::string out_;
+
+  void put32(std::uint32_t value) {
+    out_.append(reinterpret_cast<const char *>(&value), sizeof value);
+  }
+  void patch32(std::size_t at, std::uint32_t value) {
+    std::memcpy(&out_[at], &value, sizeof value);
+  }
+  void patch16(std::size_t at, std::uint16_t value) {
+    std::memcpy(&out_[at], &value, sizeof value);
+  }
+  // Pad so that (size + ahead) is a multiple of alignment
+  void padFor(std::size_t alignment, std::size_t ahead = 0) {
+    while ((out_.size() + ahead) % alignment)
+      out_ += '\0';
+  }
+  // Point the uoffset at `at` to `target`
+  void link(std::size_t at, std::size_t target) {
+    patch32(at, static_cast<std::uint32_t>(target - at));
+  }
+
+  static std::size_t width(const Field &f) {
+    return f.kind == Field::Kind::Scalar ? f.size : 4;
+  }
+
+  std::size_t writeTable(const Table &table) {
+    std::size_t slots = 0;
+    for (const auto &f : table.fields_)
+      slots = std::max<std::size_t>(slots, f.index + 1u);
+    std::size_t vtableBytes = 4 + 2 * slots;
+
+    // The table's first 8-byte field lands on an 8-byte boundary
+    padFor(8, vtableBytes + 4);
+    std::size_t vtable = out_.size();
+    out_.append(vtableBytes, '\0');
+    std::size_t start = out_.size();
+    put32(static_cast<std::uint32_t>(start - vtable)); // soffset to vtable
+
+    // Widest fields first keeps each naturally aligned
+    std::vector<const Field *> order;
+    for (const auto &f : table.fields_)
+      order.push_back(&f);
+    std::stable_sort(order.begin(), order.end(),
+                     [](const Field *a, const Field *b) {
+                       return width(*a) > width(*b);
+                     });
+    std::vector<std::pair<const Field *, std::size_t>> children;
+    for (const Field *f : order) {
+      padFor(width(*f));
+      patch16(vtable + 4 + 2 * f->index,
+              static_cast<std::uint16_t>(out_.size() - start));
+      if (f->kind == Field::Kind::Scalar) {
+        out_ += f->bytes;
+      } else {
+        children.emplace_back(f, out_.size());
+        put32(0);
+      }
+    }
+    patch16(vtable, static_cast<std::uint16_t>(vtableBytes));
+    patch16(vtable + 2, static_cast<std::uint16_t>(out_.size() - start));
+
+    for (const auto &[f, at] : children)
+      link(at, writeChild(*f));
+    return start;
+  }
+
+  std::size_t writeChild(const Field &f) {
+    switch (f.kind) {
+    case Field::Kind::String: {
+      padFor(4);
+      std::size_t at = out_.size();
+      put32(static_cast<std::uint32_t>(f.bytes.size()));
+      out_ += f.bytes;
+      out_ += '\0';
+      return at;
+    }
+    case Field::Kind::Structs: {
+      padFor(std::max<std::size_t>(f.size, 4), 4);
+      std::size_t at = out_.size();
+      put32(static_cast<std::uint32_t>(f.count));
+      out_ += f.bytes;
+      return at;
+    }
+    case Field::Kind::Table:
+      return writeTable(f.tables.front());
+    default: {
+      padFor(4);
+      std::size_t at = out_.size();
+      put32(static_cast<std::uint32_t>(f.tables.size()));
+      std::size_t slots = out_.size();
+      out_.append(4 * f.tables.size(), '\0');
+      for (std::size_t i = 0; i < f.tables.size(); ++i)
+        link(slots + 4 * i, writeTable(f.tables[i]));
+      return at;
+    }
+    }
+  }
+
+public:
+  // The finished buffer, rooted at root and padded to 8 bytes
+  std::string finish(const Table &root) {
+    out_.assign(4, '\0');
+    link(0, writeTable(root));
+    padFor(8);
+    return std::move(out_);
+  }
+};
+} // namespace Flatbuffer
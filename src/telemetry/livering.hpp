@@ -0,0 +1,274 @@
+#pragma once
+#include "telemetrysink.hpp"
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Live telemetry in POSIX shared memory (shm_open, so /dev/shm/<name> on
+// Linux): a fixed ring of the latest records that any number of readers, in
+// any process or language, can tail while the simulation runs. The writer
+// never waits for readers and never learns of them; each slot is a seqlock,
+// so a reader that falls a whole ring behind sees the slot's sequence move
+// on and counts the record as lost instead of reading a torn one.
+//
+//   header  "NOVASHM1", u32 version, u32 columns, u64 capacity (a power of
+//           2), u64 slot bytes, u64 slots offset, u64 schema bytes,
+//           then at byte 64: u64 published, u32 closed
+//   schema  at byte 128: "name\tunit\n" per column
+//   slots   from slots offset, 64-byte aligned: u64 sequence, then the
+//           record's doubles
+//
+// Record n lives in slot n % capacity. Its sequence is 2n + 1 while it is
+// being written and 2n + 2 once complete; "published" counts complete
+// records and "closed" is set when the run ends. Everything is
+// little-endian, and the magic is written last, so a reader that finds it
+// sees a complete header.
+namespace LiveRing {
+constexpr char MAGIC[] = "NOVASHM1";
+constexpr std::uint32_t VERSION = 1;
+constexpr std::size_t SCHEMA_OFFSET = 128;
+constexpr std::size_t SLOT_ALIGNMENT = 64;
+
+struct Header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t columns;
+  std::uint64_t capacity;
+  std::uint64_t slotBytes;
+  std::uint64_t slotsOffset;
+  std::uint64_t schemaBytes;
+  alignas(64) std::atomic<std::uint64_t> published;
+  std::atomic<std::uint32_t> closed;
+};
+static_assert(offsetof(Header, published) == 64, "Live ring header layout");
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "Shared-memory atomics must be lock-free");
+
+struct Slot {
+  std::atomic<std::uint64_t> sequence;
+  double *values() { return reinterpret_cast<double *>(this + 1); }
+};
+static_assert(sizeof(Slot) == 8, "Live ring slot layout");
+
+inline std::string shmName(const std::string &name) {
+  return name.empty() || name[0] == '/' ? name : "/" + name;
+}
+} // namespace LiveRing
+
+// Publishes records into a new live ring, replacing any old one of the same
+// name (readers still mapping the old one keep it until they let go).
+// close() leaves the segment in place so a reader that attaches after a short
+// run still finds it; it is removed by the next open() of the same name, or
+// by whoever started the reader (nova.py removes it once screen.py exits).
+class LiveTelemetryRing : public TelemetrySink {
+public:
+  static constexpr std::size_t DEFAULT_CAPACITY = 4096;
+
+private:
+  std::string name_;
+  std::size_t capacity_;
+  void *map_ = MAP_FAILED;
+  std::size_t mapBytes_ = 0;
+  LiveRing::Header *header_ = nullptr;
+  char *slots_ = nullptr;
+  std::uint64_t next_ = 0; // Record number of the next claim()
+
+  LiveRing::Slot &slot(std::uint64_t n) const {
+    return *reinterpret_cast<LiveRing::Slot *>(
+        slots_ + (n & (capacity_ - 1)) * header_->slotBytes);
+  }
+
+public:
+  explicit LiveTelemetryRing(std::string name,
+                             std::size_t capacity = DEFAULT_CAPACITY)
+      : name_(LiveRing::shmName(name)), capacity_(capacity) {
+    if (capacity_ == 0 || (capacity_ & (capacity_ - 1)))
+      throw std::invalid_argument("Live ring capacity must be a power of 2");
+  }
+  ~LiveTelemetryRing() override {
+    try {
+      close();
+    } catch (...) {
+    }
+  }
+
+  void open(const TelemetrySchema &schema) override {
+    std::string text;
+    for (const auto &column : schema.columns())
+      text += column.name + "\t" + column.unit + "\n";
+    std::size_t slotBytes = (sizeof(LiveRing::Slot) +
+                             schema.size() * sizeof(double) +
+                             LiveRing::SLOT_ALIGNMENT - 1) /
+                            LiveRing::SLOT_ALIGNMENT * LiveRing::SLOT_ALIGNMENT;
+    std::size_t slotsOffset = (LiveRing::SCHEMA_OFFSET + text.size() +
+                               LiveRing::SLOT_ALIGNMENT - 1) /
+                              LiveRing::SLOT_ALIGNMENT *
+                              LiveRing::SLOT_ALIGNMENT;
+    mapBytes_ = slotsOffset + capacity_ * slotBytes;
+
+    ::shm_unlink(name_.c_str());
+    int fd = ::shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0)
+      throw std::runtime_error("Cannot create shared memory " + name_ + ": " +
+                               std::strerror(errno));
+    if (::ftruncate(fd, static_cast<off_t>(mapBytes_)) != 0) {
+      ::close(fd);
+      throw std::runtime_error("Cannot size shared memory " + name_);
+    }
+    map_ = ::mmap(nullptr, mapBytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                  0);
+    ::close(fd);
+    if (map_ == MAP_FAILED)
+      throw std::runtime_error("Cannot map shared memory " + name_);
+
+    // Fresh shared memory is zero: every sequence is 0, nothing published
+    char *base = static_cast<char *>(map_);
+    header_ = reinterpret_cast<LiveRing::Header *>(base);
+    slots_ = base + slotsOffset;
+    header_->version = LiveRing::VERSION;
+    header_->columns = static_cast<std::uint32_t>(schema.size());
+    header_->capacity = capacity_;
+    header_->slotBytes = slotBytes;
+    header_->slotsOffset = slotsOffset;
+    header_->schemaBytes = text.size();
+    std::memcpy(base + LiveRing::SCHEMA_OFFSET, text.data(), text.size());
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header_->magic, LiveRing::MAGIC, sizeof header_->magic);
+  }
+
+  // The next record's values, written in place and then publish()ed. The
+  // slot is the oldest record's; readers skip it until it is published.
+  double *claim() {
+    LiveRing::Slot &s = slot(next_);
+    s.sequence.store(2 * next_ + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return s.values();
+  }
+  void publish() {
+    slot(next_).sequence.store(2 * next_ + 2, std::memory_order_release);
+    ++next_;
+    header_->published.store(next_, std::memory_order_release);
+  }
+
+  void write(const double *record) override {
+    double *values = claim();
+    std::memcpy(values, record, header_->columns * sizeof(double));
+    publish();
+  }
+
+  void close() override {
+    if (map_ == MAP_FAILED)
+      return;
+    header_->closed.store(1, std::memory_order_release);
+    ::munmap(map_, mapBytes_);
+    map_ = MAP_FAILED;
+  }
+
+  std::uint64_t published() const { return next_; }
+};
+
+// Tails a live ring from another thread or process
+class LiveTelemetryReader {
+private:
+  void *map_ = MAP_FAILED;
+  std::size_t mapBytes_ = 0;
+  const LiveRing::Header *header_ = nullptr;
+  const char *slots_ = nullptr;
+  TelemetrySchema schema_;
+  std::uint64_t next_ = 0;
+  std::uint64_t lost_ = 0;
+
+public:
+  // Attach to the ring; starts at the oldest record it still holds. Throws
+  // if there is no complete ring of that name yet.
+  explicit LiveTelemetryReader(const std::string &name) {
+    std::string shm = LiveRing::shmName(name);
+    int fd = ::shm_open(shm.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+      throw std::runtime_error("No live telemetry " + shm);
+    struct stat info;
+    if (::fstat(fd, &info) != 0 ||
+        static_cast<std::size_t>(info.st_size) < LiveRing::SCHEMA_OFFSET) {
+      ::close(fd);
+      throw std::runtime_error("Live telemetry " + shm + " not ready");
+    }
+    mapBytes_ = static_cast<std::size_t>(info.st_size);
+    map_ = ::mmap(nullptr, mapBytes_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map_ == MAP_FAILED)
+      throw std::runtime_error("Cannot map live telemetry " + shm);
+    const char *base = static_cast<const char *>(map_);
+    header_ = reinterpret_cast<const LiveRing::Header *>(base);
+    if (std::memcmp(header_->magic, LiveRing::MAGIC, 8) != 0 ||
+        header_->version != LiveRing::VERSION ||
+        header_->slotsOffset + header_->capacity * header_->slotBytes >
+            mapBytes_) {
+      ::munmap(map_, mapBytes_);
+      throw std::runtime_error("Live telemetry " + shm + " not ready");
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    slots_ = base + header_->slotsOffset;
+
+    std::string text(base + LiveRing::SCHEMA_OFFSET, header_->schemaBytes);
+    for (std::size_t at = 0; at < text.size();) {
+      std::size_t tab = text.find('\t', at), end = text.find('\n', at);
+      schema_.add(text.substr(at, tab - at),
+                  text.substr(tab + 1, end - tab - 1));
+      at = end + 1;
+    }
+    std::uint64_t published = header_->published.load();
+    next_ = published > header_->capacity ? published - header_->capacity : 0;
+  }
+  ~LiveTelemetryReader() {
+    if (map_ != MAP_FAILED)
+      ::munmap(map_, mapBytes_);
+  }
+  LiveTelemetryReader(const LiveTelemetryReader &) = delete;
+  LiveTelemetryReader &operator=(const LiveTelemetryReader &) = delete;
+
+  const TelemetrySchema &schema() const { return schema_; }
+  bool closed() const { return header_->closed.load() != 0; }
+  // Records overwritten before this reader got to them
+  std::uint64_t lost() const { return lost_; }
+
+  // Pass each record published since the last poll to visit (into a
+  // caller-owned copy, record[0..columns)); returns how many
+  std::size_t poll(double *record, const std::function<void(const double *)>
+                                       &visit) {
+    std::uint64_t published =
+        header_->published.load(std::memory_order_acquire);
+    std::uint64_t capacity = header_->capacity;
+    if (published - next_ > capacity) {
+      lost_ += published - capacity - next_;
+      next_ = published - capacity;
+    }
+    std::size_t count = 0;
+    for (; next_ < published; ++next_) {
+      const auto *s = reinterpret_cast<const LiveRing::Slot *>(
+          slots_ + (next_ & (capacity - 1)) * header_->slotBytes);
+      std::uint64_t expect = 2 * next_ + 2;
+      if (s->sequence.load(std::memory_order_acquire) != expect) {
+        ++lost_;
+        continue;
+      }
+      std::memcpy(record, s + 1, header_->columns * sizeof(double));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (s->sequence.load(std::memory_order_relaxed) != expect) {
+        ++lost_;
+        continue;
+      }
+      visit(record);
+      ++count;
+    }
+    return count;
+  }
+};
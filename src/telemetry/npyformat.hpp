@@ -0,0 +1,63 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// numpy's .npy format (version 1.0): magic, a little-endian u16 header
+// length, then a Python dict literal padded with spaces to a multiple of 64
+// bytes and ended by a newline, then the C-order array data. np.load reads
+// these without parsing anything but the header, and can memory-map them.
+namespace Npy {
+constexpr char MAGIC[] = "\x93NUMPY\x01\x00";
+constexpr std::size_t MAGIC_BYTES = 8;
+constexpr std::size_t ALIGNMENT = 64;
+// Header size for arrays written before their length is known; room for
+// two 20-digit dimensions, patched in place when the array is complete
+constexpr std::size_t STREAM_HEADER_BYTES = 128;
+
+// Header for an array of descr (e.g. "<f8") with the given shape, at least
+// minBytes long
+inline std::string header(const std::string &descr,
+                          const std::vector<std::uint64_t> &shape,
+                          std::size_t minBytes = ALIGNMENT) {
+  std::string dict =
+      "{'descr': '" + descr + "', 'fortran_order': False, 'shape': (";
+  for (std::size_t i = 0; i < shape.size(); ++i)
+    dict += std::to_string(shape[i]) + (shape.size() == 1 ? "," : "") +
+            (i + 1 < shape.size() ? ", " : "");
+  dict += "), }";
+
+  std::size_t bytes = MAGIC_BYTES + 2 + dict.size() + 1;
+  bytes = std::max(minBytes, (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT);
+  std::size_t length = bytes - MAGIC_BYTES - 2;
+  if (length > 0xffff || dict.size() + 1 > length)
+    throw std::length_error("npy header too long");
+  dict.resize(length - 1, ' ');
+  dict += '\n';
+
+  std::string out(MAGIC, MAGIC_BYTES);
+  out += static_cast<char>(length & 0xff);
+  out += static_cast<char>(length >> 8);
+  return out + dict;
+}
+
+// A complete .npy of strings, as numpy's fixed-width UTF-32 '<U' arrays.
+// Text is taken as ASCII.
+inline std::string stringArray(const std::vector<std::string> &values) {
+  std::size_t width = 1;
+  for (const auto &value : values)
+    width = std::max(width, value.size());
+  std::string out = header("<U" + std::to_string(width), {values.size()});
+  for (const auto &value : values) {
+    for (std::size_t i = 0; i < width; ++i) {
+      char c = i < value.size() ? value[i] : '\0';
+      out += c;
+      out.append(3, '\0');
+    }
+  }
+  return out;
+}
+} // namespace Npy
@@ -0,0 +1,201 @@
+#pragma once
+#include "bufferedfile.hpp"
+#include "columnblock.hpp"
+#include "npyformat.hpp"
+#include "telemetrysink.hpp"
+#include "zipwriter.hpp"
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+// How an NpySink lays out the records
+enum class NpyLayout {
+  Channels, // One 1-D float64 array per column, named after it
+  Matrix    // One 2-D (rows, columns) float64 array, "records"
+};
+
+inline NpyLayout npyLayoutFromName(const std::string &name) {
+  if (name == "channels")
+    return NpyLayout::Channels;
+  if (name == "matrix")
+    return NpyLayout::Matrix;
+  throw std::invalid_argument("Unknown npy layout: " + name);
+}
+
+// Telemetry as numpy arrays that np.load(mmap_mode='r') maps without
+// parsing. Unbundled, Channels writes a directory of <column>.npy files and
+// Matrix writes the single .npy at path. Bundled, the same arrays go into an
+// uncompressed .npz with 64-byte aligned members. Directories and bundles
+// also get "columns" and "units" string arrays. Arrays are streamed behind
+// a placeholder header that is patched with the row count on close.
+class NpySink : public TelemetrySink {
+public:
+  // Per-column buffers; a wide schema holds one of these per column
+  static constexpr std::size_t CHANNEL_BUFFER = std::size_t(64) << 10;
+  // Channels: records turned into columns at a time
+  static constexpr std::size_t BLOCK_ROWS = 1024;
+
+private:
+  std::string path_;
+  NpyLayout layout_;
+  bool bundle_;
+  TelemetrySchema schema_;
+  std::string directory_; // Channels: where the per-column files go
+  std::vector<std::unique_ptr<BufferedFile>> channels_;
+  ColumnBlock block_; // Channels: records not yet appended
+  std::unique_ptr<BufferedFile> matrix_;
+  std::unique_ptr<ZipWriter> zip_;
+  std::uint64_t headerAt_ = 0; // Matrix: offset of the placeholder header
+  std::uint64_t rows_ = 0;
+
+  static std::string placeholder() {
+    return std::string(Npy::STREAM_HEADER_BYTES, ' ');
+  }
+
+  std::vector<std::uint64_t> shape() const {
+    if (layout_ == NpyLayout::Matrix)
+      return {rows_, schema_.size()};
+    return {rows_};
+  }
+
+  static void makeDirectory(const std::string &path) {
+    if (::mkdir(path.c_str(), 0755) != 0 && errno != EEXIST)
+      throw std::runtime_error("Cannot create " + path + ": " +
+                               std::strerror(errno));
+  }
+
+  void flushBlock() {
+    block_.transpose();
+    for (std::size_t i = 0; i < channels_.size(); ++i)
+      channels_[i]->append(block_.column(i), block_.size() * sizeof(double));
+    block_.clear();
+  }
+
+  void addStrings(const std::string &name,
+                  const std::vector<std::string> &values) {
+    std::string npy = Npy::stringArray(values);
+    if (zip_) {
+      zip_->add(name + ".npy", npy.data(), npy.size());
+      return;
+    }
+    BufferedFile file(directory_ + "/" + name + ".npy");
+    file.append(npy.data(), npy.size());
+    file.close();
+  }
+
+public:
+  NpySink(std::string path, NpyLayout layout, bool bundle)
+      : path_(std::move(path)), layout_(layout), bundle_(bundle) {}
+  ~NpySink() override {
+    try {
+      close();
+    } catch (...) {
+    }
+  }
+
+  void open(const TelemetrySchema &schema) override {
+    schema_ = schema;
+    for (const auto &column : schema.columns()) {
+      if (column.name == "columns" || column.name == "units")
+        throw std::invalid_argument("Reserved npy array name: " +
+                                    column.name);
+    }
+    if (bundle_)
+      zip_ = std::make_unique<ZipWriter>(path_);
+
+    std::string header = placeholder();
+    if (layout_ == NpyLayout::Matrix) {
+      if (bundle_) {
+        zip_->begin("records.npy");
+        headerAt_ = zip_->offset();
+        zip_->append(header.data(), header.size());
+      } else {
+        matrix_ = std::make_unique<BufferedFile>(path_);
+        matrix_->append(header.data(), header.size());
+      }
+      return;
+    }
+
+    // Columns arrive interleaved, so a bundle stages them beside the
+    // archive and copies them in on close
+    directory_ = bundle_ ? path_ + ".parts" : path_;
+    makeDirectory(directory_);
+    block_ = ColumnBlock(schema.size(), BLOCK_ROWS);
+    for (const auto &column : schema.columns()) {
+      channels_.push_back(std::make_unique<BufferedFile>(
+          directory_ + "/" + column.name + ".npy", CHANNEL_BUFFER));
+      channels_.back()->append(header.data(), header.size());
+    }
+  }
+
+  void write(const double *record) override {
+    ++rows_;
+    if (layout_ == NpyLayout::Matrix) {
+      std::size_t n = schema_.size() * sizeof(double);
+      if (zip_)
+        zip_->append(record, n);
+      else
+        matrix_->append(record, n);
+      return;
+    }
+    block_.push(record);
+    if (block_.full())
+      flushBlock();
+  }
+
+  void close() override {
+    if (!matrix_ && !zip_ && channels_.empty())
+      return;
+    std::string header =
+        Npy::header("<f8", shape(), Npy::STREAM_HEADER_BYTES);
+
+    if (matrix_) {
+      matrix_->overwrite(0, header.data(), header.size());
+      matrix_->close();
+      matrix_.reset();
+      return;
+    }
+
+    flushBlock();
+    for (auto &channel : channels_) {
+      channel->overwrite(0, header.data(), header.size());
+      channel->close();
+    }
+    channels_.clear();
+
+    if (zip_ && layout_ == NpyLayout::Matrix) {
+      zip_->overwrite(headerAt_, header.data(), header.size());
+      zip_->end();
+    } else if (zip_) {
+      for (const auto &column : schema_.columns()) {
+        std::string part = directory_ + "/" + column.name + ".npy";
+        {
+          MappedFile staged(part);
+          zip_->add(column.name + ".npy", staged.data(), staged.size());
+        }
+        ::unlink(part.c_str());
+      }
+      ::rmdir(directory_.c_str());
+    }
+
+    std::vector<std::string> names, units;
+    for (const auto &column : schema_.columns()) {
+      names.push_back(column.name);
+      units.push_back(column.unit);
+    }
+    addStrings("columns", names);
+    addStrings("units", units);
+    if (zip_) {
+      zip_->close();
+      zip_.reset();
+    }
+  }
+};
@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+// Lock-free single-producer/single-consumer queue of fixed-size records
+// (width doubles each). The producer and consumer each own one index and
+// keep a cached copy of the other's, so a push or pop touches the shared
+// cache line only when the cached view says the ring is full or empty.
+class RecordRing {
+public:
+  static constexpr std::size_t CACHE_LINE = 64;
+
+private:
+  std::size_t width_;
+  std::size_t mask_; // Capacity - 1; capacity is a power of two
+  std::vector<double> slots_;
+
+  // Producer side
+  alignas(CACHE_LINE) std::atomic<std::uint64_t> head_{0};
+  std::uint64_t tailCache_ = 0;
+  // Consumer side
+  alignas(CACHE_LINE) std::atomic<std::uint64_t> tail_{0};
+  std::uint64_t headCache_ = 0;
+
+  static std::size_t roundUp(std::size_t n) {
+    std::size_t capacity = 1;
+    while (capacity < n)
+      capacity <<= 1;
+    return capacity;
+  }
+
+public:
+  // Room for at least capacity records, rounded up to a power of two
+  RecordRing(std::size_t width, std::size_t capacity)
+      : width_(width), mask_(roundUp(capacity) - 1),
+        slots_((mask_ + 1) * width) {
+    if (width == 0 || capacity == 0)
+      throw std::invalid_argument("Record ring must hold at least one value");
+  }
+  RecordRing(const RecordRing &) = delete;
+  RecordRing &operator=(const RecordRing &) = delete;
+
+  std::size_t width() const { return width_; }
+  std::size_t capacity() const { return mask_ + 1; }
+  // Records queued; exact from either thread's own view, approximate
+  // from any other
+  std::size_t size() const {
+    return static_cast<std::size_t>(head_.load(std::memory_order_acquire) -
+                                    tail_.load(std::memory_order_acquire));
+  }
+
+  // Producer: copy one record in; false if the ring is full
+  bool tryPush(const double *record) {
+    std::uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head - tailCache_ > mask_) {
+      tailCache_ = tail_.load(std::memory_order_acquire);
+      if (head - tailCache_ > mask_)
+        return false;
+    }
+    std::memcpy(&slots_[(head & mask_) * width_], record,
+                width_ * sizeof(double));
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer: call visit(const double *record) for every queued record,
+  // then release their slots together. Returns the number consumed.
+  template <class Visit> std::size_t consume(Visit &&visit) {
+    std::uint64_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == headCache_) {
+      headCache_ = head_.load(std::memory_order_acquire);
+      if (tail == headCache_)
+        return 0;
+    }
+    for (std::uint64_t i = tail; i != headCache_; ++i)
+      visit(&slots_[(i & mask_) * width_]);
+    tail_.store(headCache_, std::memory_order_release);
+    return static_cast<std::size_t>(headCache_ - tail);
+  }
+};
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// What a column's values mean. Records carry every value as a double;
+// typed formats (Arrow) store Int64 and Bool columns natively and Category
+// columns, whose value is an index into the column's labels, as
+// dictionary-encoded strings. Other sinks store the double.
+enum class TelemetryType { Float64, Int64, Bool, Category };
+
+// One output column: a name and its unit ("" for dimensionless)
+struct TelemetryColumn {
+  std::string name;
+  std::string unit;
+  TelemetryType type = TelemetryType::Float64;
+  std::vector<std::string> labels; // Category: the name of each value
+};
+
+// The ordered columns of a telemetry record, plus run-wide key/value
+// metadata that formats with a place for it (.ntl, Arrow) store as well
+class TelemetrySchema {
+private:
+  std::vector<TelemetryColumn> columns_;
+  std::vector<std::pair<std::string, std::string>> metadata_;
+
+public:
+  TelemetrySchema() = default;
+  TelemetrySchema(std::vector<TelemetryColumn> columns)
+      : columns_(std::move(columns)) {}
+
+  void add(std::string name, std::string unit) {
+    columns_.push_back(
+        {std::move(name), std::move(unit), TelemetryType::Float64, {}});
+  }
+  void add(TelemetryColumn column) { columns_.push_back(std::move(column)); }
+
+  std::size_t size() const { return columns_.size(); }
+  const TelemetryColumn &operator[](std::size_t i) const {
+    return columns_[i];
+  }
+  const std::vector<TelemetryColumn> &columns() const { return columns_; }
+
+  // Adds key, or replaces its value
+  void setMetadata(const std::string &key, std::string value) {
+    for (auto &entry : metadata_) {
+      if (entry.first == key) {
+        entry.second = std::move(value);
+        return;
+      }
+    }
+    metadata_.emplace_back(key, std::move(value));
+  }
+  const std::vector<std::pair<std::string, std::string>> &metadata() const {
+    return metadata_;
+  }
+
+  // Column index by name; throws if there is none
+  std::size_t indexOf(const std::string &name) const {
+    for (std::size_t i = 0; i < columns_.size(); ++i) {
+      if (columns_[i].name == name)
+        return i;
+    }
+    throw std::invalid_argument("Unknown telemetry column: " + name);
+  }
+};
+
+// Destination for telemetry records. A record is one double per schema
+// column, in schema order.
+class TelemetrySink {
+public:
+  virtual ~TelemetrySink() = default;
+  // Called once, before the first record
+  virtual void open(const TelemetrySchema &schema) = 0;
+  virtual void write(const double *record) = 0;
+  // Flush everything; no records may follow
+  virtual void close() = 0;
+};
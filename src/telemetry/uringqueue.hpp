@@ -0,0 +1,312 @@
+#pragma once
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Asynchronous file writes through io_uring, driven by raw system calls
+// (no liburing). The queue owns a pool of page-aligned buffers registered
+// with the kernel, so a write is a WRITE_FIXED of a buffer the kernel has
+// already pinned; the caller fills one buffer while earlier ones are in
+// flight. If registration is refused (e.g. RLIMIT_MEMLOCK) plain WRITEs of
+// the same buffers are used. The constructor throws if io_uring itself is
+// unavailable, or the kernel's opcode probe lists neither write, which
+// callers treat as "fall back to pwrite".
+class UringQueue {
+public:
+  static constexpr std::size_t BUFFER_ALIGNMENT = 4096;
+
+  struct Stats {
+    std::uint64_t submissions = 0; // Writes queued, including resubmits
+    std::uint64_t enters = 0;      // io_uring_enter calls
+    std::uint64_t waits = 0;       // Times every buffer was in flight
+    std::uint64_t maxInFlight = 0;
+    bool fixed = false; // Buffers registered
+  };
+
+private:
+  struct Write {
+    int fd;
+    char *data;
+    std::size_t length;
+    std::uint64_t offset;
+    bool busy = false;
+  };
+
+  int ring_ = -1;
+  io_uring_params params_{};
+  void *rings_ = MAP_FAILED;
+  std::size_t ringsBytes_ = 0;
+  io_uring_sqe *sqes_ = static_cast<io_uring_sqe *>(MAP_FAILED);
+  std::size_t sqesBytes_ = 0;
+  unsigned *sqHead_, *sqTail_, *sqMask_, *sqArray_;
+  unsigned *cqHead_, *cqTail_, *cqMask_;
+  io_uring_cqe *cqes_;
+
+  std::size_t bufferBytes_;
+  std::vector<char *> buffers_;
+  std::vector<Write> writes_; // Per buffer
+  std::size_t inFlight_ = 0;
+  int error_ = 0; // First failed write's errno
+  Stats stats_;
+
+  static int enter(int fd, unsigned submit, unsigned wait, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, submit, wait,
+                                      flags, nullptr, 0));
+  }
+
+  template <class T> T *at(std::uint32_t offset) {
+    return reinterpret_cast<T *>(static_cast<char *>(rings_) + offset);
+  }
+
+  void queue(std::size_t index) {
+    const Write &w = writes_[index];
+    unsigned tail = *sqTail_;
+    unsigned slot = tail & *sqMask_;
+    io_uring_sqe &sqe = sqes_[slot];
+    std::memset(&sqe, 0, sizeof sqe);
+    sqe.opcode = stats_.fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    sqe.fd = w.fd;
+    sqe.off = w.offset;
+    sqe.addr = reinterpret_cast<std::uint64_t>(w.data);
+    sqe.len = static_cast<std::uint32_t>(w.length);
+    sqe.buf_index = static_cast<std::uint16_t>(index);
+    sqe.user_data = index;
+    sqArray_[slot] = slot;
+    __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+    ++stats_.submissions;
+    ++stats_.enters;
+    while (enter(ring_, 1, 0, 0) < 0)
+      recover();
+  }
+
+  // After a failed io_uring_enter: throws unless errno says to retry.
+  // EAGAIN and EBUSY mean the kernel is short of resources until
+  // completions are reaped, so reap them, waiting for one if a submitted
+  // write is still running. Returns whether any completed.
+  bool recover() {
+    if (errno == EINTR)
+      return false;
+    if (errno != EAGAIN && errno != EBUSY)
+      throw std::runtime_error(std::string("io_uring_enter: ") +
+                               std::strerror(errno));
+    if (retire() > 0)
+      return true;
+    unsigned unsubmitted =
+        *sqTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    if (inFlight_ > unsubmitted) {
+      ++stats_.enters;
+      enter(ring_, 0, 1, IORING_ENTER_GETEVENTS);
+    } else {
+      std::this_thread::yield();
+    }
+    return retire() > 0;
+  }
+
+  // Retire finished writes; with wait, block for at least one
+  void reap(bool wait) {
+    if (wait) {
+      ++stats_.enters;
+      while (enter(ring_, 0, 1, IORING_ENTER_GETEVENTS) < 0) {
+        if (recover())
+          return;
+      }
+    }
+    retire();
+  }
+
+  // Handle every completion in the queue; returns how many. A short write
+  // queues its remainder, which may recurse through recover(), so the
+  // queue head is reread for each completion.
+  std::size_t retire() {
+    std::size_t retired = 0;
+    for (;;) {
+      unsigned head = *cqHead_;
+      if (head == __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE))
+        return retired;
+      io_uring_cqe cqe = cqes_[head & *cqMask_];
+      __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+      ++retired;
+      Write &w = writes_[cqe.user_data];
+      if (cqe.res < 0) {
+        if (!error_)
+          error_ = -cqe.res;
+      } else if (static_cast<std::size_t>(cqe.res) < w.length && cqe.res > 0) {
+        // Short write: queue the rest from the same buffer
+        w.data += cqe.res;
+        w.length -= static_cast<std::size_t>(cqe.res);
+        w.offset += static_cast<std::uint64_t>(cqe.res);
+        queue(cqe.user_data);
+        continue;
+      } else if (cqe.res == 0 && w.length > 0 && !error_) {
+        error_ = EIO;
+      }
+      w.busy = false;
+      --inFlight_;
+    }
+  }
+
+  // Which of WRITE and WRITE_FIXED the kernel supports; throws if it
+  // cannot say (kernels before 5.6, which also lack WRITE)
+  void probe(bool &write, bool &writeFixed) {
+    constexpr unsigned OPS = 256;
+    std::vector<char> memory(sizeof(io_uring_probe) +
+                             OPS * sizeof(io_uring_probe_op));
+    auto *p = reinterpret_cast<io_uring_probe *>(memory.data());
+    if (::syscall(__NR_io_uring_register, ring_, IORING_REGISTER_PROBE, p,
+                  OPS) != 0)
+      throw std::runtime_error("io_uring opcode probe unavailable");
+    auto supported = [&](unsigned op) {
+      return op < p->ops_len && (p->ops[op].flags & IO_URING_OP_SUPPORTED);
+    };
+    write = supported(IORING_OP_WRITE);
+    writeFixed = supported(IORING_OP_WRITE_FIXED);
+  }
+
+  void check() {
+    if (error_)
+      throw std::runtime_error(std::string("io_uring write: ") +
+                               std::strerror(error_));
+  }
+
+  void release() {
+    if (stats_.fixed)
+      ::syscall(__NR_io_uring_register, ring_, IORING_UNREGISTER_BUFFERS,
+                nullptr, 0);
+    if (sqes_ != MAP_FAILED)
+      ::munmap(sqes_, sqesBytes_);
+    if (rings_ != MAP_FAILED)
+      ::munmap(rings_, ringsBytes_);
+    if (ring_ >= 0)
+      ::close(ring_);
+    for (char *buffer : buffers_)
+      std::free(buffer);
+  }
+
+public:
+  UringQueue(std::size_t buffers, std::size_t bufferBytes)
+      : bufferBytes_((bufferBytes + BUFFER_ALIGNMENT - 1) / BUFFER_ALIGNMENT *
+                     BUFFER_ALIGNMENT) {
+    if (buffers == 0 || bufferBytes == 0)
+      throw std::invalid_argument("io_uring queue needs buffers");
+    ring_ = static_cast<int>(::syscall(
+        __NR_io_uring_setup, static_cast<unsigned>(buffers), &params_));
+    if (ring_ < 0)
+      throw std::runtime_error(std::string("io_uring_setup: ") +
+                               std::strerror(errno));
+    try {
+      if (!(params_.features & IORING_FEAT_SINGLE_MMAP))
+        throw std::runtime_error("io_uring without single mmap");
+      std::size_t sqBytes =
+          params_.sq_off.array + params_.sq_entries * sizeof(unsigned);
+      std::size_t cqBytes =
+          params_.cq_off.cqes + params_.cq_entries * sizeof(io_uring_cqe);
+      ringsBytes_ = sqBytes > cqBytes ? sqBytes : cqBytes;
+      rings_ = ::mmap(nullptr, ringsBytes_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring_, IORING_OFF_SQ_RING);
+      sqesBytes_ = params_.sq_entries * sizeof(io_uring_sqe);
+      // Stored before the check so release() unmaps whichever succeeded
+      sqes_ = static_cast<io_uring_sqe *>(
+          ::mmap(nullptr, sqesBytes_, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, ring_, IORING_OFF_SQES));
+      if (rings_ == MAP_FAILED || sqes_ == MAP_FAILED)
+        throw std::runtime_error("Cannot map io_uring");
+      sqHead_ = at<unsigned>(params_.sq_off.head);
+      sqTail_ = at<unsigned>(params_.sq_off.tail);
+      sqMask_ = at<unsigned>(params_.sq_off.ring_mask);
+      sqArray_ = at<unsigned>(params_.sq_off.array);
+      cqHead_ = at<unsigned>(params_.cq_off.head);
+      cqTail_ = at<unsigned>(params_.cq_off.tail);
+      cqMask_ = at<unsigned>(params_.cq_off.ring_mask);
+      cqes_ = at<io_uring_cqe>(params_.cq_off.cqes);
+
+      // A ring can exist without the opcodes used here; the first write
+      // would then fail with EINVAL instead of falling back
+      bool write = false, writeFixed = false;
+      probe(write, writeFixed);
+      if (!write && !writeFixed)
+        throw std::runtime_error("io_uring cannot write files");
+
+      std::vector<iovec> iov;
+      for (std::size_t i = 0; i < buffers; ++i) {
+        void *p = std::aligned_alloc(BUFFER_ALIGNMENT, bufferBytes_);
+        if (!p)
+          throw std::bad_alloc();
+        buffers_.push_back(static_cast<char *>(p));
+        iov.push_back({p, bufferBytes_});
+      }
+      writes_.resize(buffers);
+      stats_.fixed = writeFixed &&
+                     ::syscall(__NR_io_uring_register, ring_,
+                               IORING_REGISTER_BUFFERS, iov.data(),
+                               static_cast<unsigned>(iov.size())) == 0;
+      if (!stats_.fixed && !write)
+        throw std::runtime_error("io_uring WRITE unsupported and buffers "
+                                 "not registered");
+    } catch (...) {
+      release();
+      throw;
+    }
+  }
+  ~UringQueue() {
+    try {
+      while (inFlight_ > 0)
+        reap(true);
+    } catch (...) {
+    }
+    release();
+  }
+  UringQueue(const UringQueue &) = delete;
+  UringQueue &operator=(const UringQueue &) = delete;
+
+  std::size_t bufferBytes() const { return bufferBytes_; }
+  const Stats &stats() const { return stats_; }
+
+  // A buffer that is not being written, waiting for one if need be
+  char *acquire() {
+    reap(false);
+    if (inFlight_ == writes_.size()) {
+      ++stats_.waits;
+      while (inFlight_ == writes_.size())
+        reap(true);
+    }
+    check();
+    for (std::size_t i = 0; i < writes_.size(); ++i) {
+      if (!writes_[i].busy)
+        return buffers_[i];
+    }
+    throw std::logic_error("io_uring buffer accounting");
+  }
+
+  // Write buffer[0..n) (buffer from acquire()) at offset of fd; the buffer
+  // must not be touched until a later acquire() hands it out again
+  void write(int fd, char *buffer, std::size_t n, std::uint64_t offset) {
+    std::size_t index = 0;
+    while (index < buffers_.size() && buffers_[index] != buffer)
+      ++index;
+    if (index == buffers_.size() || writes_[index].busy)
+      throw std::logic_error("Not a free io_uring buffer");
+    writes_[index] = {fd, buffer, n, offset, true};
+    ++inFlight_;
+    if (inFlight_ > stats_.maxInFlight)
+      stats_.maxInFlight = inFlight_;
+    queue(index);
+  }
+
+  // Wait for every write; throws if any failed
+  void drain() {
+    while (inFlight_ > 0)
+      reap(true);
+    check();
+  }
+};
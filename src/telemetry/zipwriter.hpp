@@ -0,0 +1,271 @@
+#pragma once
+#include "bufferedfile.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// CRC-32 as used by zip (reflected polynomial 0xEDB88320)
+class Crc32 {
+private:
+  std::uint32_t crc_ = 0xffffffffu;
+
+  static const std::array<std::uint32_t, 256> &table() {
+    static const std::array<std::uint32_t, 256> TABLE = [] {
+      std::array<std::uint32_t, 256> t{};
+      for (std::uint32_t i = 0; i < 256; ++i) {
+        std::uint32_t c = i;
+        for (int k = 0; k < 8; ++k)
+          c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+        t[i] = c;
+      }
+      return t;
+    }();
+    return TABLE;
+  }
+
+public:
+  void update(const void *data, std::size_t n) {
+    const auto &t = table();
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    std::uint32_t c = crc_;
+    for (std::size_t i = 0; i < n; ++i)
+      c = t[(c ^ p[i]) & 0xff] ^ (c >> 8);
+    crc_ = c;
+  }
+  std::uint32_t value() const { return crc_ ^ 0xffffffffu; }
+};
+
+// Uncompressed (stored) zip archive, as np.savez writes. Entry data starts
+// on a 64-byte boundary, padded with an extra field, so stored arrays can
+// be memory-mapped straight out of the archive. Entries are streamed: the
+// local header is patched with the size and CRC when the entry ends, and
+// the padding gives way to a zip64 field if the entry reached 4 GiB. The
+// central directory switches to zip64 records for sizes and offsets past
+// 4 GiB or more than 65535 entries.
+class ZipWriter {
+public:
+  static constexpr std::size_t DATA_ALIGNMENT = 64;
+
+private:
+  struct Entry {
+    std::string name;
+    std::uint64_t header; // Offset of the local header
+    std::uint64_t data;   // Offset of the data
+    std::uint16_t extra;  // Local extra field bytes
+    std::uint32_t crc = 0;
+    std::uint64_t size = 0;
+  };
+
+  // 32-bit fields at or past this hold it and defer to a zip64 field
+  static constexpr std::uint64_t LIMIT32 = 0xffffffffu;
+  static constexpr std::uint64_t LIMIT16 = 0xffffu;
+  // Local zip64 field: id, length, then both sizes
+  static constexpr std::size_t ZIP64_LOCAL = 20;
+  static constexpr std::uint16_t ZIP64_ID = 0x0001;
+  static constexpr std::uint16_t PADDING_ID = 0xcafe; // Private field
+  static constexpr std::uint16_t VERSION = 20;        // 2.0
+  static constexpr std::uint16_t VERSION_ZIP64 = 45;  // 4.5
+
+  BufferedFile file_;
+  std::vector<Entry> entries_;
+  bool open_ = false; // An entry is being written
+
+  template <class V> static void put(std::string &out, V value) {
+    for (std::size_t i = 0; i < sizeof value; ++i)
+      out += static_cast<char>((static_cast<std::uint64_t>(value) >> (8 * i)) &
+                               0xff);
+  }
+
+  static std::uint32_t field32(std::uint64_t n) {
+    return static_cast<std::uint32_t>(std::min(n, LIMIT32));
+  }
+
+  // Local header up to the name: version through extra length
+  static std::string localFields(const Entry &e) {
+    std::string h;
+    put(h, e.size >= LIMIT32 ? VERSION_ZIP64 : VERSION);
+    put(h, std::uint16_t(0));  // Flags
+    put(h, std::uint16_t(0));  // Stored
+    put(h, std::uint16_t(0));  // Time
+    put(h, std::uint16_t(33)); // Date: 1980-01-01
+    put(h, e.crc);
+    put(h, field32(e.size));
+    put(h, field32(e.size));
+    put(h, static_cast<std::uint16_t>(e.name.size()));
+    put(h, e.extra);
+    return h;
+  }
+
+  // The central directory record of an entry, with a zip64 field for the
+  // sizes and offset that do not fit
+  static std::string directoryEntry(const Entry &e) {
+    std::string zip64;
+    if (e.size >= LIMIT32) {
+      put(zip64, e.size);
+      put(zip64, e.size);
+    }
+    if (e.header >= LIMIT32)
+      put(zip64, e.header);
+    std::uint16_t version = zip64.empty() ? VERSION : VERSION_ZIP64;
+
+    std::string d;
+    put(d, std::uint32_t(0x02014b50));
+    put(d, version); // Made by
+    put(d, version); // Needed
+    put(d, std::uint16_t(0));
+    put(d, std::uint16_t(0));
+    put(d, std::uint16_t(0));
+    put(d, std::uint16_t(33));
+    put(d, e.crc);
+    put(d, field32(e.size));
+    put(d, field32(e.size));
+    put(d, static_cast<std::uint16_t>(e.name.size()));
+    put(d, static_cast<std::uint16_t>(zip64.empty() ? 0 : 4 + zip64.size()));
+    put(d, std::uint16_t(0)); // Comment length
+    put(d, std::uint16_t(0)); // Disk
+    put(d, std::uint16_t(0)); // Internal attributes
+    put(d, std::uint32_t(0)); // External attributes
+    put(d, field32(e.header));
+    d += e.name;
+    if (!zip64.empty()) {
+      put(d, ZIP64_ID);
+      put(d, static_cast<std::uint16_t>(zip64.size()));
+      d += zip64;
+    }
+    return d;
+  }
+
+  // Zip64 end of central directory record and locator, before the end
+  // record
+  static std::string zip64End(std::uint64_t entries, std::uint64_t bytes,
+                              std::uint64_t directory, std::uint64_t at) {
+    std::string r;
+    put(r, std::uint32_t(0x06064b50));
+    put(r, std::uint64_t(44)); // Size of the rest of the record
+    put(r, VERSION_ZIP64);
+    put(r, VERSION_ZIP64);
+    put(r, std::uint32_t(0)); // Disk
+    put(r, std::uint32_t(0)); // Disk of the directory
+    put(r, entries);
+    put(r, entries);
+    put(r, bytes);
+    put(r, directory);
+    put(r, std::uint32_t(0x07064b50));
+    put(r, std::uint32_t(0)); // Disk of the zip64 record
+    put(r, at);
+    put(r, std::uint32_t(1)); // Disks
+    return r;
+  }
+
+public:
+  explicit ZipWriter(std::string path) : file_(std::move(path)) {}
+
+  // Start an entry; its data follows through append()
+  void begin(std::string name) {
+    if (open_)
+      throw std::logic_error("Previous zip entry not finished");
+    if (name.size() > LIMIT16)
+      throw std::length_error("Zip entry name too long: " + name);
+    Entry e;
+    e.name = std::move(name);
+    e.header = file_.offset();
+    // Pad the extra field so the data lands on DATA_ALIGNMENT, leaving
+    // room for a local zip64 field and a padding field after it
+    constexpr std::size_t MINIMUM = ZIP64_LOCAL + 4;
+    std::uint64_t fixed = e.header + 30 + e.name.size();
+    e.extra = static_cast<std::uint16_t>(
+        (DATA_ALIGNMENT - (fixed + MINIMUM) % DATA_ALIGNMENT) %
+            DATA_ALIGNMENT +
+        MINIMUM);
+    std::string h;
+    put(h, std::uint32_t(0x04034b50));
+    h += localFields(e) + e.name;
+    put(h, PADDING_ID);
+    put(h, static_cast<std::uint16_t>(e.extra - 4));
+    h.append(e.extra - 4, '\0');
+    file_.append(h.data(), h.size());
+    e.data = file_.offset();
+    entries_.push_back(std::move(e));
+    open_ = true;
+  }
+  void append(const void *data, std::size_t n) { file_.append(data, n); }
+
+  // Offset of the next byte of the open entry (for in-place patches)
+  std::uint64_t offset() const { return file_.offset(); }
+  void overwrite(std::uint64_t offset, const void *data, std::size_t n) {
+    file_.overwrite(offset, data, n);
+  }
+
+  // Finish the open entry: read its data back for the CRC and patch the
+  // local header
+  void end() {
+    if (!open_)
+      throw std::logic_error("No zip entry to finish");
+    Entry &e = entries_.back();
+    e.size = file_.offset() - e.data;
+    Crc32 crc;
+    std::vector<char> chunk(static_cast<std::size_t>(
+        std::min<std::uint64_t>(std::uint64_t(1) << 20, e.size)));
+    for (std::uint64_t at = e.data; at < file_.offset();) {
+      std::size_t n = static_cast<std::size_t>(
+          std::min<std::uint64_t>(chunk.size(), file_.offset() - at));
+      file_.read(at, chunk.data(), n);
+      crc.update(chunk.data(), n);
+      at += n;
+    }
+    e.crc = crc.value();
+    std::string h = localFields(e); // Version through sizes
+    file_.overwrite(e.header + 4, h.data(), 22);
+    if (e.size >= LIMIT32) {
+      // The padding field's first bytes become the zip64 field
+      std::string extra;
+      put(extra, ZIP64_ID);
+      put(extra, std::uint16_t(16));
+      put(extra, e.size);
+      put(extra, e.size);
+      put(extra, PADDING_ID);
+      put(extra, static_cast<std::uint16_t>(e.extra - ZIP64_LOCAL - 4));
+      file_.overwrite(e.header + 30 + e.name.size(), extra.data(),
+                      extra.size());
+    }
+    open_ = false;
+  }
+
+  // A whole entry from memory
+  void add(std::string name, const void *data, std::size_t n) {
+    begin(std::move(name));
+    append(data, n);
+    end();
+  }
+
+  // Write the central directory; no entries may follow
+  void close() {
+    if (open_)
+      end();
+    std::uint64_t directory = file_.offset();
+    std::string d;
+    for (const auto &e : entries_)
+      d += directoryEntry(e);
+    std::uint64_t directoryBytes = d.size();
+    std::uint64_t count = entries_.size();
+    if (count >= LIMIT16 || directoryBytes >= LIMIT32 ||
+        directory >= LIMIT32)
+      d += zip64End(count, directoryBytes, directory,
+                    directory + directoryBytes);
+    put(d, std::uint32_t(0x06054b50));
+    put(d, std::uint16_t(0));
+    put(d, std::uint16_t(0));
+    put(d, static_cast<std::uint16_t>(std::min(count, LIMIT16)));
+    put(d, static_cast<std::uint16_t>(std::min(count, LIMIT16)));
+    put(d, field32(directoryBytes));
+    put(d, field32(directory));
+    put(d, std::uint16_t(0));
+    file_.append(d.data(), d.size());
+    file_.close();
+  }
+};
@@ -0,0 +1,301 @@
+"""Readers for NOVA telemetry: binary logs (.ntl) and numpy exports.
+
+The .ntl layout is described in src/telemetry/binarylog.hpp. Column blocks
+are 8-byte aligned float64 arrays, so they are read with numpy.frombuffer
+straight out of a memory map. The .npy/.npz exports of
+src/telemetry/npysink.hpp are plain numpy files. LiveReader tails the
+shared-memory ring of src/telemetry/livering.hpp while a run is going.
+"""
+import mmap
+import os
+import struct
+import time
+import zipfile
+
+import numpy as np
+
+MAGIC = b'NOVATLM1'
+VERSION = 2  # 1 had no metadata
+CHUNK_TAG = 0x4b4e4843
+INDEX_TAG = 0x58444e49
+ENCODING_RAW = 0
+ENCODING_DELTA = 1
+BLOCK = 64
+LIVE_MAGIC = b'NOVASHM1'
+LIVE_SCHEMA_OFFSET = 128
+_ALL_ONES = np.uint64(0xFFFFFFFFFFFFFFFF)
+
+
+def _corrupt(what):
+    raise ValueError('Corrupt telemetry log: ' + what)
+
+
+def _decode_delta(words, n):
+    """Decode a DeltaCodec column (see src/telemetry/deltacodec.hpp)."""
+    blocks = (n - 1 + BLOCK - 1) // BLOCK if n > 1 else 0
+    header = 2 + (blocks + 7) // 8
+    if len(words) < header:
+        _corrupt('delta column truncated')
+    order = int(words[1])
+    widths = words[2:header].view(np.uint8)[:blocks].astype(np.uint64)
+    if not 1 <= order <= 4 or (widths > 64).any():
+        _corrupt('bad delta column')
+    if header + int(widths.sum()) != len(words):
+        _corrupt('delta column size')
+
+    # Unpack every block at once: value j of block b sits at bit j * width
+    # of the block's words
+    starts = header + np.concatenate(([0], np.cumsum(widths)[:-1]))
+    width = np.repeat(widths, BLOCK)
+    bit = np.tile(np.arange(BLOCK, dtype=np.uint64), blocks) * width
+    index = (np.repeat(starts, BLOCK).astype(np.intp) +
+             (bit >> np.uint64(6)).astype(np.intp))
+    shift = bit & np.uint64(63)
+    packed = np.append(words, np.uint64(0))  # Width 0 blocks read past
+    values = packed[np.minimum(index, len(words))] >> shift
+    straddles = shift + width > 64
+    values[straddles] |= (packed[index[straddles] + 1]
+                          << (np.uint64(64) - shift[straddles]))
+    mask = np.where(width == 0, np.uint64(0),
+                    _ALL_ONES >> (np.uint64(64) - np.maximum(width, 1)))
+    residuals = (values & mask)[:n - 1]
+    residuals = (residuals >> np.uint64(1)) ^ (
+        np.uint64(0) - (residuals & np.uint64(1)))
+
+    # Differences start at zero, so each level is a running sum
+    for _ in range(order):
+        residuals = np.cumsum(residuals, dtype=np.uint64)
+    out = np.empty(n, dtype=np.uint64)
+    out[:1] = words[:1]
+    out[1:] = words[0] + residuals
+    return out.view('<f8')
+
+
+def _map_log(path):
+    """Map a .ntl file and parse its header: (buffer, names, units,
+    encodings, {metadata key: value})."""
+    with open(path, 'rb') as f:
+        buf = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+    if len(buf) < 40 or buf[:8] != MAGIC or buf[-8:] != MAGIC:
+        _corrupt('not a telemetry log')
+    version, columns, _, _ = struct.unpack_from('<4I', buf, 8)
+    if not 1 <= version <= VERSION:
+        raise ValueError('Unsupported telemetry log version')
+
+    names, units, encodings = [], [], []
+    at = 24
+    for _ in range(columns):
+        encoding, _, name_len, unit_len = struct.unpack_from('<BBHH', buf, at)
+        at += 6
+        names.append(buf[at:at + name_len].decode())
+        units.append(buf[at + name_len:at + name_len + unit_len].decode())
+        encodings.append(encoding)
+        at += name_len + unit_len
+    if any(e not in (ENCODING_RAW, ENCODING_DELTA) for e in encodings):
+        _corrupt('unknown column encoding')
+    metadata = {}
+    if version >= 2:
+        entries, = struct.unpack_from('<H', buf, at)
+        at += 2
+        for _ in range(entries):
+            key_len, value_len = struct.unpack_from('<HH', buf, at)
+            at += 4
+            key = buf[at:at + key_len].decode()
+            metadata[key] = buf[at + key_len:at + key_len + value_len].decode()
+            at += key_len + value_len
+    return buf, names, units, encodings, metadata
+
+
+def read_log_metadata(path):
+    """The run metadata of a .ntl file, e.g. {'simd': 'avx2'}."""
+    return _map_log(path)[4]
+
+
+def read_log(path):
+    """Return ({column name: float64 array}, {column name: unit})."""
+    buf, names, units, encodings, _ = _map_log(path)
+
+    footer, = struct.unpack_from('<Q', buf, len(buf) - 16)
+    tag, chunk_count, rows = struct.unpack_from('<IIQ', buf, footer)
+    if tag != INDEX_TAG:
+        _corrupt('bad index')
+    index = np.frombuffer(buf, dtype='<u8', count=2 * chunk_count,
+                          offset=footer + 16).reshape(-1, 2)
+
+    data = {name: np.empty(rows) for name in names}
+    row = 0
+    for offset, chunk_rows in index:
+        offset, chunk_rows = int(offset), int(chunk_rows)
+        tag, _ = struct.unpack_from('<II', buf, offset)
+        if tag != CHUNK_TAG:
+            _corrupt('bad chunk')
+        at = offset + 8
+        for name, encoding in zip(names, encodings):
+            nbytes, = struct.unpack_from('<Q', buf, at)
+            out = data[name][row:row + chunk_rows]
+            if encoding == ENCODING_DELTA:
+                if nbytes % 8:
+                    _corrupt('column size')
+                words = np.frombuffer(buf, dtype='<u8', count=nbytes // 8,
+                                      offset=at + 8)
+                out[:] = _decode_delta(words, chunk_rows)
+            else:
+                if nbytes != chunk_rows * 8:
+                    _corrupt('column size')
+                out[:] = np.frombuffer(buf, dtype='<f8', count=chunk_rows,
+                                       offset=at + 8)
+            at += 8 + (nbytes + 7) // 8 * 8
+        row += chunk_rows
+    return data, dict(zip(names, units))
+
+
+def map_npz(path):
+    """Memory-map every array of an uncompressed .npz.
+
+    np.load ignores mmap_mode for archives and reads members into memory;
+    stored members are plain .npy files inside the zip, so each is mapped
+    in place instead. Returns {name: read-only array}.
+    """
+    arrays = {}
+    with zipfile.ZipFile(path) as archive, open(path, 'rb') as f:
+        for info in archive.infolist():
+            if info.compress_type != zipfile.ZIP_STORED:
+                raise ValueError(info.filename + ' is compressed')
+            f.seek(info.header_offset + 26)
+            name_len, extra_len = struct.unpack('<HH', f.read(4))
+            f.seek(info.header_offset + 30 + name_len + extra_len)
+            read_header = (np.lib.format.read_array_header_1_0
+                           if np.lib.format.read_magic(f) == (1, 0) else
+                           np.lib.format.read_array_header_2_0)
+            shape, fortran, dtype = read_header(f)
+            name = info.filename[:-4] if info.filename.endswith(
+                '.npy') else info.filename
+            if dtype.hasobject:
+                raise ValueError(name + ' holds Python objects')
+            arrays[name] = np.memmap(path, dtype=dtype, mode='r',
+                                     offset=f.tell(), shape=shape,
+                                     order='F' if fortran else 'C')
+    return arrays
+
+
+def read_npy(path):
+    """Columns of a .npy/.npz export, memory-mapped: ({name: array}, units).
+
+    Channel layouts give one array per column; a matrix layout ("records")
+    is split into column views. A lone matrix .npy carries no names, so its
+    columns are numbered and have no units.
+    """
+    if path.endswith('.npy'):
+        records = np.load(path, mmap_mode='r')
+        return {str(i): records[:, i] for i in range(records.shape[1])}, {}
+    if os.path.isdir(path):
+        arrays = {p[:-4]: np.load(os.path.join(path, p), mmap_mode='r')
+                  for p in os.listdir(path) if p.endswith('.npy')}
+    else:
+        arrays = map_npz(path)
+    names = [str(n) for n in arrays.pop('columns')]
+    units = dict(zip(names, (str(u) for u in arrays.pop('units'))))
+    if 'records' in arrays:
+        records = arrays['records']
+        return {n: records[:, i] for i, n in enumerate(names)}, units
+    return {n: arrays[n] for n in names}, units
+
+
+def read_dataframe(path):
+    """A log or numpy export as a pandas DataFrame, one column per channel."""
+    import pandas as pd
+    data, _ = read_log(path) if path.endswith('.ntl') else read_npy(path)
+    return pd.DataFrame(data)
+
+
+def load_flight_data(stem='flight_data'):
+    """The newest of the stem.csv/.ntl/.npz/.arrow/.npy outputs as a
+    DataFrame. Arrow files need pyarrow."""
+    import pandas as pd
+    candidates = [p for p in (stem + '.arrow', stem + '.npz', stem,
+                              stem + '.ntl', stem + '.csv')
+                  if os.path.exists(p)]
+    if not candidates:
+        raise FileNotFoundError('No ' + stem + ' output')
+    path = max(candidates, key=os.path.getmtime)
+    if path.endswith('.arrow'):
+        return pd.read_feather(path)
+    return pd.read_csv(path) if path.endswith('.csv') else read_dataframe(path)
+
+
+class LiveReader:
+    """Tail the simulator's live telemetry ring (/dev/shm/<name>).
+
+    Reads never block or slow the simulator: each slot carries a sequence
+    number that is checked before and after the copy, and records that were
+    overwritten before they were read are counted in lost. Plain loads from
+    the mapping are ordered enough for this on x86 and other TSO machines.
+    """
+
+    def __init__(self, name='nova_live', timeout=None):
+        """Attach to the ring, waiting up to timeout seconds (None: forever)
+        for the simulator to create it; starts at the oldest record held."""
+        path = os.path.join('/dev/shm', name.lstrip('/'))
+        deadline = None if timeout is None else time.monotonic() + timeout
+        while True:
+            try:
+                with open(path, 'rb') as f:
+                    self._map = mmap.mmap(f.fileno(), 0,
+                                          access=mmap.ACCESS_READ)
+                if self._map[:8] == LIVE_MAGIC:
+                    break
+                self._map.close()
+            except (FileNotFoundError, ValueError):
+                pass  # Not created, or not yet sized
+            if deadline is not None and time.monotonic() > deadline:
+                raise TimeoutError('No live telemetry ' + path)
+            time.sleep(0.01)
+        (_, self.columns, self.capacity, self._slot_bytes, self._slots,
+         schema_bytes) = struct.unpack_from('<IIQQQQ', self._map, 8)
+        schema = self._map[LIVE_SCHEMA_OFFSET:
+                           LIVE_SCHEMA_OFFSET + schema_bytes].decode()
+        lines = [line.split('\t') for line in schema.splitlines()]
+        self.names = [name for name, _ in lines]
+        self.units = {name: unit for name, unit in lines}
+        self.next = max(0, self.published - self.capacity)
+        self.lost = 0
+
+    @property
+    def published(self):
+        """Records the simulator has published so far."""
+        return struct.unpack_from('<Q', self._map, 64)[0]
+
+    @property
+    def closed(self):
+        """Whether the run has ended; nothing more will be published."""
+        return struct.unpack_from('<I', self._map, 72)[0] != 0
+
+    def poll(self):
+        """Records published since the last poll, as a (rows, columns)
+        float64 array."""
+        head = self.published
+        if head - self.next > self.capacity:
+            self.lost += head - self.capacity - self.next
+            self.next = head - self.capacity
+        rows = []
+        for n in range(self.next, head):
+            at = self._slots + (n % self.capacity) * self._slot_bytes
+            expect = 2 * n + 2
+            if struct.unpack_from('<Q', self._map, at)[0] != expect:
+                self.lost += 1
+                continue
+            row = np.frombuffer(self._map, '<f8', self.columns, at + 8).copy()
+            if struct.unpack_from('<Q', self._map, at)[0] != expect:
+                self.lost += 1
+                continue
+            rows.append(row)
+        self.next = head
+        return np.array(rows).reshape(-1, self.columns)
+
+    def poll_dataframe(self):
+        """poll() as a DataFrame with the channel names."""
+        import pandas as pd
+        return pd.DataFrame(self.poll(), columns=self.names)
+
+    def close(self):
+        self._map.close()
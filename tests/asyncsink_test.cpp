@@ -0,0 +1,138 @@
+// Checks AsyncTelemetrySink: every record reaches the wrapped sink in order
+// under the Block policy, full queues are counted under Drop and Count
+// without failing close(), and a failure on the writer thread still closes
+// the wrapped sink before close() rethrows it.
+#include "check.hpp"
+#include "telemetry/asyncsink.hpp"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+using Check::check;
+
+// Records what it is given; optionally slow, or failing after some records
+struct Recorder {
+  std::vector<double> values;
+  bool opened = false;
+  bool closed = false;
+};
+
+class RecordingSink : public TelemetrySink {
+private:
+  Recorder &recorder_;
+  std::chrono::microseconds delay_;
+  std::size_t failAfter_;
+
+public:
+  RecordingSink(Recorder &recorder, std::chrono::microseconds delay = {},
+                std::size_t failAfter = SIZE_MAX)
+      : recorder_(recorder), delay_(delay), failAfter_(failAfter) {}
+
+  void open(const TelemetrySchema &) override { recorder_.opened = true; }
+  void write(const double *record) override {
+    if (recorder_.values.size() == failAfter_)
+      throw std::runtime_error("disk full");
+    if (delay_.count() > 0)
+      std::this_thread::sleep_for(delay_);
+    recorder_.values.push_back(record[0]);
+  }
+  void close() override { recorder_.closed = true; }
+};
+
+TelemetrySchema schema() {
+  TelemetrySchema s;
+  s.add("Time", "s");
+  s.add("Altitude", "m");
+  return s;
+}
+
+void writeRecords(AsyncTelemetrySink &sink, std::size_t count) {
+  for (std::size_t i = 0; i < count; ++i) {
+    double record[2] = {static_cast<double>(i), 0.0};
+    sink.write(record);
+  }
+}
+
+void checkBlock() {
+  Recorder recorder;
+  AsyncTelemetrySink sink(
+      std::make_unique<RecordingSink>(recorder, std::chrono::microseconds(5)),
+      16, OverflowPolicy::Block);
+  sink.open(schema());
+  writeRecords(sink, 2000);
+  sink.close();
+  bool ordered = recorder.values.size() == 2000;
+  for (std::size_t i = 0; ordered && i < recorder.values.size(); ++i)
+    ordered = recorder.values[i] == static_cast<double>(i);
+  check(ordered, "Block delivers every record in order");
+  check(sink.stalls() > 0, "a slow sink stalls a small queue");
+  check(sink.dropped() == 0 && sink.written() == 2000, "Block drops nothing");
+  check(recorder.closed, "close() closes the wrapped sink");
+
+  // An idle writer thread sleeps and is woken by the next record
+  Recorder idle;
+  AsyncTelemetrySink slow(std::make_unique<RecordingSink>(idle));
+  slow.open(schema());
+  for (std::size_t i = 0; i < 5; ++i) {
+    writeRecords(slow, 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  check(slow.written() == 5, "records written while the producer idles");
+  slow.close();
+  check(idle.values.size() == 5, "idle writer thread delivers everything");
+}
+
+void checkLossy(OverflowPolicy policy, const char *name) {
+  Recorder recorder;
+  AsyncTelemetrySink sink(
+      std::make_unique<RecordingSink>(recorder,
+                                      std::chrono::microseconds(200)),
+      8, policy);
+  sink.open(schema());
+  writeRecords(sink, 500);
+  bool threw = false;
+  try {
+    sink.close();
+  } catch (...) {
+    threw = true;
+  }
+  std::string policyName = name;
+  check(!threw, policyName + " close() does not fail on overflow");
+  check(sink.dropped() > 0, policyName + " counts dropped records");
+  check(sink.written() + sink.dropped() == 500,
+        policyName + " accounts for every record");
+  check(recorder.values.size() == sink.written(),
+        policyName + " writes the rest");
+  check(recorder.closed, policyName + " closes the wrapped sink");
+}
+
+void checkWriterFailure() {
+  Recorder recorder;
+  AsyncTelemetrySink sink(std::make_unique<RecordingSink>(
+                              recorder, std::chrono::microseconds(0), 100),
+                          16, OverflowPolicy::Block);
+  sink.open(schema());
+  writeRecords(sink, 1000); // Must not hang once the writer has failed
+  std::string message;
+  try {
+    sink.close();
+  } catch (const std::runtime_error &e) {
+    message = e.what();
+  }
+  check(message == "disk full", "close() rethrows the writer failure");
+  check(recorder.closed, "the wrapped sink is closed after a failure");
+  check(recorder.values.size() == 100, "records before the failure kept");
+}
+} // namespace
+
+int main() {
+  checkBlock();
+  checkLossy(OverflowPolicy::Drop, "Drop");
+  checkLossy(OverflowPolicy::Count, "Count");
+  checkWriterFailure();
+  return Check::exitCode();
+}
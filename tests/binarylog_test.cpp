@@ -0,0 +1,184 @@
+// Writes .ntl logs with BinaryLogWriter and reads them back with
+// BinaryLogReader: raw and delta columns across several chunks, the header
+// metadata, and footers or chunks that were corrupted or truncated, which
+// must be rejected before any column is decoded.
+#include "check.hpp"
+#include "telemetry/binarylog.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+using Check::check;
+
+const std::string PATH = "binarylog_test.ntl";
+const std::string DAMAGED = "binarylog_test_damaged.ntl";
+constexpr std::size_t ROWS = 10000;
+constexpr std::size_t CHUNK_ROWS = 1024; // The last chunk is partial
+
+double value(std::size_t row, std::size_t column) {
+  double t = 0.01 * static_cast<double>(row);
+  switch (column) {
+  case 0:
+    return t;
+  case 1:
+    return 100.0 + 3.0 * t * t - std::sin(t);
+  default:
+    return row % 97 == 0 ? std::numeric_limits<double>::quiet_NaN()
+                         : -0.0 * static_cast<double>(row % 2);
+  }
+}
+
+TelemetrySchema schema() {
+  TelemetrySchema s;
+  s.add("Time", "s");
+  s.add("Altitude", "m");
+  s.add("Flags", "");
+  s.setMetadata("simd", "scalar");
+  s.setMetadata("run", "binarylog_test");
+  return s;
+}
+
+void writeLog() {
+  BinaryLogWriter writer(PATH, CHUNK_ROWS, BinaryLog::Encoding::Delta);
+  writer.setEncoding("Altitude", BinaryLog::Encoding::Raw);
+  writer.open(schema());
+  double record[3];
+  for (std::size_t row = 0; row < ROWS; ++row) {
+    for (std::size_t c = 0; c < 3; ++c)
+      record[c] = value(row, c);
+    writer.write(record);
+  }
+  writer.close();
+}
+
+bool sameBits(double a, double b) {
+  return std::memcmp(&a, &b, sizeof a) == 0;
+}
+
+void checkRoundTrip() {
+  BinaryLogReader reader(PATH);
+  check(reader.rowCount() == ROWS, "row count");
+  check(reader.chunkCount() == (ROWS + CHUNK_ROWS - 1) / CHUNK_ROWS,
+        "chunk count");
+  check(reader.schema().size() == 3, "column count");
+  check(reader.schema()[1].name == "Altitude" &&
+            reader.schema()[1].unit == "m",
+        "column name and unit");
+  check(reader.encoding(0) == BinaryLog::Encoding::Delta &&
+            reader.encoding(1) == BinaryLog::Encoding::Raw,
+        "column encodings");
+  check(reader.schema().metadata() == schema().metadata(), "metadata");
+
+  for (std::size_t c = 0; c < 3; ++c) {
+    std::vector<double> values = reader.column(c);
+    bool same = values.size() == ROWS;
+    for (std::size_t row = 0; same && row < ROWS; ++row)
+      same = sameBits(values[row], value(row, c));
+    check(same, "column " + reader.schema()[c].name + " round trips");
+  }
+}
+
+std::vector<char> readBytes(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  return std::vector<char>(std::istreambuf_iterator<char>(in), {});
+}
+
+template <class V> V load(const std::vector<char> &bytes, std::size_t at) {
+  V v;
+  std::memcpy(&v, bytes.data() + at, sizeof v);
+  return v;
+}
+template <class V> void store(std::vector<char> &bytes, std::size_t at, V v) {
+  std::memcpy(bytes.data() + at, &v, sizeof v);
+}
+
+// Whether opening and reading every column of bytes throws as corrupt
+bool rejected(const std::vector<char> &bytes) {
+  {
+    std::ofstream out(DAMAGED, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+  }
+  try {
+    BinaryLogReader reader(DAMAGED);
+    for (std::size_t c = 0; c < reader.schema().size(); ++c)
+      reader.column(c);
+  } catch (const std::runtime_error &) {
+    return true;
+  }
+  return false;
+}
+
+void checkCorrupt() {
+  const std::vector<char> good = readBytes(PATH);
+  check(!rejected(good), "an intact log is accepted");
+
+  std::size_t footer = load<std::uint64_t>(good, good.size() - 16);
+  std::size_t firstChunk = load<std::uint64_t>(good, footer + 16);
+  std::size_t lastEntry =
+      footer + 16 + (load<std::uint32_t>(good, footer + 4) - 1) * 16;
+
+  std::vector<char> bytes = good;
+  store<std::uint64_t>(bytes, footer + 8, ROWS + 1);
+  check(rejected(bytes), "footer rows above the chunks' total");
+  bytes = good;
+  store<std::uint64_t>(bytes, footer + 8, ROWS - 1);
+  check(rejected(bytes), "footer rows below the chunks' total");
+
+  // A chunk whose index and header agree on more rows than it holds
+  bytes = good;
+  std::size_t lastChunk = load<std::uint64_t>(good, lastEntry);
+  std::uint64_t lastRows = load<std::uint64_t>(good, lastEntry + 8);
+  store<std::uint64_t>(bytes, lastEntry + 8, lastRows + 1000);
+  store<std::uint32_t>(bytes, lastChunk + 4, lastRows + 1000);
+  store<std::uint64_t>(bytes, footer + 8, ROWS + 1000);
+  check(rejected(bytes), "chunk rows larger than its columns");
+
+  bytes = good;
+  store<std::uint64_t>(bytes, lastEntry + 8, lastRows + 1);
+  check(rejected(bytes), "index rows that differ from the chunk header");
+
+  bytes = good;
+  store<std::uint64_t>(bytes, lastEntry + 8,
+                       std::numeric_limits<std::uint64_t>::max());
+  check(rejected(bytes), "row count that overflows");
+
+  // Column block sizes that run past the chunk, or are not whole rows
+  bytes = good;
+  store<std::uint64_t>(bytes, firstChunk + 8, std::uint64_t(1) << 40);
+  check(rejected(bytes), "delta column longer than the file");
+  bytes = good;
+  store<std::uint64_t>(bytes, firstChunk + 8,
+                       std::numeric_limits<std::uint64_t>::max() - 3);
+  check(rejected(bytes), "column size that overflows");
+  bytes = good;
+  std::size_t raw = firstChunk + 16 + load<std::uint64_t>(good, firstChunk + 8);
+  store<std::uint64_t>(bytes, raw, CHUNK_ROWS * 8 + 8);
+  check(rejected(bytes), "raw column larger than its rows");
+
+  // Chunk data cut out, trailer kept
+  bytes.assign(good.begin(), good.begin() + firstChunk + 64);
+  bytes.insert(bytes.end(), good.begin() + footer, good.end());
+  store<std::uint64_t>(bytes, bytes.size() - 16, firstChunk + 64);
+  check(rejected(bytes), "truncated chunks");
+
+  bytes.assign(good.begin(), good.begin() + good.size() / 2);
+  check(rejected(bytes), "truncated file");
+}
+} // namespace
+
+int main() {
+  writeLog();
+  checkRoundTrip();
+  checkCorrupt();
+  std::remove(PATH.c_str());
+  std::remove(DAMAGED.c_str());
+  return Check::exitCode();
+}
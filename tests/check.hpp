@@ -0,0 +1,26 @@
+#pragma once
+#include <iostream>
+#include <string>
+
+// Shared by the programs in tests/: check() reports each failed condition
+// and keeps going, and main returns Check::exitCode() so ctest sees any
+// failure.
+namespace Check {
+inline int &failures() {
+  static int count = 0;
+  return count;
+}
+
+inline void check(bool ok, const std::string &what) {
+  if (!ok) {
+    std::cerr << "FAIL: " << what << "\n";
+    ++failures();
+  }
+}
+
+inline int exitCode() {
+  if (failures())
+    std::cerr << failures() << " check(s) failed\n";
+  return failures() ? 1 : 0;
+}
+} // namespace Check
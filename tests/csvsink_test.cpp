@@ -0,0 +1,117 @@
+// Checks that CsvTelemetrySink's std::to_chars rows are byte for byte what
+// the iostream std::fixed << std::setprecision(6) sink wrote, on values
+// that round at the last decimal, negative zero, large and tiny magnitudes
+// and non-finite values; and that the shortest format reads back exactly.
+#include "check.hpp"
+#include "telemetry/csvsink.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+using Check::check;
+
+const std::string PATH = "csvsink_test.csv";
+
+std::vector<double> edgeValues() {
+  std::vector<double> values = {
+      0.0, -0.0, 1.0, -1.0, 1e15, -1e15, 1e16, 123456789012345.678,
+      5e-7, -5e-7, 4.9999999e-7, 5.0000001e-7, 1.5e-6, 2.5e-6, -2.5e-6,
+      0.0000015, 0.1234565, 0.1234575, 1.0000005, 2.0000005, 9.9999995,
+      -9.9999995, 999999.9999995, 0.3, 2.675, 1e-300, -1e-300,
+      std::numeric_limits<double>::denorm_min(),
+      std::numeric_limits<double>::max(), -std::numeric_limits<double>::max(),
+      std::numeric_limits<double>::infinity(),
+      -std::numeric_limits<double>::infinity(),
+      std::numeric_limits<double>::quiet_NaN(),
+      -std::numeric_limits<double>::quiet_NaN(), 6371000.0 + 1.0 / 3.0,
+      9.80665, -3.14159265358979};
+  // Halfway cases at the sixth decimal, around the scales a flight logs
+  for (double scale : {1.0, 100.0, 6.4e6})
+    for (int k = 0; k < 200; ++k)
+      values.push_back(scale + (k + 0.5) * 1e-6);
+  return values;
+}
+
+// Write one row per value (value, -value) through the sink
+std::string written(const std::vector<double> &values, CsvNumbers numbers,
+                    int precision) {
+  {
+    CsvTelemetrySink sink(PATH, numbers, precision);
+    TelemetrySchema schema;
+    schema.add("Value", "");
+    schema.add("Negated", "");
+    sink.open(schema);
+    for (double v : values) {
+      double record[2] = {v, -v};
+      sink.write(record);
+    }
+    sink.close();
+  }
+  std::ifstream in(PATH, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+// The rows of the iostream sink the to_chars one replaced
+std::string streamed(const std::vector<double> &values, int precision) {
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(precision);
+  out << "Value,Negated\n";
+  for (double v : values)
+    out << v << "," << -v << "\n";
+  return out.str();
+}
+
+std::vector<std::string> lines(const std::string &text) {
+  std::vector<std::string> result;
+  std::istringstream in(text);
+  for (std::string line; std::getline(in, line);)
+    result.push_back(line);
+  return result;
+}
+
+void checkFixed(int precision) {
+  std::vector<double> values = edgeValues();
+  std::vector<std::string> ours =
+      lines(written(values, CsvNumbers::Fixed, precision));
+  std::vector<std::string> theirs = lines(streamed(values, precision));
+  std::string label = "precision " + std::to_string(precision);
+  check(ours.size() == theirs.size(), label + " row count");
+  for (std::size_t i = 0; i < ours.size() && i < theirs.size(); ++i)
+    check(ours[i] == theirs[i],
+          label + ": '" + ours[i] + "' vs iostream '" + theirs[i] + "'");
+}
+
+void checkShortest() {
+  std::vector<double> values = edgeValues();
+  std::vector<std::string> rows =
+      lines(written(values, CsvNumbers::Shortest, 0));
+  check(rows.size() == values.size() + 1, "shortest row count");
+  for (std::size_t i = 0; i + 1 < rows.size(); ++i) {
+    std::string field = rows[i + 1].substr(0, rows[i + 1].find(','));
+    double back = std::strtod(field.c_str(), nullptr);
+    bool same = std::isnan(values[i])
+                    ? std::isnan(back)
+                    : back == values[i] &&
+                          std::signbit(back) == std::signbit(values[i]);
+    check(same, "shortest '" + field + "' reads back");
+  }
+}
+} // namespace
+
+int main() {
+  checkFixed(CsvTelemetrySink::DEFAULT_PRECISION);
+  checkFixed(0);
+  checkFixed(3);
+  checkFixed(12);
+  checkShortest();
+  std::remove(PATH.c_str());
+  return Check::exitCode();
+}
@@ -0,0 +1,141 @@
+// Decimates a noisy trajectory with DecimatingSink, rebuilds every record by
+// linear interpolation over Time between the kept ones, and checks that no
+// channel is ever further from the original than its tolerance; also that
+// the first and last records are always kept, Int64 columns round back
+// exactly and Bool changes are never lost.
+#include "check.hpp"
+#include "telemetry/decimatingsink.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+using Check::check;
+
+using Records = std::vector<std::vector<double>>;
+
+// Keeps what it is given
+class CollectingSink : public TelemetrySink {
+private:
+  Records &records_;
+  std::size_t width_ = 0;
+
+public:
+  explicit CollectingSink(Records &records) : records_(records) {}
+  void open(const TelemetrySchema &schema) override {
+    width_ = schema.size();
+  }
+  void write(const double *record) override {
+    records_.emplace_back(record, record + width_);
+  }
+  void close() override {}
+};
+
+constexpr std::size_t TIME = 0;
+const double TOLERANCE[] = {0.0, 1.0, 0.05, 0.001, 0.49, 0.0};
+
+TelemetrySchema schema() {
+  TelemetrySchema s;
+  s.add("Time", "s");
+  s.add("Altitude", "m");
+  s.add("Velocity", "m/s");
+  s.add("Mass fraction", "");
+  s.add({"Stage", "", TelemetryType::Int64, {}});
+  s.add({"Engine on", "", TelemetryType::Bool, {}});
+  return s;
+}
+
+// A powered climb, coast and descent with sensor noise, 0.01 s steps
+Records trajectory(std::size_t n, unsigned seed) {
+  std::mt19937_64 random(seed);
+  std::normal_distribution<double> noise(0.0, 1.0);
+  Records records;
+  double altitude = 0.0, velocity = 0.0, mass = 1.0;
+  for (std::size_t i = 0; i < n; ++i) {
+    double t = 0.01 * static_cast<double>(i);
+    bool burning = t < 60.0 || (t > 150.0 && t < 155.0);
+    double acceleration = (burning ? 25.0 : 0.0) - 9.81;
+    velocity += acceleration * 0.01;
+    altitude = std::max(0.0, altitude + velocity * 0.01);
+    if (burning)
+      mass -= 0.004 * 0.01;
+    records.push_back({t, altitude + 0.1 * noise(random),
+                       velocity + 0.005 * noise(random),
+                       mass + 0.0001 * noise(random),
+                       static_cast<double>(t < 60.0 ? 1 : t < 150.0 ? 2 : 3),
+                       burning ? 1.0 : 0.0});
+  }
+  return records;
+}
+
+Records decimate(const Records &input) {
+  Records kept;
+  DecimatingSink sink(std::make_unique<CollectingSink>(kept), 1.0);
+  TelemetrySchema s = schema();
+  for (std::size_t c = 0; c < s.size(); ++c)
+    if (s[c].type == TelemetryType::Float64 && c != TIME)
+      sink.setTolerance(s[c].name, TOLERANCE[c]);
+  sink.open(s);
+  for (const auto &record : input)
+    sink.write(record.data());
+  sink.close();
+  return kept;
+}
+
+void checkReconstruction(const Records &input, const std::string &label) {
+  Records kept = decimate(input);
+  check(!kept.empty() && kept.front() == input.front(),
+        label + ": first record kept");
+  check(!kept.empty() && kept.back() == input.back(),
+        label + ": last record kept");
+  check(kept.size() < input.size() / 5,
+        label + ": decimation keeps a fraction of the records (" +
+            std::to_string(kept.size()) + " of " +
+            std::to_string(input.size()) + ")");
+
+  // Worst reconstruction error per column, by walking both in time order
+  std::size_t width = input.front().size();
+  std::vector<double> worst(width, 0.0);
+  std::size_t segment = 0;
+  for (const auto &record : input) {
+    double t = record[TIME];
+    while (segment + 2 < kept.size() && kept[segment + 1][TIME] <= t)
+      ++segment;
+    const auto &a = kept[segment];
+    const auto &b = kept[std::min(segment + 1, kept.size() - 1)];
+    double span = b[TIME] - a[TIME];
+    double f = span > 0 ? (t - a[TIME]) / span : 0.0;
+    for (std::size_t c = 0; c < width; ++c) {
+      double rebuilt = a[c] + (b[c] - a[c]) * f;
+      worst[c] = std::max(worst[c], std::abs(rebuilt - record[c]));
+    }
+  }
+  TelemetrySchema s = schema();
+  for (std::size_t c = 1; c < width; ++c)
+    check(worst[c] <= TOLERANCE[c],
+          label + ": " + s[c].name + " within tolerance (worst " +
+              std::to_string(worst[c]) + ")");
+}
+
+void checkEdges() {
+  // One record, and two: each is kept as is
+  Records one = trajectory(1, 1);
+  check(decimate(one) == one, "a single record is kept");
+  Records two = trajectory(2, 1);
+  check(decimate(two) == two, "two records are both kept");
+  Records none = decimate({});
+  check(none.empty(), "no records in, none out");
+}
+} // namespace
+
+int main() {
+  for (unsigned seed = 1; seed <= 5; ++seed)
+    checkReconstruction(trajectory(30000, seed),
+                        "seed " + std::to_string(seed));
+  checkEdges();
+  return Check::exitCode();
+}
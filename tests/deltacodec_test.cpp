@@ -0,0 +1,165 @@
+// Round-trips DeltaCodec bit for bit on every BatchKernels path the CPU
+// supports: lengths from 0 to several thousand that are not multiples of
+// the 64-value block, smooth series, noise that needs all 64 bits, NaN
+// payloads, signed zeros, infinities and sign flips. Also checks that a
+// truncated column is rejected and that the dispatched transpose agrees
+// with a plain loop.
+#include "check.hpp"
+#include "telemetry/deltacodec.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+using Check::check;
+
+const std::size_t LENGTHS[] = {0,   1,   2,   3,    7,    63,   64,   65,
+                               127, 129, 191, 500,  1000, 1023, 1025, 4095,
+                               4097, 5003};
+constexpr std::size_t RANDOM_LENGTHS = 40;
+constexpr std::size_t MAX_LENGTH = 6000;
+
+double fromBits(std::uint64_t bits) {
+  double v;
+  std::memcpy(&v, &bits, sizeof v);
+  return v;
+}
+
+bool sameBits(const std::vector<double> &a, const std::vector<double> &b) {
+  return a.size() == b.size() &&
+         (a.empty() ||
+          std::memcmp(a.data(), b.data(), a.size() * sizeof(double)) == 0);
+}
+
+// Test series of length n, by kind
+std::vector<double> series(int kind, std::size_t n, std::mt19937_64 &random) {
+  const double INF = std::numeric_limits<double>::infinity();
+  const double SPECIAL[] = {0.0,
+                            -0.0,
+                            INF,
+                            -INF,
+                            std::numeric_limits<double>::quiet_NaN(),
+                            -std::numeric_limits<double>::quiet_NaN(),
+                            fromBits(0x7ff0000000000001), // Signalling NaN
+                            fromBits(0x7ff8dead0000beef), // NaN payload
+                            std::numeric_limits<double>::denorm_min(),
+                            -std::numeric_limits<double>::max(),
+                            1.0};
+  std::normal_distribution<double> noise(0.0, 1.0);
+  std::vector<double> v(n);
+  double walk = 0.0;
+  for (std::size_t i = 0; i < n; ++i) {
+    double t = 0.01 * static_cast<double>(i);
+    switch (kind) {
+    case 0: // Smooth, as a trajectory
+      v[i] = 6371000.0 + 120.0 * t * t - 3.0 * t * t * t + std::sin(t);
+      break;
+    case 1: // Constant
+      v[i] = 42.5;
+      break;
+    case 2: // Full-width noise in the bit pattern
+      v[i] = fromBits(random());
+      break;
+    case 3: // Special values in random order
+      v[i] = SPECIAL[random() % (sizeof SPECIAL / sizeof SPECIAL[0])];
+      break;
+    case 4: // Sign flips every sample
+      v[i] = (i % 2 ? -1.0 : 1.0) * (1.0 + t);
+      break;
+    case 5: // Random walk with occasional zeros of either sign
+      walk += noise(random);
+      v[i] = i % 17 == 0 ? (i % 34 ? -0.0 : 0.0) : walk;
+      break;
+    default: // Smooth, with special values dropped in
+      v[i] = i % 29 == 5 ? SPECIAL[i % (sizeof SPECIAL / sizeof SPECIAL[0])]
+                         : 100.0 * std::cos(t);
+      break;
+    }
+  }
+  return v;
+}
+constexpr int KINDS = 7;
+
+void checkRoundTrips(const std::string &path) {
+  std::mt19937_64 random(12345);
+  std::vector<std::size_t> lengths(std::begin(LENGTHS), std::end(LENGTHS));
+  for (std::size_t i = 0; i < RANDOM_LENGTHS; ++i)
+    lengths.push_back(random() % MAX_LENGTH);
+
+  std::size_t failed = 0, truncated = 0;
+  for (std::size_t n : lengths) {
+    for (int kind = 0; kind < KINDS; ++kind) {
+      std::vector<double> values = series(kind, n, random);
+      std::vector<std::uint64_t> words;
+      DeltaCodec::encode(values.data(), n, words);
+      std::vector<double> decoded(n);
+      DeltaCodec::decode(words.data(), words.size(), n, decoded.data());
+      if (!sameBits(values, decoded)) {
+        ++failed;
+        check(false, path + ": kind " + std::to_string(kind) + ", " +
+                         std::to_string(n) + " values");
+      }
+      // A column one word short must not decode
+      try {
+        DeltaCodec::decode(words.data(), words.size() - 1, n,
+                           decoded.data());
+      } catch (const std::runtime_error &) {
+        ++truncated;
+      }
+    }
+  }
+  check(failed == 0, path + " round trips bit for bit");
+  check(truncated == lengths.size() * KINDS,
+        path + " rejects truncated columns");
+}
+
+void checkTranspose(const std::string &path) {
+  constexpr std::size_t WIDTH = 11;
+  for (std::size_t rows : {0, 1, 3, 8, 17, 1000, 1029}) {
+    std::vector<double> records(rows * WIDTH);
+    for (std::size_t i = 0; i < records.size(); ++i)
+      records[i] = static_cast<double>(i) * 0.5 - 7.0;
+    std::vector<std::vector<double>> columns(WIDTH,
+                                             std::vector<double>(rows));
+    std::vector<double *> pointers;
+    for (auto &column : columns)
+      pointers.push_back(column.data());
+    BatchKernels::active().transpose(records.data(), rows, WIDTH,
+                                     pointers.data());
+    bool same = true;
+    for (std::size_t r = 0; r < rows; ++r)
+      for (std::size_t c = 0; c < WIDTH; ++c)
+        same = same && columns[c][r] == records[r * WIDTH + c];
+    check(same, path + " transpose of " + std::to_string(rows) + " rows");
+  }
+}
+} // namespace
+
+int main() {
+  SimdPath best = detectSimdPath();
+  for (int p = 0; p < static_cast<int>(SimdPath::Count); ++p) {
+    SimdPath path = static_cast<SimdPath>(p);
+    std::string name = simdPathName(path);
+    if (path > best) {
+      std::cout << name << ": not supported by this CPU, skipped\n";
+      continue;
+    }
+    try {
+      BatchKernels::select(path);
+    } catch (const std::runtime_error &e) {
+      std::cout << name << ": " << e.what() << ", skipped\n";
+      continue;
+    }
+    checkRoundTrips(name);
+    checkTranspose(name);
+    std::cout << name << ": checked\n";
+  }
+  BatchKernels::select(best);
+  return Check::exitCode();
+}
@@ -0,0 +1,49 @@
+// Checks each math policy against its error budget over the full input
+// range, and that the Lanes kernels agree with the scalar ones lane by lane.
+#include "check.hpp"
+#include "math/lanes.hpp"
+#include "math/mathpolicy.hpp"
+#include <cstddef>
+#include <iostream>
+
+namespace {
+using Check::check;
+
+template <class Math> void checkBudget() {
+  MathErrorReport error = measureMathError<Math>(1000000);
+  std::cout << Math::NAME << ": max error exp " << error.exp << ", sqrt "
+            << error.sqrt << ", acos " << error.acos << " rad\n";
+  check(error.exp <= Math::EXP_ERROR, "exp within budget");
+  check(error.sqrt <= Math::SQRT_ERROR, "sqrt within budget");
+  check(error.acos <= Math::ACOS_ERROR, "acos within budget");
+  check(error.template withinBudget<Math>(), "withinBudget agrees");
+}
+
+// Every lane of Math::f(Lanes) equals Math::f(lane) to the bit
+template <class Math, class T, std::size_t N> void checkLanes() {
+  for (int k = 0; k < 100; ++k) {
+    Lanes<T, N> e, s, a;
+    for (std::size_t i = 0; i < N; ++i) {
+      double u = (k * N + i) / (100.0 * N);
+      e[i] = static_cast<T>(-80.0 + 160.0 * u);
+      s[i] = static_cast<T>(1e6 * u);
+      a[i] = static_cast<T>(-1.0 + 2.0 * u);
+    }
+    Lanes<T, N> exp = Math::exp(e), sqrt = Math::sqrt(s),
+                acos = Math::acos(a);
+    for (std::size_t i = 0; i < N; ++i) {
+      check(exp[i] == Math::exp(e[i]), "Lanes exp matches scalar");
+      check(sqrt[i] == Math::sqrt(s[i]), "Lanes sqrt matches scalar");
+      check(acos[i] == Math::acos(a[i]), "Lanes acos matches scalar");
+    }
+  }
+}
+} // namespace
+
+int main() {
+  checkBudget<ExactMath>();
+  checkBudget<FastMath>();
+  checkLanes<FastMath, double, 4>();
+  checkLanes<FastMath, float, 8>();
+  return Check::exitCode();
+}
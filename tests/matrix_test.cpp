@@ -0,0 +1,140 @@
+// Checks Mat3 inverses, Quat rotations against their Mat3 form, and the
+// Cholesky factorisation and solve of Matrix.
+#include "check.hpp"
+#include "math/mat3.hpp"
+#include "math/matrix.hpp"
+#include "math/quat.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+
+namespace {
+using Check::check;
+
+double maxError(const Mat3 &a, const Mat3 &b) {
+  double error = 0.0;
+  for (std::size_t i = 0; i < 3; ++i)
+    for (std::size_t j = 0; j < 3; ++j)
+      error = std::max(error, std::abs(a(i, j) - b(i, j)));
+  return error;
+}
+
+double maxError(const Vec3 &a, const Vec3 &b) {
+  return std::max({std::abs(a.x() - b.x()), std::abs(a.y() - b.y()),
+                   std::abs(a.z() - b.z())});
+}
+
+void checkInverses() {
+  Mat3 general = Mat3::fromRows(Vec3(4, -2, 1), Vec3(3, 6, -4),
+                                Vec3(2, 1, 8));
+  check(maxError(general * general.inverse(), Mat3::identity()) < 1e-14,
+        "Mat3 inverse residual");
+  check(maxError(general.inverse() * general, Mat3::identity()) < 1e-14,
+        "Mat3 left inverse residual");
+
+  // An inertia tensor with products of inertia
+  Mat3 inertia = Mat3::symmetric(12.0, 15.0, 3.0, -0.4, 0.7, 0.2);
+  Mat3 inverse = inertia.symmetricInverse();
+  check(maxError(inertia * inverse, Mat3::identity()) < 1e-14,
+        "Mat3 symmetric inverse residual");
+  check(maxError(inverse, inertia.inverse()) < 1e-15,
+        "symmetric inverse matches general inverse");
+  check(maxError(inverse, inverse.transpose()) == 0.0,
+        "symmetric inverse is symmetric");
+
+  bool threw = false;
+  try {
+    Mat3::fromRows(Vec3(1, 2, 3), Vec3(2, 4, 6), Vec3(0, 1, 0)).inverse();
+  } catch (const std::invalid_argument &) {
+    threw = true;
+  }
+  check(threw, "singular Mat3 throws");
+}
+
+void checkQuat() {
+  const Vec3 AXES[] = {Vec3(1, 0, 0), Vec3(0, 0, 1), Vec3(1, 2, -3),
+                       Vec3(-0.3, 0.1, 0.9)};
+  const Vec3 v(0.5, -1.5, 2.0);
+  for (const Vec3 &axis : AXES) {
+    for (double angle = -3.0; angle <= 3.0; angle += 0.75) {
+      Quat q = Quat::fromAxisAngle(axis, angle);
+      Mat3 r = q.toMat3();
+      check(std::abs(q.norm() - 1.0) < 1e-15, "fromAxisAngle is unit");
+      check(maxError(q.rotate(v), r * v) < 1e-14, "rotate matches toMat3");
+      check(maxError(r * r.transpose(), Mat3::identity()) < 1e-15,
+            "toMat3 is orthonormal");
+      check(std::abs(r.determinant() - 1.0) < 1e-14,
+            "toMat3 is a proper rotation");
+      check(maxError(q.conjugate().rotate(q.rotate(v)), v) < 1e-14,
+            "conjugate undoes the rotation");
+
+      // Composition: matrix of the product is the product of matrices
+      Quat p = Quat::fromAxisAngle(Vec3(0, 1, 0), 0.4 * angle + 0.1);
+      check(maxError((q * p).toMat3(), r * p.toMat3()) < 1e-14,
+            "Hamilton product matches matrix product");
+    }
+  }
+  check(maxError(Quat::fromAxisAngle(Vec3(0, 0, 1), 0.5).toMat3(),
+                 Mat3::rotationZ(0.5)) < 1e-15,
+        "Quat about z matches rotationZ");
+}
+
+void checkCholesky() {
+  // A = B^T B + I is symmetric positive definite
+  Matrix<4, 4> b;
+  const double VALUES[] = {2, -1, 0, 3, 1, 4, -2, 0, 0, 1, 5, -1, 2, 0, 1, 3};
+  for (std::size_t i = 0; i < 16; ++i)
+    b(i / 4, i % 4) = VALUES[i];
+  Matrix<4, 4> a = b.transpose() * b + Matrix<4, 4>::identity();
+
+  Matrix<4, 4> l = cholesky(a);
+  Matrix<4, 4> residual = l * l.transpose() - a;
+  double error = 0.0, upper = 0.0;
+  for (std::size_t i = 0; i < 4; ++i)
+    for (std::size_t j = 0; j < 4; ++j) {
+      error = std::max(error, std::abs(residual(i, j)));
+      if (j > i)
+        upper = std::max(upper, std::abs(l(i, j)));
+    }
+  check(error < 1e-12, "L L^T reproduces A");
+  check(upper == 0.0, "Cholesky factor is lower triangular");
+
+  Matrix<4, 2> x;
+  for (std::size_t i = 0; i < 4; ++i) {
+    x(i, 0) = 1.0 + i;
+    x(i, 1) = i % 2 ? -0.5 : 2.0;
+  }
+  Matrix<4, 2> solved = choleskySolve(l, a * x);
+  double solveError = 0.0;
+  for (std::size_t i = 0; i < 4; ++i)
+    for (std::size_t c = 0; c < 2; ++c)
+      solveError = std::max(solveError, std::abs(solved(i, c) - x(i, c)));
+  check(solveError < 1e-12, "choleskySolve recovers x from A x");
+
+  Matrix<3, 3> indefinite = Matrix<3, 3>::identity();
+  indefinite(2, 2) = -1.0;
+  Matrix<2, 2> singular;
+  singular(0, 0) = singular(0, 1) = singular(1, 0) = singular(1, 1) = 1.0;
+  bool threwIndefinite = false, threwSingular = false;
+  try {
+    cholesky(indefinite);
+  } catch (const std::invalid_argument &) {
+    threwIndefinite = true;
+  }
+  try {
+    cholesky(singular);
+  } catch (const std::invalid_argument &) {
+    threwSingular = true;
+  }
+  check(threwIndefinite, "indefinite matrix throws");
+  check(threwSingular, "singular matrix throws");
+}
+} // namespace
+
+int main() {
+  checkInverses();
+  checkQuat();
+  checkCholesky();
+  return Check::exitCode();
+}
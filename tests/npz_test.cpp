@@ -0,0 +1,221 @@
+// Opens the .npz archives NpySink writes, in both layouts, and checks each
+// member: CRC against the central directory, 64-byte aligned data, and a
+// .npy header with the magic, version 1.0, the descr/fortran_order/shape
+// dict and array data starting on a 64-byte boundary. Also reads back a
+// ZipWriter archive past the 65535-entry limit through its zip64 records.
+#include "check.hpp"
+#include "telemetry/npysink.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+using Check::check;
+
+const std::string PATH = "npz_test.npz";
+constexpr std::size_t ROWS = 3000;
+const char *const NAMES[] = {"Time", "Altitude", "Velocity"};
+const char *const UNITS[] = {"s", "m", "m/s"};
+
+struct Member {
+  std::uint32_t crc;
+  std::uint64_t size;
+  std::uint64_t data; // Offset in the archive
+};
+
+std::vector<char> readBytes(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  return std::vector<char>(std::istreambuf_iterator<char>(in), {});
+}
+
+template <class V> V load(const std::vector<char> &bytes, std::uint64_t at) {
+  V v = 0;
+  if (at + sizeof v <= bytes.size())
+    std::memcpy(&v, bytes.data() + at, sizeof v);
+  return v;
+}
+
+// The central directory, by member name. Follows the zip64 locator when
+// the end record defers to it.
+std::map<std::string, Member> members(const std::vector<char> &zip) {
+  std::map<std::string, Member> result;
+  if (zip.size() < 22)
+    return result;
+  std::uint64_t end = zip.size() - 22; // No archive comment
+  if (load<std::uint32_t>(zip, end) != 0x06054b50)
+    return result;
+  std::uint64_t count = load<std::uint16_t>(zip, end + 10);
+  std::uint64_t at = load<std::uint32_t>(zip, end + 16);
+  if (count == 0xffff || at == 0xffffffff) {
+    std::uint64_t locator = end - 20;
+    check(load<std::uint32_t>(zip, locator) == 0x07064b50, "zip64 locator");
+    std::uint64_t record = load<std::uint64_t>(zip, locator + 8);
+    check(load<std::uint32_t>(zip, record) == 0x06064b50, "zip64 record");
+    count = load<std::uint64_t>(zip, record + 32);
+    at = load<std::uint64_t>(zip, record + 48);
+  }
+  for (std::uint64_t i = 0; i < count; ++i) {
+    if (load<std::uint32_t>(zip, at) != 0x02014b50) {
+      check(false, "central directory entry " + std::to_string(i));
+      break;
+    }
+    std::uint16_t nameLength = load<std::uint16_t>(zip, at + 28);
+    std::uint16_t extraLength = load<std::uint16_t>(zip, at + 30);
+    std::uint64_t header = load<std::uint32_t>(zip, at + 42);
+    std::string name(zip.data() + at + 46, nameLength);
+    Member m;
+    m.crc = load<std::uint32_t>(zip, at + 16);
+    m.size = load<std::uint32_t>(zip, at + 24);
+    std::uint64_t local = load<std::uint16_t>(zip, header + 26) +
+                          load<std::uint16_t>(zip, header + 28);
+    m.data = header + 30 + local;
+    check(load<std::uint32_t>(zip, header) == 0x04034b50 &&
+              load<std::uint32_t>(zip, header + 14) == m.crc &&
+              std::string(zip.data() + header + 30, nameLength) == name,
+          name + " local header matches the directory");
+    result[name] = m;
+    at += 46 + nameLength + extraLength;
+  }
+  return result;
+}
+
+// Check one member's bytes as a .npy of descr and shape; returns the
+// offset of its array data
+std::uint64_t checkNpy(const std::vector<char> &zip, const std::string &name,
+                       const Member &m, const std::string &descr,
+                       const std::string &shape) {
+  Crc32 crc;
+  crc.update(zip.data() + m.data, m.size);
+  check(crc.value() == m.crc, name + " CRC");
+  check(m.data % 64 == 0, name + " data is 64-byte aligned in the archive");
+
+  check(std::memcmp(zip.data() + m.data, "\x93NUMPY", 6) == 0,
+        name + " magic");
+  check(zip[m.data + 6] == 1 && zip[m.data + 7] == 0, name + " version 1.0");
+  std::uint16_t length = load<std::uint16_t>(zip, m.data + 8);
+  std::uint64_t array = m.data + 10 + length;
+  check(array % 64 == 0, name + " array data is 64-byte aligned");
+  std::string dict(zip.data() + m.data + 10, length);
+  std::string expected = "{'descr': '" + descr +
+                         "', 'fortran_order': False, 'shape': " + shape +
+                         ", }";
+  check(dict.compare(0, expected.size(), expected) == 0,
+        name + " header dict: " + dict);
+  check(dict.back() == '\n' &&
+            dict.find_first_not_of(' ', expected.size()) == dict.size() - 1,
+        name + " header is padded with spaces and ends in a newline");
+  return array;
+}
+
+TelemetrySchema schema() {
+  TelemetrySchema s;
+  for (std::size_t c = 0; c < 3; ++c)
+    s.add(NAMES[c], UNITS[c]);
+  return s;
+}
+
+double value(std::size_t row, std::size_t c) {
+  return static_cast<double>(row) * 0.5 + static_cast<double>(c) * 1000.0;
+}
+
+void writeNpz(NpyLayout layout) {
+  NpySink sink(PATH, layout, true);
+  sink.open(schema());
+  for (std::size_t row = 0; row < ROWS; ++row) {
+    double record[3] = {value(row, 0), value(row, 1), value(row, 2)};
+    sink.write(record);
+  }
+  sink.close();
+}
+
+void checkStrings(const std::vector<char> &zip,
+                  const std::map<std::string, Member> &found) {
+  check(found.count("columns.npy") && found.count("units.npy"),
+        "columns and units members");
+  if (!found.count("columns.npy") || !found.count("units.npy"))
+    return;
+  std::uint64_t names =
+      checkNpy(zip, "columns.npy", found.at("columns.npy"), "<U8", "(3,)");
+  // UTF-32: "Altitude" is the second of three 8-character strings
+  check(zip[names + 32] == 'A' && zip[names + 36] == 'l',
+        "columns hold the names");
+  checkNpy(zip, "units.npy", found.at("units.npy"), "<U3", "(3,)");
+}
+
+void checkChannels() {
+  writeNpz(NpyLayout::Channels);
+  std::vector<char> zip = readBytes(PATH);
+  std::map<std::string, Member> found = members(zip);
+  check(found.size() == 5, "channels archive has a member per column");
+  for (std::size_t c = 0; c < 3; ++c) {
+    std::string name = std::string(NAMES[c]) + ".npy";
+    if (!found.count(name)) {
+      check(false, name + " missing");
+      continue;
+    }
+    const Member &m = found.at(name);
+    std::uint64_t array =
+        checkNpy(zip, name, m, "<f8", "(" + std::to_string(ROWS) + ",)");
+    check(m.data + m.size == array + ROWS * 8, name + " size");
+    bool same = true;
+    for (std::size_t row = 0; row < ROWS; ++row)
+      same = same && load<double>(zip, array + row * 8) == value(row, c);
+    check(same, name + " values");
+  }
+  checkStrings(zip, found);
+}
+
+void checkMatrix() {
+  writeNpz(NpyLayout::Matrix);
+  std::vector<char> zip = readBytes(PATH);
+  std::map<std::string, Member> found = members(zip);
+  check(found.size() == 3 && found.count("records.npy"),
+        "matrix archive has records, columns and units");
+  if (!found.count("records.npy"))
+    return;
+  const Member &m = found.at("records.npy");
+  std::uint64_t array = checkNpy(zip, "records.npy", m, "<f8",
+                                 "(" + std::to_string(ROWS) + ", 3)");
+  check(m.data + m.size == array + ROWS * 3 * 8, "records size");
+  bool same = true;
+  for (std::size_t row = 0; row < ROWS; ++row)
+    for (std::size_t c = 0; c < 3; ++c)
+      same = same &&
+             load<double>(zip, array + (row * 3 + c) * 8) == value(row, c);
+  check(same, "records values");
+  checkStrings(zip, found);
+}
+
+void checkManyEntries() {
+  constexpr std::size_t ENTRIES = 70000; // Past the 16-bit count
+  {
+    ZipWriter zip(PATH);
+    for (std::size_t i = 0; i < ENTRIES; ++i) {
+      std::string text = std::to_string(i);
+      zip.add("e" + text, text.data(), text.size());
+    }
+    zip.close();
+  }
+  std::vector<char> zip = readBytes(PATH);
+  std::map<std::string, Member> found = members(zip);
+  check(found.size() == ENTRIES, "zip64 directory lists every entry");
+  auto last = found.find("e" + std::to_string(ENTRIES - 1));
+  check(last != found.end() &&
+            std::string(zip.data() + last->second.data, last->second.size) ==
+                std::to_string(ENTRIES - 1),
+        "last entry reads back");
+}
+} // namespace
+
+int main() {
+  checkChannels();
+  checkMatrix();
+  checkManyEntries();
+  std::remove(PATH.c_str());
+  return Check::exitCode();
+}
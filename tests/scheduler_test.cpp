@@ -0,0 +1,129 @@
+// Checks SimulationClock's tick arithmetic and that TaskScheduler runs
+// tasks on exact ticks with no drift over a long run, for periods such as
+// 0.07 s whose ratio to the 0.01 s step is not exact in floating point.
+#include "check.hpp"
+#include "physics/scheduler.hpp"
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+using Check::check;
+
+constexpr double DT = 0.01;
+constexpr std::uint64_t TICKS = 10000000; // 100000 s at DT
+
+bool rejects(const SimulationClock &clock, double seconds) {
+  try {
+    clock.ticksFor(seconds);
+  } catch (const std::invalid_argument &) {
+    return true;
+  }
+  return false;
+}
+
+void checkClock() {
+  SimulationClock clock(DT);
+  // 0.07 / 0.01 and 0.29 / 0.01 are not whole numbers in floating point
+  check(clock.ticksFor(0.07) == 7, "0.07 s is 7 ticks");
+  check(clock.ticksFor(0.29) == 29, "0.29 s is 29 ticks");
+  check(clock.ticksFor(1.0) == 100, "1 s is 100 ticks");
+  check(clock.ticksFor(3600.0) == 360000, "an hour in ticks");
+  check(rejects(clock, 0.015), "half a step is rejected");
+  check(rejects(clock, 0.0), "a zero interval is rejected");
+  check(rejects(clock, 0.004), "an interval under a step is rejected");
+
+  bool threw = false;
+  try {
+    SimulationClock(0.0);
+  } catch (const std::invalid_argument &) {
+    threw = true;
+  }
+  check(threw, "a zero step is rejected");
+
+  // Summing the step drifts; tick * step stays within an ulp of n / 100
+  double summed = 0.0;
+  for (std::uint64_t i = 0; i < TICKS; ++i) {
+    clock.advance();
+    summed += DT;
+  }
+  double exact = static_cast<double>(TICKS) / 100.0;
+  check(clock.tick() == TICKS, "every advance counts");
+  check(std::abs(clock.time() - exact) <= exact * 2e-16,
+        "clock time does not drift");
+  check(std::abs(summed - exact) > 1e-6,
+        "summed time drifts (the check above is meaningful)");
+}
+
+void checkCadence() {
+  SimulationClock clock(DT);
+  TaskScheduler scheduler;
+  std::uint64_t period = clock.ticksFor(0.07);
+  std::uint64_t phase = 3;
+  std::uint64_t runs = 0, offCadence = 0, lastTick = 0;
+  scheduler.add("sample", period, [&](std::uint64_t tick) {
+    if (tick % period != phase)
+      ++offCadence;
+    ++runs;
+    lastTick = tick;
+  }, phase);
+  std::uint64_t reports = 0;
+  scheduler.add("report", clock.ticksFor(1.0),
+                [&](std::uint64_t) { ++reports; });
+
+  for (std::uint64_t i = 0; i < TICKS; ++i) {
+    scheduler.dispatch(clock.tick());
+    clock.advance();
+  }
+  // Ticks phase, phase + period, ... below TICKS
+  std::uint64_t expected = (TICKS - 1 - phase) / period + 1;
+  check(runs == expected, "0.07 s task runs the expected number of times");
+  check(offCadence == 0, "0.07 s task runs only on its ticks");
+  check(reports == TICKS / 100, "1 s task runs once a second");
+  double lastTime = static_cast<double>(lastTick) * DT;
+  double due = 0.03 + static_cast<double>(expected - 1) * 0.07;
+  check(std::abs(lastTime - due) < 1e-9 * due,
+        "last run is at its nominal time after 100000 s");
+}
+
+void checkMissedPeriods() {
+  TaskScheduler scheduler;
+  std::vector<std::uint64_t> ticks;
+  scheduler.add("log", 10, [&](std::uint64_t tick) { ticks.push_back(tick); });
+  scheduler.dispatch(0);
+  scheduler.dispatch(5);  // Not due
+  scheduler.dispatch(37); // Jumped past 10, 20 and 30: runs once
+  scheduler.dispatch(39);
+  scheduler.dispatch(40);
+  check(ticks == std::vector<std::uint64_t>({0, 37, 40}),
+        "missed periods are skipped and the cadence is kept");
+}
+
+void checkOrder() {
+  TaskScheduler scheduler;
+  std::string order;
+  scheduler.add("a", 2, [&](std::uint64_t) { order += 'a'; });
+  scheduler.add("b", 1, [&](std::uint64_t) { order += 'b'; });
+  for (std::uint64_t tick = 0; tick < 4; ++tick)
+    scheduler.dispatch(tick);
+  check(order == "abbabb", "tasks due together run in the order added");
+
+  bool threw = false;
+  try {
+    scheduler.add("never", 0, [](std::uint64_t) {});
+  } catch (const std::invalid_argument &) {
+    threw = true;
+  }
+  check(threw, "a zero period is rejected");
+}
+} // namespace
+
+int main() {
+  checkClock();
+  checkCadence();
+  checkMissedPeriods();
+  checkOrder();
+  return Check::exitCode();
+}
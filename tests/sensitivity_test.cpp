@@ -0,0 +1,113 @@
+// Checks the forward-mode sensitivities of a short powered flight (the
+// Dual<double, 3> run of main's "sensitivities" mode) against central
+// differences of the double run, for thrust, drag and mass. The differences
+// move by parts in 1e5 with the step (table knots and rounding), so the
+// dual derivative is compared with the closest of a sweep of steps.
+#include "check.hpp"
+#include "math/dual.hpp"
+#include "physics/simulationengine.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <limits>
+#include <string>
+
+namespace {
+using Check::check;
+using Scalar = Dual<double, 3>;
+
+constexpr int STEPS = 3000; // 30 s, powered through the lower atmosphere
+constexpr double DT = 0.01;
+
+const char *const NAMES[] = {"thrust", "drag", "mass"};
+// Central difference steps in scale factors; mass steps are 1000x in kg
+const double DIFFERENCE_STEPS[] = {1e-3, 1e-4, 3e-5, 1e-5, 3e-6};
+const double UNIT[] = {1.0, 1.0, 1000.0};
+// Closest central difference vs dual, relative
+constexpr double TOLERANCE = 2e-6;
+
+// The vehicle of the default config
+PropulsionSystem propulsion() {
+  PropulsionSystem p(3000.0);
+  p.addEngine(100000.0, 300.0, 0.01, 16.0);
+  return p;
+}
+
+// Altitude and speed at the end of the flight
+template <class T> struct End {
+  T altitude;
+  T speed;
+};
+
+template <class T> End<T> fly(const FlightParameters<T> &parameters) {
+  RocketBody rocket(20.0, 2.0, 5000.0, 2000.0);
+  State start(Vec3(Constants::EARTH_RADIUS + 100.0, 0, 0), Vec3(), Vec3(),
+              rocket.getMass(), 0.0);
+  BasicSimulationEngine<DefaultForcePipeline, T> sim(
+      BasicState<T>(start), rocket, propulsion(), DT, {}, parameters);
+  sim.startEngines();
+  sim.setThrottle(1.0);
+  for (int i = 0; i < STEPS; ++i)
+    sim.step();
+  const BasicState<T> &s = sim.getState();
+  return {s.position.magnitude() - T(Constants::EARTH_RADIUS),
+          s.velocity.magnitude()};
+}
+
+FlightParameters<double> perturbed(std::size_t parameter, double delta) {
+  FlightParameters<double> p;
+  if (parameter == 0)
+    p.thrustScale += delta;
+  else if (parameter == 1)
+    p.dragScale += delta;
+  else
+    p.massOffset += delta;
+  return p;
+}
+
+void checkSensitivities() {
+  FlightParameters<Scalar> parameters;
+  parameters.thrustScale = Scalar::variable(1.0, 0);
+  parameters.dragScale = Scalar::variable(1.0, 1);
+  parameters.massOffset = Scalar::variable(0.0, 2);
+  End<Scalar> dual = fly(parameters);
+
+  End<double> nominal = fly(FlightParameters<double>());
+  check(dual.altitude.value() == nominal.altitude,
+        "Dual run flies the double trajectory");
+  check(dual.speed.value() == nominal.speed,
+        "Dual speed matches the double run");
+
+  for (std::size_t i = 0; i < 3; ++i) {
+    double dAltitude = dual.altitude.derivative(i);
+    double dSpeed = dual.speed.derivative(i);
+    double bestAltitude = std::numeric_limits<double>::infinity(), worstAltitude = 0.0;
+    double bestSpeed = std::numeric_limits<double>::infinity(), worstSpeed = 0.0;
+    for (double step : DIFFERENCE_STEPS) {
+      double h = step * UNIT[i];
+      End<double> up = fly(perturbed(i, h)), down = fly(perturbed(i, -h));
+      double altitude = (up.altitude - down.altitude) / (2 * h);
+      double speed = (up.speed - down.speed) / (2 * h);
+      double altitudeError = std::abs(altitude / dAltitude - 1.0);
+      double speedError = std::abs(speed / dSpeed - 1.0);
+      bestAltitude = std::min(bestAltitude, altitudeError);
+      worstAltitude = std::max(worstAltitude, altitudeError);
+      bestSpeed = std::min(bestSpeed, speedError);
+      worstSpeed = std::max(worstSpeed, speedError);
+    }
+    std::cout << NAMES[i] << ": d altitude " << dAltitude << ", d speed "
+              << dSpeed << "; central differences within " << bestAltitude
+              << " to " << worstAltitude << " and " << bestSpeed << " to "
+              << worstSpeed << "\n";
+    std::string name = NAMES[i];
+    check(bestAltitude < TOLERANCE, name + " altitude sensitivity");
+    check(bestSpeed < TOLERANCE, name + " speed sensitivity");
+  }
+}
+} // namespace
+
+int main() {
+  checkSensitivities();
+  return Check::exitCode();
+}